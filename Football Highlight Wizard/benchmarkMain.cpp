@@ -0,0 +1,513 @@
+#include "delimiterScan.h"
+#include "highlightWizard.h"
+#include "jsonString.h"
+#include "mappedFile.h"
+#include "matchLogGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Times the hot paths of the core library on a synthetic (or given) match log
+// and prints one JSON object per benchmark line, so results can be collected
+// and compared between commits:
+//
+//   {"benchmark":"loadEventsFromFile","threads":1,"items":2000000,...}
+//
+// "items" is what one run processes (events, lines or type names); the
+// throughput fields use the fastest of the repeated runs.
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct BenchmarkOptions {
+    std::uint64_t eventCount = 2000000; // Size of the generated log
+    std::string logFile;                // Benchmark this log instead of generating one
+    std::string compressedLogFile;      // A gzip/zstd copy of the log, for loadCompressedLog
+    unsigned repeat = 5;                // Timed runs per benchmark, after one warm-up run
+    unsigned threads = 1;               // Parser threads for the parallel load benchmark (0 = all cores)
+    std::string filter;                 // Only run benchmarks whose name contains this
+    std::string outputFile;             // Empty: standard output
+};
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "\n"
+              << "Benchmarks loading (parsed, cached and merged), delimiter scanning, parsing, classification,\n"
+              << "reel selection, description search, reporting and exports; prints JSON lines.\n"
+              << "\n"
+              << "Options:\n"
+              << "  -n, --events <n>         Events in the generated log (default: 2000000)\n"
+              << "  --log <file>             Benchmark an existing log instead of a generated one\n"
+              << "  --compressed-log <file>  Also time loading <file>, a gzip or zstd copy of the log\n"
+              << "  -r, --repeat <n>         Timed runs per benchmark (default: 5)\n"
+              << "  --threads <n>            Parser threads for loadEventsFromFile (default: 1,\n"
+              << "                           0 = all cores); a serial load is always measured too\n"
+              << "  --filter <text>          Only run benchmarks whose name contains <text>\n"
+              << "  -o, --output <file>      Append the JSON lines to <file> (default: standard output)\n"
+              << "  -h, --help               Show this help\n";
+}
+
+unsigned long long parseCount(const std::string& option, const std::string& value) {
+    try {
+        std::size_t used = 0;
+        const unsigned long long count = std::stoull(value, &used);
+        if (used == value.size() && value[0] != '-') {
+            return count;
+        }
+    } catch (const std::exception&) {
+        // Reported below
+    }
+    throw std::runtime_error("Invalid value for " + option + ": '" + value + "'");
+}
+
+// Returns false if the program should exit right away (help was shown)
+bool parseArguments(int argc, char* argv[], BenchmarkOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto nextValue = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return false;
+        } else if (arg == "-n" || arg == "--events") {
+            options.eventCount = parseCount(arg, nextValue());
+        } else if (arg == "--log") {
+            options.logFile = nextValue();
+        } else if (arg == "--compressed-log") {
+            options.compressedLogFile = nextValue();
+        } else if (arg == "-r" || arg == "--repeat") {
+            options.repeat = std::max(1u, static_cast<unsigned>(parseCount(arg, nextValue())));
+        } else if (arg == "--threads") {
+            options.threads = static_cast<unsigned>(parseCount(arg, nextValue()));
+        } else if (arg == "--filter") {
+            options.filter = nextValue();
+        } else if (arg == "-o" || arg == "--output") {
+            options.outputFile = nextValue();
+        } else {
+            throw std::runtime_error("Unknown option: " + arg);
+        }
+    }
+    return true;
+}
+
+// Runs body once to warm up, then `repeat` timed times; returns the sorted run times
+template <typename Body>
+std::vector<double> timeRuns(unsigned repeat, Body&& body) {
+    body();
+    std::vector<double> seconds;
+    for (unsigned run = 0; run < repeat; ++run) {
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        seconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(seconds.begin(), seconds.end());
+    return seconds;
+}
+
+class BenchmarkReport {
+public:
+    BenchmarkReport(std::ostream& out, const BenchmarkOptions& options) : out(out), options(options) {}
+
+    bool selected(const std::string& name) const {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    }
+
+    // bytes == 0 leaves out the byte throughput (the benchmark does not read the log)
+    void write(const std::string& name, unsigned threads, std::uint64_t items, std::uint64_t bytes,
+               const std::vector<double>& seconds) {
+        const double best = seconds.front();
+        const double median = seconds[seconds.size() / 2];
+        out << "{\"benchmark\":\"" << name << "\""
+            << ",\"threads\":" << threads
+            << ",\"items\":" << items
+            << ",\"bytes\":" << bytes
+            << ",\"repeat\":" << seconds.size()
+            << ",\"best_seconds\":" << best
+            << ",\"median_seconds\":" << median
+            << ",\"items_per_second\":" << (best > 0 ? static_cast<double>(items) / best : 0.0);
+        if (bytes > 0) {
+            out << ",\"bytes_per_second\":" << (best > 0 ? static_cast<double>(bytes) / best : 0.0);
+        }
+        out << "}\n";
+        out.flush();
+    }
+
+private:
+    std::ostream& out;
+    const BenchmarkOptions& options;
+};
+
+[[noreturn]] void failCheck(const std::string& message) {
+    throw std::runtime_error("Self-check failed: " + message);
+}
+
+void runBenchmarks(const BenchmarkOptions& options, const std::string& logFile, std::ostream& out) {
+    BenchmarkReport report(out, options);
+
+    // Lines of the log, skipped like the loader skips them, for the benchmarks below the file level
+    const MappedFile file(logFile);
+    const std::string_view buffer = file.view();
+    std::vector<std::string_view> lines;
+    std::vector<std::string_view> typeNames;
+    for (std::size_t position = 0; position < buffer.size();) {
+        const std::size_t newline = std::min(buffer.find('\n', position), buffer.size());
+        const std::string_view line = buffer.substr(position, newline - position);
+        if (!line.empty() && line[0] != '#') {
+            lines.push_back(line);
+            const std::size_t firstComma = line.find(',');
+            if (firstComma != std::string_view::npos) {
+                typeNames.push_back(line.substr(firstComma + 1, line.find(',', firstComma + 1) - firstComma - 1));
+            }
+        }
+        position = newline + 1;
+    }
+
+    // Logs made with --malformed-rate have bad lines: every load skips them quietly
+    LoadOptions lenientOptions;
+    lenientOptions.lenient = true;
+    lenientOptions.reportDiagnostics = false;
+
+    // The wizard every later benchmark works on; it also checks that the log loads
+    HighlightWizard wizard;
+    wizard.setLoadOptions(lenientOptions);
+    wizard.loadEventsFromFile(logFile);
+    const std::size_t eventCount = wizard.getAllEvents().size();
+    const std::uint64_t skippedLines = wizard.getParseDiagnostics().errorCount();
+    if (eventCount + skippedLines != lines.size()) {
+        failCheck("loaded " + std::to_string(eventCount) + " events and skipped " + std::to_string(skippedLines) +
+                  " of " + std::to_string(lines.size()) + " lines");
+    }
+    out << "{\"benchmark\":\"context\",\"log\":" << jsonString(fs::path(logFile).filename().string())
+        << ",\"events\":" << eventCount << ",\"skipped_lines\":" << skippedLines << ",\"bytes\":" << buffer.size()
+        << ",\"hardware_threads\":" << std::thread::hardware_concurrency() << "}\n";
+
+    std::vector<unsigned> loadThreadCounts = {1};
+    if (options.threads != 1) {
+        loadThreadCounts.push_back(options.threads);
+    }
+    for (unsigned threads : loadThreadCounts) {
+        if (!report.selected("loadEventsFromFile")) {
+            break;
+        }
+        HighlightWizard loader;
+        LoadOptions loadOptions = lenientOptions;
+        loadOptions.threadCount = threads;
+        loader.setLoadOptions(loadOptions);
+        const auto seconds = timeRuns(options.repeat, [&] { loader.loadEventsFromFile(logFile); });
+        if (!std::equal(loader.getAllEvents().timestamps().begin(), loader.getAllEvents().timestamps().end(),
+                        wizard.getAllEvents().timestamps().begin(), wizard.getAllEvents().timestamps().end())) {
+            failCheck("a load with " + std::to_string(threads) + " threads gave different events");
+        }
+        report.write("loadEventsFromFile", threads, eventCount, buffer.size(), seconds);
+    }
+
+    // Loads after the first one map the binary cache (kept in the temporary directory)
+    if (report.selected("loadEventsFromCache") && skippedLines == 0 && wizard.getParseDiagnostics().empty()) {
+        HighlightWizard loader;
+        LoadOptions loadOptions = lenientOptions;
+        loadOptions.useEventCache = true;
+        loadOptions.eventCacheDirectory = fs::temp_directory_path().string();
+        loader.setLoadOptions(loadOptions);
+        loader.loadEventsFromFile(logFile); // Writes the cache
+        const auto seconds = timeRuns(options.repeat, [&] { loader.loadEventsFromFile(logFile); });
+        fs::remove(eventCachePathFor(logFile, loadOptions.eventCacheDirectory));
+        if (!loader.getAllEvents().hasExternalColumns() ||
+            !std::equal(loader.getAllEvents().begin(), loader.getAllEvents().end(), wizard.getAllEvents().begin(),
+                        wizard.getAllEvents().end(), [](const EventView& a, const EventView& b) {
+                            return a.timestampMinutes == b.timestampMinutes && a.type == b.type && a.description == b.description;
+                        })) {
+            failCheck("a load from the binary cache gave different events");
+        }
+        report.write("loadEventsFromCache", 1, eventCount, buffer.size(), seconds);
+    }
+
+    // Decompresses on a second thread while parsing; bytes are the compressed size
+    if (report.selected("loadCompressedLog") && !options.compressedLogFile.empty()) {
+        HighlightWizard loader;
+        loader.setLoadOptions(lenientOptions);
+        const auto seconds = timeRuns(options.repeat, [&] { loader.loadEventsFromFile(options.compressedLogFile); });
+        if (!std::equal(loader.getAllEvents().begin(), loader.getAllEvents().end(), wizard.getAllEvents().begin(),
+                        wizard.getAllEvents().end(), [](const EventView& a, const EventView& b) {
+                            return a.timestampMinutes == b.timestampMinutes && a.type == b.type && a.description == b.description;
+                        })) {
+            failCheck("the compressed log gave different events");
+        }
+        report.write("loadCompressedLog", 1, eventCount, fs::file_size(options.compressedLogFile), seconds);
+    }
+
+    // The log merged with itself: every event of the second feed is a duplicate
+    if (report.selected("loadEventsFromFiles")) {
+        HighlightWizard loader;
+        loader.setLoadOptions(lenientOptions);
+        const std::vector<std::string> feeds = {logFile, logFile};
+        const auto seconds = timeRuns(options.repeat, [&] { loader.loadEventsFromFiles(feeds); });
+        const FeedMergeStats& stats = loader.getFeedMergeStats();
+        if (loader.getAllEvents().size() != eventCount || stats.eventsRead != 2 * eventCount ||
+            stats.duplicatesDropped != eventCount) {
+            failCheck("merging the log with itself kept " + std::to_string(loader.getAllEvents().size()) + " of " +
+                      std::to_string(stats.eventsRead) + " events");
+        }
+        report.write("loadEventsFromFiles", 1, stats.eventsRead, 2 * buffer.size(), seconds);
+    }
+
+    if (report.selected("parseEventLine")) {
+        std::uint64_t checksum = 0;
+        const auto seconds = timeRuns(options.repeat, [&] {
+            checksum = 0;
+            for (std::string_view line : lines) {
+                EventView event;
+                if (!isParseError(HighlightWizard::parseEventLine(line, event))) {
+                    checksum += static_cast<std::uint64_t>(event.timestampMinutes) + event.description.size();
+                }
+            }
+        });
+        std::uint64_t expected = 0;
+        for (const EventView event : wizard.getAllEvents()) {
+            expected += static_cast<std::uint64_t>(event.timestampMinutes) + event.description.size();
+        }
+        if (checksum != expected) {
+            failCheck("parseEventLine disagrees with loadEventsFromFile");
+        }
+        report.write("parseEventLine", 1, lines.size(), buffer.size(), seconds);
+    }
+
+    // Every kernel this CPU runs (DelimiterScanTest checks that they agree)
+    if (report.selected("scanLines") || report.selected("countNewlines")) {
+        for (ScanKernel kernel : {ScanKernel::SCALAR, ScanKernel::SSE2, ScanKernel::AVX2}) {
+            if (!scanKernelSupported(kernel)) {
+                continue;
+            }
+            const std::string name = scanKernelName(kernel);
+            if (report.selected("scanLines/" + name)) {
+                std::vector<LineDelimiters> window;
+                std::size_t lineCount = 0;
+                const auto seconds = timeRuns(options.repeat, [&] {
+                    lineCount = 0;
+                    for (std::size_t position = 0; position < buffer.size();) {
+                        position = scanLines(buffer, position, 1024, window, kernel);
+                        lineCount += window.size();
+                    }
+                });
+                report.write("scanLines/" + name, 1, lineCount, buffer.size(), seconds);
+            }
+            if (report.selected("countNewlines/" + name)) {
+                std::size_t newlines = 0;
+                const auto seconds = timeRuns(options.repeat, [&] { newlines = countNewlines(buffer, kernel); });
+                report.write("countNewlines/" + name, 1, newlines, buffer.size(), seconds);
+            }
+        }
+    }
+
+    if (report.selected("stringToType")) {
+        std::uint64_t checksum = 0;
+        const auto seconds = timeRuns(options.repeat, [&] {
+            checksum = 0;
+            for (std::string_view name : typeNames) {
+                checksum += static_cast<std::uint64_t>(GameEvent::stringToType(name));
+            }
+        });
+        for (std::size_t i = 0; i < typeNames.size() && typeNames.size() == eventCount; ++i) {
+            const EventType type = GameEvent::stringToType(typeNames[i]);
+            if ((type == EventType::UNKNOWN ? EventType::OTHER : type) != wizard.getAllEvents().typeAt(i)) {
+                failCheck("stringToType disagrees with loadEventsFromFile on '" + std::string(typeNames[i]) + "'");
+            }
+        }
+        report.write("stringToType", 1, typeNames.size(), 0, seconds);
+    }
+
+    if (report.selected("findHighlights")) {
+        const auto seconds = timeRuns(options.repeat, [&] { wizard.findHighlights(); });
+        report.write("findHighlights", 1, eventCount, 0, seconds);
+    }
+
+    // Rules with windows walk the events in time order instead of scanning a column
+    if (report.selected("findHighlightsWindowed")) {
+        HighlightWizard windowed = wizard;
+        windowed.setHighlightRules(HighlightRuleSet::fromText(
+            "goal single GOAL\n"
+            "red_card single RED_CARD\n"
+            "bookings count 2 YELLOW_CARD within 10\n"
+            "pressure count 3 FOUL within 5\n"
+            "reaction sequence GOAL SUBSTITUTION within 2\n"));
+        const auto seconds = timeRuns(options.repeat, [&] { windowed.findHighlights(); });
+        report.write("findHighlightsWindowed", 1, eventCount, 0, seconds);
+    }
+
+    // A 4-minute reel out of every goal and red card; checked against the selection rule:
+    // no clip left out that would still fit outweighs a chosen one
+    if (report.selected("selectHighlightReel")) {
+        HighlightWizard scored = wizard;
+        scored.findHighlights();
+        constexpr int budgetSeconds = 240;
+        HighlightReel reel;
+        const auto seconds = timeRuns(options.repeat, [&] { reel = scored.selectHighlightReel(budgetSeconds); });
+        const std::vector<ScoredHighlight> candidates = scored.scoreHighlights();
+        double lightestChosen = std::numeric_limits<double>::infinity();
+        std::vector<bool> chosen(eventCount, false);
+        for (const ScoredHighlight& clip : reel.clips) {
+            lightestChosen = std::min(lightestChosen, clip.weight);
+            chosen[clip.row] = true;
+        }
+        for (const ScoredHighlight& candidate : candidates) {
+            if (!chosen[candidate.row] && candidate.clipSeconds <= budgetSeconds - reel.totalSeconds &&
+                candidate.weight > lightestChosen) {
+                failCheck("the reel left out a heavier clip that fits");
+            }
+        }
+        if (reel.totalSeconds > budgetSeconds || (reel.clips.empty() && !candidates.empty())) {
+            failCheck("the reel does not fill its budget properly");
+        }
+        report.write("selectHighlightReel", 1, candidates.size(), 0, seconds);
+    }
+
+    // Queries made of words of the log itself, so any log has hits; each one is
+    // checked against the scan that searchDescriptions falls back to without an index
+    if (report.selected("DescriptionIndex") || report.selected("searchDescriptions")) {
+        HighlightWizard indexed = wizard;
+        const auto seconds = timeRuns(options.repeat, [&] { indexed.buildDescriptionIndex(); });
+        if (report.selected("buildDescriptionIndex")) {
+            report.write("buildDescriptionIndex", 1, eventCount, 0, seconds);
+        }
+
+        std::vector<DescriptionQuery> queries;
+        for (std::size_t i = 0; i < 3 && eventCount != 0; ++i) {
+            const std::string_view description = wizard.getAllEvents().descriptionAt(i * (eventCount / 3));
+            const std::string_view firstWord = description.substr(0, description.find(' '));
+            const std::string_view firstTwoWords = description.substr(0, description.find(' ', firstWord.size() + 1));
+            queries.push_back(DescriptionQuery::parse(firstWord));
+            queries.push_back(DescriptionQuery::parse("\"" + std::string(firstTwoWords) + "\""));
+            queries.push_back(queries.back());
+            queries.back().types = {EventType::GOAL, EventType::FOUL};
+        }
+        for (const DescriptionQuery& query : queries) {
+            if (indexed.searchDescriptions(query) != wizard.searchDescriptions(query)) {
+                failCheck("searchDescriptions with an index disagrees with the scan");
+            }
+        }
+        if (report.selected("searchDescriptions")) {
+            const auto searchSeconds = timeRuns(options.repeat, [&] {
+                for (const DescriptionQuery& query : queries) {
+                    indexed.searchDescriptions(query);
+                }
+            });
+            report.write("searchDescriptions", 1, queries.size(), 0, searchSeconds);
+        }
+    }
+
+    if (report.selected("printHighlights")) {
+        wizard.findHighlights();
+        const fs::path reportPath = fs::temp_directory_path() / "highlight_wizard_benchmark.highlights.txt";
+        std::uint64_t reportBytes = 0;
+        const auto seconds = timeRuns(options.repeat, [&] {
+            std::ofstream highlights(reportPath, std::ios::trunc);
+            wizard.printHighlights(highlights);
+            reportBytes = static_cast<std::uint64_t>(highlights.tellp());
+        });
+        fs::remove(reportPath);
+        report.write("printHighlights", 1, wizard.getHighlights().size(), reportBytes, seconds);
+    }
+
+    // Each export is read back and checked to hold one record per event
+    for (ExportFormat format : {ExportFormat::JSON_LINES, ExportFormat::CSV, ExportFormat::BINARY}) {
+        const std::string formatName = exportFormatName(format);
+        for (const bool highlightsOnly : {false, true}) {
+            const std::string name = (highlightsOnly ? "exportHighlights/" : "exportEvents/") + formatName;
+            if (!report.selected(name)) {
+                continue;
+            }
+            if (highlightsOnly) {
+                wizard.findHighlights();
+            }
+            const EventIndexView highlights = wizard.getHighlights();
+            const std::size_t records = highlightsOnly ? highlights.size() : eventCount;
+            const fs::path exportPath = fs::temp_directory_path() / ("highlight_wizard_benchmark.export." + formatName);
+            std::uint64_t exportBytes = 0;
+            const auto seconds = timeRuns(options.repeat, [&] {
+                std::ofstream exported(exportPath, std::ios::binary | std::ios::trunc);
+                exportBytes = highlightsOnly ? wizard.exportHighlights(exported, format)
+                                             : wizard.exportEvents(exported, format);
+            });
+
+            std::uint64_t descriptionBytes = 0;
+            for (std::size_t i = 0; i < records; ++i) {
+                descriptionBytes += (highlightsOnly ? highlights[i] : wizard.getAllEvents()[i]).description.size();
+            }
+            const MappedFile exported(exportPath.string());
+            // Binary: the header, 13 bytes and the description a record, and the trailer
+            std::uint64_t expectedBinaryBytes = 8 + 4 + 1 + 13 * records + descriptionBytes + 12;
+            for (std::string_view typeName : eventTypeNames) {
+                expectedBinaryBytes += 1 + typeName.size();
+            }
+            const std::size_t headerLines = format == ExportFormat::CSV ? 1 : 0;
+            const bool complete = format == ExportFormat::BINARY
+                                      ? exported.size() == expectedBinaryBytes
+                                      : countNewlines(exported.view()) == records + headerLines;
+            if (exported.size() != exportBytes || !complete) {
+                fs::remove(exportPath);
+                failCheck("the " + formatName + " export does not hold " + std::to_string(records) + " records");
+            }
+            fs::remove(exportPath);
+            report.write(name, 1, records, exportBytes, seconds);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    fs::path generatedLog;
+    try {
+        if (!parseArguments(argc, argv, options)) {
+            return EXIT_SUCCESS;
+        }
+
+        std::string logFile = options.logFile;
+        if (logFile.empty()) {
+            generatedLog = fs::temp_directory_path() / "highlight_wizard_benchmark.log";
+            std::ofstream out(generatedLog, std::ios::binary);
+            if (!out.is_open()) {
+                throw std::runtime_error("Could not write file: " + generatedLog.string());
+            }
+            MatchLogOptions logOptions;
+            logOptions.eventCount = options.eventCount;
+            generateMatchLog(logOptions, out);
+            logFile = generatedLog.string();
+        }
+
+        if (options.outputFile.empty()) {
+            runBenchmarks(options, logFile, std::cout);
+        } else {
+            std::ofstream out(options.outputFile, std::ios::app);
+            if (!out.is_open()) {
+                throw std::runtime_error("Could not write file: " + options.outputFile);
+            }
+            runBenchmarks(options, logFile, out);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        if (!generatedLog.empty()) {
+            fs::remove(generatedLog);
+        }
+        return EXIT_FAILURE;
+    }
+    if (!generatedLog.empty()) {
+        fs::remove(generatedLog);
+    }
+    return EXIT_SUCCESS;
+}
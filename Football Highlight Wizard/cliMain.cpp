@@ -0,0 +1,560 @@
+#include "cutList.h"
+#include "highlightWizard.h"
+#include "matchLogs.h"
+#include "workStealingPool.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Headless batch front end: loads every given match log, finds its highlights
+// and writes one "<match>.highlights.txt" report per log. Matches are spread
+// over a work-stealing pool, so the job scales with the number of cores.
+// With --search it prints the events whose description matches instead.
+
+namespace fs = std::filesystem;
+
+namespace {
+
+struct CliOptions {
+    std::vector<std::string> inputs;   // Files and/or directories
+    fs::path outputDirectory;          // Empty: write next to each log
+    unsigned jobs = 0;                 // Concurrent matches, 0 = all cores
+    unsigned parseThreads = 1;         // Parser threads per match
+    bool lenient = false;              // Skip malformed lines instead of failing the match
+    bool cache = false;                // Keep and use <log>.hwc binary caches of the parsed events
+    bool follow = false;               // Live mode: tail a single log that is still growing
+    unsigned pollMilliseconds = 20;    // Live mode poll interval
+    std::string rulesFile;             // Empty: the built-in highlight rules
+    std::string statsFile;             // Pipeline statistics as JSON ("-": stdout), empty: none
+    bool search = false;               // Search the descriptions instead of writing reports
+    DescriptionQuery query;            // --search, --type and --minutes together
+    bool indexCache = false;           // Keep a description index next to the reports
+    bool mergeFeeds = false;           // Logs with the same match name are feeds of one match
+    int duplicateMinutes = FeedMergeOptions().duplicateToleranceMinutes;
+    unsigned reelSeconds = 0;          // Also write a <match>.reel.txt of this length, 0: none
+    std::string video;                 // MP4 of the match, or a directory of <match>.mp4; empty: no cut list
+    std::string cutFormat = "edl";     // Of the cut list: "edl" or "json"
+    CutListOptions cutListOptions;     // Where the match is in the video
+    bool exportData = false;           // Also write <match>.events.<ext> and <match>.highlights.<ext>
+    ExportFormat exportFormat = ExportFormat::JSON_LINES;
+};
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options] <log file or directory>...\n"
+              << "\n"
+              << "Finds the highlights of every match log and writes <match>.highlights.txt per log.\n"
+              << "Directories are searched recursively for *.log files, also gzip or zstd compressed\n"
+              << "(*.log.gz, *.log.zst); compressed logs are read without unpacking them. Logs with\n"
+              << "other names (e.g. match.txt) are read when given explicitly.\n"
+              << "\n"
+              << "Options:\n"
+              << "  -o, --output <dir>       Directory for the reports (default: next to each log)\n"
+              << "  -j, --jobs <n>           Matches processed concurrently (default: all cores)\n"
+              << "  --parse-threads <n>      Parser threads per match log (default: 1)\n"
+              << "  --lenient                Skip malformed lines (reported in one summary per log)\n"
+              << "                           instead of failing the match at the first one\n"
+              << "  --cache                  Keep the parsed events of each log in <log>.hwc and load\n"
+              << "                           them from there, without parsing, while the log is unchanged\n"
+              << "  -f, --follow             Follow one log that is still being written and print\n"
+              << "                           each highlight as soon as its line is appended\n"
+              << "  --poll-ms <n>            Poll interval for --follow (default: 20)\n"
+              << "  --rules <file>           Highlight rules, one per line (default: every goal and\n"
+              << "                           red card), e.g. 'bookings count 2 YELLOW_CARD within 10'\n"
+              << "  --reel-seconds <n>       Also write <match>.reel.txt: the best highlights whose\n"
+              << "                           clips fit in n seconds, e.g. 240 for a 4-minute reel\n"
+              << "  --video <file|dir>       Also write a cut list of the highlights (of the reel,\n"
+              << "                           with --reel-seconds) for the match video: one MP4, or a\n"
+              << "                           directory holding <match>.mp4 for every match. Clips start\n"
+              << "                           on keyframes, so they can be cut without re-encoding\n"
+              << "  --cut-format <edl|json>  Cut list format: <match>.cuts.edl (default) or .cuts.json\n"
+              << "  --kickoff-seconds <s>    With --video: video time of the kickoff (default: 0)\n"
+              << "  --second-half-seconds <s>\n"
+              << "                           With --video: video time of the second-half kickoff\n"
+              << "                           (default: the video runs on from the kickoff)\n"
+              << "  --export <jsonl|csv|binary>\n"
+              << "                           Also write every event and the highlights for other\n"
+              << "                           tools: <match>.events.<ext> and <match>.highlights.<ext>\n"
+              << "                           (JSON Lines, CSV or the compact .hwe binary format)\n"
+              << "  --stats <file|->         Write per-stage timings of all matches as JSON (needs a\n"
+              << "                           build with HIGHLIGHT_WIZARD_INSTRUMENTATION=ON)\n"
+              << "  --search <text>          Print the events whose description has every word of\n"
+              << "                           <text> (quote phrases: 'neymar \"free kick\"') instead\n"
+              << "                           of writing reports\n"
+              << "  --type <T[,T...]>        Only events of these types, e.g. GOAL,RED_CARD\n"
+              << "  --minutes <a-b>          Only events from minute a to minute b\n"
+              << "  --index-cache            With --search: reuse <match>.descriptions.idx next to\n"
+              << "                           the reports, or build and save it\n"
+              << "  --merge-feeds            Logs with the same match name (e.g. providerA/final.log\n"
+              << "                           and providerB/final.log.gz) are feeds of one match: they\n"
+              << "                           are merged, without duplicate events, into one report\n"
+              << "  --duplicate-minutes <n>  With --merge-feeds: events of two feeds with the same\n"
+              << "                           type and description at most n minutes apart are one\n"
+              << "                           event (default: 1)\n"
+              << "  -h, --help               Show this help\n";
+}
+
+unsigned parseCount(const std::string& option, const std::string& value) {
+    try {
+        std::size_t used = 0;
+        int count = std::stoi(value, &used);
+        if (used == value.size() && count >= 0) {
+            return static_cast<unsigned>(count);
+        }
+    } catch (const std::exception&) {
+        // Reported below
+    }
+    throw std::runtime_error("Invalid value for " + option + ": '" + value + "'");
+}
+
+// A non-negative number of seconds, e.g. "62.5"
+double parseSeconds(const std::string& option, const std::string& value) {
+    try {
+        std::size_t used = 0;
+        const double seconds = std::stod(value, &used);
+        if (used == value.size() && seconds >= 0) {
+            return seconds;
+        }
+    } catch (const std::exception&) {
+        // Reported below
+    }
+    throw std::runtime_error("Invalid value for " + option + ": '" + value + "'");
+}
+
+// "GOAL,RED_CARD" -> the types; the names are the ones used in the logs
+std::vector<EventType> parseTypes(const std::string& value) {
+    std::vector<EventType> types;
+    std::size_t begin = 0;
+    while (begin <= value.size()) {
+        const std::size_t end = std::min(value.find(',', begin), value.size());
+        const std::string name = value.substr(begin, end - begin);
+        const EventType type = GameEvent::stringToType(name); // Case-insensitive
+        if (type == EventType::UNKNOWN) {
+            throw std::runtime_error("Unknown event type for --type: '" + name + "'");
+        }
+        types.push_back(type);
+        begin = end + 1;
+    }
+    return types;
+}
+
+// "10-45" -> first and last minute
+void parseMinutes(const std::string& value, DescriptionQuery& query) {
+    const std::size_t dash = value.find('-', 1);
+    if (dash == std::string::npos) {
+        throw std::runtime_error("Invalid value for --minutes: '" + value + "' (expected <a-b>)");
+    }
+    query.firstMinute = static_cast<int>(parseCount("--minutes", value.substr(0, dash)));
+    query.lastMinute = static_cast<int>(parseCount("--minutes", value.substr(dash + 1)));
+}
+
+// Returns false if the program should exit right away (help was shown)
+bool parseArguments(int argc, char* argv[], CliOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto nextValue = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return false;
+        } else if (arg == "-o" || arg == "--output") {
+            options.outputDirectory = nextValue();
+        } else if (arg == "-j" || arg == "--jobs") {
+            options.jobs = parseCount(arg, nextValue());
+        } else if (arg == "--parse-threads") {
+            options.parseThreads = parseCount(arg, nextValue());
+        } else if (arg == "--lenient") {
+            options.lenient = true;
+        } else if (arg == "--cache") {
+            options.cache = true;
+        } else if (arg == "-f" || arg == "--follow") {
+            options.follow = true;
+        } else if (arg == "--poll-ms") {
+            options.pollMilliseconds = parseCount(arg, nextValue());
+        } else if (arg == "--rules") {
+            options.rulesFile = nextValue();
+        } else if (arg == "--reel-seconds") {
+            options.reelSeconds = parseCount(arg, nextValue());
+        } else if (arg == "--video") {
+            options.video = nextValue();
+        } else if (arg == "--cut-format") {
+            options.cutFormat = nextValue();
+            if (options.cutFormat != "edl" && options.cutFormat != "json") {
+                throw std::runtime_error("Invalid value for --cut-format: '" + options.cutFormat + "' (expected edl or json)");
+            }
+        } else if (arg == "--kickoff-seconds") {
+            options.cutListOptions.kickoffSeconds = parseSeconds(arg, nextValue());
+        } else if (arg == "--second-half-seconds") {
+            options.cutListOptions.secondHalfKickoffSeconds = parseSeconds(arg, nextValue());
+        } else if (arg == "--export") {
+            options.exportFormat = exportFormatFromName(nextValue());
+            options.exportData = true;
+        } else if (arg == "--stats") {
+            options.statsFile = nextValue();
+        } else if (arg == "--search") {
+            const DescriptionQuery parsed = DescriptionQuery::parse(nextValue());
+            options.query.phrases.insert(options.query.phrases.end(), parsed.phrases.begin(), parsed.phrases.end());
+            options.search = true;
+        } else if (arg == "--type") {
+            options.query.types = parseTypes(nextValue());
+        } else if (arg == "--minutes") {
+            parseMinutes(nextValue(), options.query);
+        } else if (arg == "--index-cache") {
+            options.indexCache = true;
+        } else if (arg == "--merge-feeds") {
+            options.mergeFeeds = true;
+        } else if (arg == "--duplicate-minutes") {
+            options.duplicateMinutes = static_cast<int>(parseCount(arg, nextValue()));
+        } else if (!arg.empty() && arg[0] == '-') {
+            throw std::runtime_error("Unknown option: " + arg);
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+    if (options.inputs.empty()) {
+        throw std::runtime_error("No input files or directories given (see --help)");
+    }
+    if (options.follow && options.inputs.size() != 1) {
+        throw std::runtime_error("--follow takes exactly one log file");
+    }
+    if (options.follow && !options.statsFile.empty()) {
+        throw std::runtime_error("--stats cannot be combined with --follow");
+    }
+    if (options.search && options.follow) {
+        throw std::runtime_error("--search cannot be combined with --follow");
+    }
+    if (!options.search && (!options.query.types.empty() || options.indexCache ||
+                            options.query.firstMinute != DescriptionQuery().firstMinute)) {
+        throw std::runtime_error("--type, --minutes and --index-cache need --search");
+    }
+    if (options.reelSeconds > 0 && (options.search || options.follow)) {
+        throw std::runtime_error("--reel-seconds cannot be combined with --search or --follow");
+    }
+    if (!options.video.empty() && (options.search || options.follow)) {
+        throw std::runtime_error("--video cannot be combined with --search or --follow");
+    }
+    if (options.exportData && (options.search || options.follow)) {
+        throw std::runtime_error("--export cannot be combined with --search or --follow");
+    }
+    if (options.mergeFeeds && options.follow) {
+        throw std::runtime_error("--merge-feeds cannot be combined with --follow");
+    }
+    return true;
+}
+
+// One match to process: its log, or with --merge-feeds all the logs (feeds) with its
+// match name, in the order they were found
+std::vector<std::vector<fs::path>> groupMatchLogs(const std::vector<fs::path>& logs, bool mergeFeeds) {
+    std::vector<std::vector<fs::path>> matches;
+    std::map<std::string, std::size_t> matchByName;
+    for (const auto& log : logs) {
+        if (!mergeFeeds) {
+            matches.push_back({log});
+            continue;
+        }
+        const auto [found, added] = matchByName.emplace(matchNameOf(log), matches.size());
+        if (added) {
+            matches.emplace_back();
+        }
+        matches[found->second].push_back(log);
+    }
+    return matches;
+}
+
+fs::path reportPathFor(const fs::path& log, const fs::path& outputDirectory) {
+    fs::path directory = outputDirectory.empty() ? log.parent_path() : outputDirectory;
+    return directory / (matchNameOf(log) + ".highlights.txt");
+}
+
+// Every match needs report paths of its own: same-named logs from different
+// directories collide under -o, and "m.log" collides with "m.log.gz" next to it
+void checkReportPaths(const std::vector<std::vector<fs::path>>& matches, const fs::path& outputDirectory) {
+    std::map<fs::path, fs::path> logByReport;
+    for (const auto& feeds : matches) {
+        const fs::path reportPath = reportPathFor(feeds.front(), outputDirectory);
+        const auto [found, added] = logByReport.emplace(reportPath.lexically_normal(), feeds.front());
+        if (!added) {
+            throw std::runtime_error("The reports of " + found->second.string() + " and " + feeds.front().string() +
+                                     " would both be written to " + reportPath.string() +
+                                     " (use --merge-feeds if they are feeds of one match)");
+        }
+    }
+}
+
+fs::path reelPathFor(const fs::path& log, const fs::path& outputDirectory) {
+    fs::path directory = outputDirectory.empty() ? log.parent_path() : outputDirectory;
+    return directory / (matchNameOf(log) + ".reel.txt");
+}
+
+fs::path cutListPathFor(const fs::path& log, const fs::path& outputDirectory, const std::string& format) {
+    fs::path directory = outputDirectory.empty() ? log.parent_path() : outputDirectory;
+    return directory / (matchNameOf(log) + ".cuts." + format);
+}
+
+// The match's video: the --video file itself, or <match>.mp4 in the --video directory
+fs::path videoPathFor(const fs::path& log, const std::string& video) {
+    return fs::is_directory(video) ? fs::path(video) / (matchNameOf(log) + ".mp4") : fs::path(video);
+}
+
+// Writes the cut list of the clips (the reel's, or every highlight's) for the match's video
+void writeCutList(const HighlightWizard& wizard, const std::vector<ScoredHighlight>& clips, const fs::path& log,
+                  const CliOptions& options) {
+    const fs::path videoPath = videoPathFor(log, options.video);
+    const KeyframeIndex keyframes = KeyframeIndex::fromFile(videoPath.string());
+    const CutList cutList = buildCutList(clips, keyframes, options.cutListOptions);
+
+    const fs::path cutListPath = cutListPathFor(log, options.outputDirectory, options.cutFormat);
+    std::ofstream out(cutListPath);
+    if (!out.is_open()) {
+        throw std::runtime_error("Could not write cut list: " + cutListPath.string());
+    }
+    if (options.cutFormat == "json") {
+        writeCutListJson(out, cutList, wizard.getAllEvents(), keyframes, videoPath.filename().string());
+    } else {
+        writeCutListEdl(out, cutList, wizard.getAllEvents(), keyframes, matchNameOf(log), videoPath.filename().string());
+    }
+}
+
+// "<match>.events.jsonl", "<match>.highlights.csv", ...
+fs::path exportPathFor(const fs::path& log, const fs::path& outputDirectory, const std::string& content,
+                       ExportFormat format) {
+    fs::path directory = outputDirectory.empty() ? log.parent_path() : outputDirectory;
+    return directory / (matchNameOf(log) + "." + content + "." + exportFileExtension(format));
+}
+
+// Writes every event and the highlights of the match in the --export format
+void writeExports(const HighlightWizard& wizard, const fs::path& log, const CliOptions& options) {
+    for (const std::string content : {"events", "highlights"}) {
+        const fs::path exportPath = exportPathFor(log, options.outputDirectory, content, options.exportFormat);
+        std::ofstream out(exportPath, std::ios::binary);
+        if (!out.is_open()) {
+            throw std::runtime_error("Could not write export: " + exportPath.string());
+        }
+        if (content == "events") {
+            wizard.exportEvents(out, options.exportFormat);
+        } else {
+            wizard.exportHighlights(out, options.exportFormat);
+        }
+    }
+}
+
+fs::path indexPathFor(const fs::path& log, const fs::path& outputDirectory) {
+    fs::path directory = outputDirectory.empty() ? log.parent_path() : outputDirectory;
+    return directory / (matchNameOf(log) + ".descriptions.idx");
+}
+
+// Writes the events of a loaded match that match the search, one per line, and
+// returns how many there are
+std::size_t searchMatch(HighlightWizard& wizard, const fs::path& log, const CliOptions& options, std::ostream& out) {
+    if (options.indexCache) {
+        const fs::path indexPath = indexPathFor(log, options.outputDirectory);
+        try {
+            wizard.loadDescriptionIndex(indexPath.string());
+        } catch (const std::runtime_error&) {
+            // Missing, damaged or built from an older version of the log
+            wizard.buildDescriptionIndex();
+            wizard.saveDescriptionIndex(indexPath.string());
+        }
+    }
+    const std::vector<std::uint32_t> rows = wizard.searchDescriptions(options.query);
+    out << log.string() << ": " << rows.size() << " match(es)\n";
+    for (const EventView& event : EventIndexView(wizard.getAllEvents(), rows)) {
+        out << "  [" << event.timestampMinutes << "'] " << GameEvent::typeToString(event.type)
+            << ": " << event.description << '\n';
+    }
+    return rows.size();
+}
+
+void writePipelineStats(const std::string& statsFile, const PipelineStats& stats) {
+    if (statsFile == "-") {
+        stats.writeJson(std::cout);
+        std::cout << std::endl;
+        return;
+    }
+    std::ofstream out(statsFile);
+    if (!out.is_open()) {
+        throw std::runtime_error("Could not write statistics: " + statsFile);
+    }
+    stats.writeJson(out);
+    out << '\n';
+}
+
+// Prints highlights of a live match as they are appended; runs until interrupted
+int followMatchLog(const CliOptions& options, const HighlightRuleSet& rules) {
+    HighlightWizard wizard;
+    LoadOptions loadOptions;
+    loadOptions.lenient = options.lenient;
+    wizard.setLoadOptions(loadOptions);
+    wizard.setHighlightRules(rules);
+    wizard.setHighlightCallback([](const EventView& highlight) {
+        std::cout << "[" << highlight.timestampMinutes << "'] "
+                  << GameEvent::typeToString(highlight.type) << ": "
+                  << highlight.description << std::endl;
+    });
+    wizard.startLiveTail(options.inputs.front());
+
+    for (;;) {
+        try {
+            wizard.pollLiveTail();
+        } catch (const ParseException& e) {
+            std::cerr << "Warning: " << e.what() << std::endl; // Keep following after a bad line
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(options.pollMilliseconds));
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    CliOptions options;
+    HighlightRuleSet rules = HighlightRuleSet::defaults();
+    std::vector<std::vector<fs::path>> matches;
+    try {
+        if (!parseArguments(argc, argv, options)) {
+            return EXIT_SUCCESS;
+        }
+        if (!options.rulesFile.empty()) {
+            rules = HighlightRuleSet::fromFile(options.rulesFile); // Parsed once, shared by every match
+        }
+        if (!options.statsFile.empty() && !instrumentationEnabled) {
+            std::cerr << "Warning: built without HIGHLIGHT_WIZARD_INSTRUMENTATION, "
+                      << "--stats will only hold zeros" << std::endl;
+        }
+        if (options.follow) {
+            return followMatchLog(options, rules);
+        }
+        matches = groupMatchLogs(collectMatchLogs(options.inputs), options.mergeFeeds);
+        if (!options.search || options.indexCache) {
+            checkReportPaths(matches, options.outputDirectory);
+        }
+        if (!options.video.empty() && !fs::is_directory(options.video) && matches.size() > 1) {
+            throw std::runtime_error("--video with more than one match needs a directory of <match>.mp4 files");
+        }
+        if (!options.outputDirectory.empty()) {
+            fs::create_directories(options.outputDirectory);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    LoadOptions loadOptions;
+    loadOptions.threadCount = options.parseThreads;
+    loadOptions.lenient = options.lenient;
+    loadOptions.useEventCache = options.cache;
+    loadOptions.feedMerge.duplicateToleranceMinutes = options.duplicateMinutes;
+
+    std::atomic<std::size_t> failedMatches{0};
+    std::atomic<std::size_t> totalEvents{0};
+    std::atomic<std::size_t> totalHighlights{0};
+    std::atomic<std::size_t> totalMatches{0}; // Search results
+    std::mutex errorOutputMutex;
+    std::mutex searchOutputMutex;
+    PipelineStats pipelineStats; // All matches together
+    std::mutex pipelineStatsMutex;
+
+    const auto start = std::chrono::steady_clock::now();
+    {
+        WorkStealingPool pool(options.jobs);
+        for (const auto& feeds : matches) {
+            pool.submit([&, feeds] {
+                // One wizard per match: tasks share nothing but the counters
+                HighlightWizard wizard;
+                const fs::path& log = feeds.front(); // Names the report of merged feeds
+                try {
+                    wizard.setLoadOptions(loadOptions);
+                    wizard.setHighlightRules(rules);
+                    if (feeds.size() == 1) {
+                        wizard.loadEventsFromFile(log.string());
+                    } else {
+                        std::vector<std::string> filenames;
+                        for (const auto& feed : feeds) {
+                            filenames.push_back(feed.string());
+                        }
+                        wizard.loadEventsFromFiles(filenames);
+                    }
+
+                    if (options.search) {
+                        std::ostringstream results; // Printed in one piece, not interleaved with other matches
+                        totalMatches += searchMatch(wizard, log, options, results);
+                        std::lock_guard<std::mutex> lock(searchOutputMutex);
+                        std::cout << results.str();
+                    } else {
+                        wizard.findHighlights();
+
+                        const fs::path reportPath = reportPathFor(log, options.outputDirectory);
+                        std::ofstream report(reportPath);
+                        if (!report.is_open()) {
+                            throw std::runtime_error("Could not write report: " + reportPath.string());
+                        }
+                        wizard.printHighlights(report);
+                        totalHighlights += wizard.getHighlights().size();
+
+                        HighlightReel reel;
+                        if (options.reelSeconds > 0) {
+                            reel = wizard.selectHighlightReel(static_cast<int>(options.reelSeconds));
+                            const fs::path reelPath = reelPathFor(log, options.outputDirectory);
+                            std::ofstream reelReport(reelPath);
+                            if (!reelReport.is_open()) {
+                                throw std::runtime_error("Could not write reel: " + reelPath.string());
+                            }
+                            wizard.printHighlightReel(reelReport, reel);
+                        }
+                        if (options.exportData) {
+                            writeExports(wizard, log, options);
+                        }
+                        if (!options.video.empty()) {
+                            writeCutList(wizard, options.reelSeconds > 0 ? reel.clips : wizard.scoreHighlights(),
+                                         log, options);
+                        }
+                    }
+                    totalEvents += wizard.getAllEvents().size();
+                } catch (const std::exception& e) {
+                    ++failedMatches;
+                    std::lock_guard<std::mutex> lock(errorOutputMutex);
+                    std::cerr << "Error processing " << log.string() << ": " << e.what() << std::endl;
+                }
+                if (!options.statsFile.empty()) {
+                    std::lock_guard<std::mutex> lock(pipelineStatsMutex);
+                    pipelineStats.merge(wizard.getPipelineStats());
+                }
+            });
+        }
+        pool.wait();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Processed " << matches.size() << " match log(s) in " << seconds << " s: "
+              << totalEvents.load() << " events, ";
+    if (options.search) {
+        std::cout << totalMatches.load() << " search matches, ";
+    } else {
+        std::cout << totalHighlights.load() << " highlights, ";
+    }
+    std::cout << failedMatches.load() << " failed." << std::endl;
+
+    if (!options.statsFile.empty()) {
+        try {
+            writePipelineStats(options.statsFile, pipelineStats);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    return failedMatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,294 @@
+#include "compressedLog.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+
+#ifndef HIGHLIGHT_WIZARD_WITH_ZLIB
+#define HIGHLIGHT_WIZARD_WITH_ZLIB 0
+#endif
+#ifndef HIGHLIGHT_WIZARD_WITH_ZSTD
+#define HIGHLIGHT_WIZARD_WITH_ZSTD 0
+#endif
+
+#if HIGHLIGHT_WIZARD_WITH_ZLIB
+#include <zlib.h>
+#endif
+#if HIGHLIGHT_WIZARD_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace {
+
+// Compressed bytes read from the file per call
+constexpr std::size_t inputChunkBytes = 256 * 1024;
+
+// One decompression stream. decode() advances both cursors by what it used and
+// produced; it may do neither when it needs more input or more room.
+class StreamDecoder {
+public:
+    virtual ~StreamDecoder() = default;
+    virtual void decode(const char*& input, const char* inputEnd, char*& output, char* outputEnd) = 0;
+    // Whether the data decoded so far ends on a complete gzip member or zstd frame
+    virtual bool atFrameEnd() const = 0;
+};
+
+#if HIGHLIGHT_WIZARD_WITH_ZLIB
+// A gzip file may hold several members back to back ("cat a.gz b.gz"); they
+// decompress to the concatenation of their contents
+class GzipDecoder : public StreamDecoder {
+public:
+    GzipDecoder() {
+        if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) { // 16: expect a gzip header
+            throw std::runtime_error("Could not start gzip decompression");
+        }
+    }
+    ~GzipDecoder() override { inflateEnd(&stream); }
+
+    void decode(const char*& input, const char* inputEnd, char*& output, char* outputEnd) override {
+        if (memberEnded) {
+            if (input == inputEnd) {
+                return;
+            }
+            inflateReset(&stream);
+            memberEnded = false;
+        }
+        constexpr std::size_t maxChunk = std::numeric_limits<uInt>::max();
+        stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input));
+        stream.avail_in = static_cast<uInt>(std::min<std::size_t>(inputEnd - input, maxChunk));
+        stream.next_out = reinterpret_cast<Bytef*>(output);
+        stream.avail_out = static_cast<uInt>(std::min<std::size_t>(outputEnd - output, maxChunk));
+        const int result = inflate(&stream, Z_NO_FLUSH);
+        input = reinterpret_cast<const char*>(stream.next_in);
+        output = reinterpret_cast<char*>(stream.next_out);
+        if (result == Z_STREAM_END) {
+            memberEnded = true;
+        } else if (result != Z_OK && result != Z_BUF_ERROR) {
+            throw std::runtime_error(std::string("Damaged gzip data: ") + (stream.msg ? stream.msg : zError(result)));
+        }
+    }
+
+    bool atFrameEnd() const override { return memberEnded; }
+
+private:
+    z_stream stream{};
+    bool memberEnded = false;
+};
+#endif
+
+#if HIGHLIGHT_WIZARD_WITH_ZSTD
+// Like gzip, a zstd file may hold several frames; one stream decodes them all
+class ZstdDecoder : public StreamDecoder {
+public:
+    ZstdDecoder() : stream(ZSTD_createDStream()) {
+        if (!stream) {
+            throw std::runtime_error("Could not start zstd decompression");
+        }
+        ZSTD_initDStream(stream);
+    }
+    ~ZstdDecoder() override { ZSTD_freeDStream(stream); }
+
+    void decode(const char*& input, const char* inputEnd, char*& output, char* outputEnd) override {
+        ZSTD_inBuffer in{input, static_cast<std::size_t>(inputEnd - input), 0};
+        ZSTD_outBuffer out{output, static_cast<std::size_t>(outputEnd - output), 0};
+        const std::size_t result = ZSTD_decompressStream(stream, &out, &in);
+        if (ZSTD_isError(result)) {
+            throw std::runtime_error(std::string("Damaged zstd data: ") + ZSTD_getErrorName(result));
+        }
+        input += in.pos;
+        output += out.pos;
+        frameEnded = result == 0;
+    }
+
+    bool atFrameEnd() const override { return frameEnded; }
+
+private:
+    ZSTD_DStream* stream;
+    bool frameEnded = true;
+};
+#endif
+
+std::unique_ptr<StreamDecoder> makeDecoder(LogCompression compression) {
+    switch (compression) {
+#if HIGHLIGHT_WIZARD_WITH_ZLIB
+    case LogCompression::GZIP:
+        return std::make_unique<GzipDecoder>();
+#endif
+#if HIGHLIGHT_WIZARD_WITH_ZSTD
+    case LogCompression::ZSTD:
+        return std::make_unique<ZstdDecoder>();
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+const char* compressionName(LogCompression compression) {
+    return compression == LogCompression::ZSTD ? "zstd" : "gzip";
+}
+
+} // namespace
+
+LogCompression detectLogCompression(std::string_view firstBytes) {
+    const auto startsWith = [firstBytes](std::string_view magic) {
+        return firstBytes.substr(0, magic.size()) == magic;
+    };
+    if (startsWith("\x1f\x8b")) {
+        return LogCompression::GZIP;
+    }
+    if (startsWith("\x28\xb5\x2f\xfd")) {
+        return LogCompression::ZSTD;
+    }
+    return LogCompression::NONE;
+}
+
+bool isLogCompressionSupported(LogCompression compression) {
+    switch (compression) {
+    case LogCompression::NONE:
+        return true;
+    case LogCompression::GZIP:
+        return HIGHLIGHT_WIZARD_WITH_ZLIB;
+    case LogCompression::ZSTD:
+        return HIGHLIGHT_WIZARD_WITH_ZSTD;
+    }
+    return false;
+}
+
+DecompressingReader::DecompressingReader(const std::string& filename, LogCompression compression,
+                                         std::size_t blockBytes, std::size_t blockCount)
+    : filename(filename), compression(compression) {
+    std::error_code sizeError;
+    fileSize = std::filesystem::file_size(filename, sizeError);
+    if (sizeError || !std::ifstream(filename, std::ios::binary).is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    if (compression == LogCompression::NONE || !isLogCompressionSupported(compression)) {
+        throw std::runtime_error(std::string("Reading ") + compressionName(compression) +
+                                 "-compressed logs needs a build with " +
+                                 (compression == LogCompression::ZSTD ? "libzstd" : "zlib") + ": " + filename);
+    }
+
+    // Two blocks at least, so one can be parsed while the next one fills
+    blocks.assign(std::max<std::size_t>(blockCount, 2), std::string(std::max<std::size_t>(blockBytes, 1), '\0'));
+    for (std::size_t i = 0; i < blocks.size(); ++i) {
+        freeBlocks.push_back(i);
+    }
+    blockInUse = blocks.size();
+    decompressor = std::thread(&DecompressingReader::decompress, this);
+}
+
+DecompressingReader::~DecompressingReader() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    blockFreed.notify_all();
+    decompressor.join();
+}
+
+std::string_view DecompressingReader::next() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (blockInUse != blocks.size()) {
+        freeBlocks.push_back(blockInUse);
+        blockInUse = blocks.size();
+        blockFreed.notify_one();
+    }
+    blockFilled.wait(lock, [this] { return !filledBlocks.empty() || finished; });
+    if (!filledBlocks.empty()) {
+        const auto [index, size] = filledBlocks.front();
+        filledBlocks.pop_front();
+        blockInUse = index;
+        return std::string_view(blocks[index].data(), size);
+    }
+    // Everything decompressed before a failure has been handed out by now
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return {};
+}
+
+std::string* DecompressingReader::acquireBlock(std::size_t& index) {
+    std::unique_lock<std::mutex> lock(mutex);
+    blockFreed.wait(lock, [this] { return !freeBlocks.empty() || stopping; });
+    if (stopping) {
+        return nullptr;
+    }
+    index = freeBlocks.front();
+    freeBlocks.pop_front();
+    return &blocks[index];
+}
+
+void DecompressingReader::publishBlock(std::size_t index, std::size_t size) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        filledBlocks.emplace_back(index, size);
+    }
+    blockFilled.notify_one();
+}
+
+void DecompressingReader::decompress() {
+    try {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Could not open file: " + filename);
+        }
+        const std::unique_ptr<StreamDecoder> decoder = makeDecoder(compression);
+        std::vector<char> input(inputChunkBytes);
+        const char* inputPosition = input.data();
+        const char* inputEnd = input.data();
+        bool endOfFile = false;
+
+        std::size_t blockIndex = 0;
+        std::string* block = acquireBlock(blockIndex);
+        char* output = block ? block->data() : nullptr;
+        while (block) {
+            if (inputPosition == inputEnd && !endOfFile) {
+                file.read(input.data(), static_cast<std::streamsize>(input.size()));
+                if (file.bad()) {
+                    throw std::runtime_error("Could not read file: " + filename);
+                }
+                const std::size_t count = static_cast<std::size_t>(file.gcount());
+                endOfFile = count == 0;
+                inputPosition = input.data();
+                inputEnd = input.data() + count;
+                bytesRead.fetch_add(count, std::memory_order_relaxed);
+            }
+
+            char* const blockEnd = block->data() + block->size();
+            const char* const inputBefore = inputPosition;
+            char* const outputBefore = output;
+            try {
+                decoder->decode(inputPosition, inputEnd, output, blockEnd);
+            } catch (const std::runtime_error& e) {
+                throw std::runtime_error(std::string(e.what()) + " in file " + filename);
+            }
+
+            if (output == blockEnd) {
+                publishBlock(blockIndex, block->size());
+                block = acquireBlock(blockIndex);
+                output = block ? block->data() : nullptr;
+            } else if (inputPosition == inputBefore && output == outputBefore && inputPosition == inputEnd && endOfFile) {
+                // The whole file is decoded and the decoder holds nothing back
+                if (!decoder->atFrameEnd()) {
+                    throw std::runtime_error(std::string("Truncated ") + compressionName(compression) + " data in file " + filename);
+                }
+                if (output != block->data()) {
+                    publishBlock(blockIndex, static_cast<std::size_t>(output - block->data()));
+                }
+                break;
+            } else if (inputPosition == inputBefore && output == outputBefore && inputPosition != inputEnd) {
+                throw std::runtime_error(std::string("Damaged ") + compressionName(compression) + " data in file " + filename);
+            }
+        }
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        error = std::current_exception();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    blockFilled.notify_all();
+}
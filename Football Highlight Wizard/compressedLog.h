@@ -0,0 +1,84 @@
+#ifndef COMPRESSEDLOG_H
+#define COMPRESSEDLOG_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// How a log file is stored on disk
+enum class LogCompression : std::uint8_t {
+    NONE,
+    GZIP, // Needs zlib (HIGHLIGHT_WIZARD_WITH_ZLIB)
+    ZSTD, // Needs libzstd (HIGHLIGHT_WIZARD_WITH_ZSTD)
+};
+
+// Recognises the format by its magic number (not by the file name), so a
+// renamed archive still loads
+LogCompression detectLogCompression(std::string_view firstBytes);
+
+// Whether this build can decompress the format
+bool isLogCompressionSupported(LogCompression compression);
+
+// Decompresses a file on a background thread into a few fixed-size blocks
+// that the caller consumes one at a time, so decompression and parsing run on
+// two cores and memory use depends on the block size, not on the file size.
+// The decompressor waits whenever every block is full and not consumed yet.
+class DecompressingReader {
+public:
+    static constexpr std::size_t defaultBlockBytes = 1 << 20;
+    static constexpr std::size_t defaultBlockCount = 4;
+
+    // Starts decompressing the file
+    // Throws std::runtime_error if the file cannot be opened or this build cannot
+    // decompress the format
+    DecompressingReader(const std::string& filename, LogCompression compression,
+                        std::size_t blockBytes = defaultBlockBytes, std::size_t blockCount = defaultBlockCount);
+    // Stops the decompressor, also halfway through the file
+    ~DecompressingReader();
+
+    DecompressingReader(const DecompressingReader&) = delete;
+    DecompressingReader& operator=(const DecompressingReader&) = delete;
+
+    // The next decompressed bytes, empty at the end of the data. The view is valid
+    // until the next call. Blocks end anywhere, also in the middle of a line.
+    // Throws std::runtime_error if the data is damaged or truncated
+    std::string_view next();
+
+    // Compressed bytes read from the file so far; may be called from any thread
+    std::uint64_t compressedBytesRead() const { return bytesRead.load(std::memory_order_relaxed); }
+    std::uint64_t compressedSize() const { return fileSize; }
+
+private:
+    std::string filename;
+    LogCompression compression;
+    std::uint64_t fileSize = 0;
+    std::atomic<std::uint64_t> bytesRead{0};
+
+    std::vector<std::string> blocks;
+    std::deque<std::size_t> freeBlocks;
+    std::deque<std::pair<std::size_t, std::size_t>> filledBlocks; // Block and bytes used
+    std::size_t blockInUse;     // Handed out by next(), blocks.size() if none
+    bool finished = false;      // The decompressor has filled its last block
+    bool stopping = false;      // The reader is being destroyed
+    std::exception_ptr error;   // Why the decompressor stopped early
+    std::mutex mutex;
+    std::condition_variable blockFreed;
+    std::condition_variable blockFilled;
+    std::thread decompressor;
+
+    void decompress();
+    // A free block to fill, or nullptr once the reader is stopping
+    std::string* acquireBlock(std::size_t& index);
+    void publishBlock(std::size_t index, std::size_t size);
+};
+
+#endif // COMPRESSEDLOG_H
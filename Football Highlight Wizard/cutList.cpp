@@ -0,0 +1,130 @@
+#include "cutList.h"
+#include "jsonString.h"
+#include <algorithm>
+#include <charconv> // For std::to_chars
+#include <cmath>
+#include <cstdio>   // For std::snprintf
+#include <numeric>
+#include <ostream>
+
+namespace {
+
+// Shortest text that reads back as the same double, so a script seeking to a
+// cut's start lands on the keyframe itself and not just after it
+std::string formatSeconds(double seconds) {
+    char digits[32];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), seconds);
+    return std::string(digits, result.ptr);
+}
+
+// HH:MM:SS:FF, counting frames at the real rate and labelling them at the nominal
+// one (non-drop-frame timecode, as editors expect for 29.97 fps too)
+std::string timecode(double seconds, double frameRate, long long framesPerSecond) {
+    const long long frames = std::llround(std::max(0.0, seconds) * frameRate);
+    const long long wholeSeconds = frames / framesPerSecond;
+    char text[96];
+    std::snprintf(text, sizeof(text), "%02lld:%02lld:%02lld:%02lld", wholeSeconds / 3600, wholeSeconds / 60 % 60,
+                  wholeSeconds % 60, frames % framesPerSecond);
+    return text;
+}
+
+} // namespace
+
+double videoSecondsForMinute(int minute, const CutListOptions& options) {
+    if (options.secondHalfKickoffSeconds >= 0 && minute >= options.secondHalfStartMinute) {
+        return options.secondHalfKickoffSeconds + 60.0 * (minute - options.secondHalfStartMinute);
+    }
+    return options.kickoffSeconds + 60.0 * minute;
+}
+
+CutList buildCutList(const std::vector<ScoredHighlight>& clips, const KeyframeIndex& keyframes,
+                     const CutListOptions& options) {
+    std::vector<std::size_t> order(clips.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        const ScoredHighlight& clipA = clips[a];
+        const ScoredHighlight& clipB = clips[b];
+        return clipA.timestampMinutes != clipB.timestampMinutes ? clipA.timestampMinutes < clipB.timestampMinutes
+                                                                : clipA.row < clipB.row;
+    });
+
+    CutList cutList;
+    const double videoEnd = keyframes.durationSeconds();
+    for (std::size_t index : order) {
+        const ScoredHighlight& clip = clips[index];
+        const double requestedStart =
+            std::max(0.0, videoSecondsForMinute(clip.timestampMinutes, options) - options.leadSeconds);
+        if (requestedStart >= videoEnd) {
+            ++cutList.outsideVideo;
+            continue;
+        }
+        const double start = keyframes.keyframeAtOrBefore(requestedStart);
+        const double end = std::min(videoEnd, requestedStart + clip.clipSeconds);
+        if (options.mergeOverlapping && !cutList.cuts.empty() && start <= cutList.cuts.back().endSeconds) {
+            VideoCut& previous = cutList.cuts.back();
+            previous.endSeconds = std::max(previous.endSeconds, end);
+            previous.rows.push_back(clip.row);
+            continue;
+        }
+        cutList.cuts.push_back(VideoCut{start, requestedStart, end, {clip.row}});
+    }
+    for (const VideoCut& cut : cutList.cuts) {
+        cutList.totalSeconds += cut.endSeconds - cut.startSeconds;
+    }
+    return cutList;
+}
+
+void writeCutListEdl(std::ostream& out, const CutList& cutList, const EventStore& events,
+                     const KeyframeIndex& keyframes, const std::string& title, const std::string& videoName) {
+    const double frameRate = keyframes.frameRate() > 0 ? keyframes.frameRate() : 25;
+    const long long framesPerSecond = std::max(1LL, std::llround(frameRate));
+    out << "TITLE: " << title << "\n"
+        << "FCM: NON-DROP FRAME\n";
+
+    double recordSeconds = 0; // Where the cut goes in the edited reel
+    std::size_t number = 0;
+    for (const VideoCut& cut : cutList.cuts) {
+        const double length = cut.endSeconds - cut.startSeconds;
+        char event[16];
+        std::snprintf(event, sizeof(event), "%03zu", ++number);
+        out << "\n" << event << "  AX       B     C        "
+            << timecode(cut.startSeconds, frameRate, framesPerSecond) << ' '
+            << timecode(cut.endSeconds, frameRate, framesPerSecond) << ' '
+            << timecode(recordSeconds, frameRate, framesPerSecond) << ' '
+            << timecode(recordSeconds + length, frameRate, framesPerSecond) << "\n"
+            << "* FROM CLIP NAME: " << videoName << "\n";
+        for (const EventView& highlight : EventIndexView(events, cut.rows)) {
+            out << "* [" << highlight.timestampMinutes << "'] " << GameEvent::typeToString(highlight.type)
+                << ": " << highlight.description << "\n";
+        }
+        recordSeconds += length;
+    }
+}
+
+void writeCutListJson(std::ostream& out, const CutList& cutList, const EventStore& events,
+                      const KeyframeIndex& keyframes, const std::string& videoName) {
+    out << "{\"video\":" << jsonString(videoName)
+        << ",\"frameRate\":" << formatSeconds(keyframes.frameRate())
+        << ",\"durationSeconds\":" << formatSeconds(keyframes.durationSeconds())
+        << ",\"keyframes\":" << keyframes.size()
+        << ",\"totalSeconds\":" << formatSeconds(cutList.totalSeconds)
+        << ",\"outsideVideo\":" << cutList.outsideVideo
+        << ",\"cuts\":[";
+    for (std::size_t i = 0; i < cutList.cuts.size(); ++i) {
+        const VideoCut& cut = cutList.cuts[i];
+        out << (i == 0 ? "\n" : ",\n")
+            << "{\"start\":" << formatSeconds(cut.startSeconds)
+            << ",\"end\":" << formatSeconds(cut.endSeconds)
+            << ",\"requestedStart\":" << formatSeconds(cut.requestedStartSeconds)
+            << ",\"highlights\":[";
+        bool first = true;
+        for (const EventView& highlight : EventIndexView(events, cut.rows)) {
+            out << (first ? "" : ",") << "{\"minute\":" << highlight.timestampMinutes
+                << ",\"type\":" << jsonString(GameEvent::typeToString(highlight.type))
+                << ",\"description\":" << jsonString(highlight.description) << "}";
+            first = false;
+        }
+        out << "]}";
+    }
+    out << "\n]}\n";
+}
@@ -0,0 +1,62 @@
+#ifndef CUTLIST_H
+#define CUTLIST_H
+
+#include "eventStore.h"
+#include "highlightReel.h"
+#include "keyframeIndex.h"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Cut lists of a match video: where each highlight clip starts and ends in the
+// video, every start moved back onto a keyframe so the clips can be cut by stream
+// copy, without re-encoding. Written as a CMX3600 EDL (for editors) or as JSON
+// (for scripts driving e.g. "ffmpeg -ss <start> -to <end> -c copy").
+
+// Where the match is in the video
+struct CutListOptions {
+    double kickoffSeconds = 0;               // Video time of the kickoff (minute 0)
+    // Video time of the second-half kickoff, negative if the video runs straight on
+    // (a minute m is then always kickoffSeconds + 60 m)
+    double secondHalfKickoffSeconds = -1;
+    int secondHalfStartMinute = 45;          // The minute the second half starts at in the log
+    double leadSeconds = 5;                  // Clips start this long before their minute
+    bool mergeOverlapping = true;            // Clips that overlap after snapping become one cut
+};
+
+// One cut of the video
+struct VideoCut {
+    double startSeconds = 0;                 // On a keyframe, at or before requestedStartSeconds
+    double requestedStartSeconds = 0;        // Where the (first) clip wanted to start
+    double endSeconds = 0;
+    std::vector<std::uint32_t> rows;         // The highlights it shows, in time order
+};
+
+struct CutList {
+    std::vector<VideoCut> cuts;              // In video order
+    double totalSeconds = 0;                 // Of all cuts together
+    std::size_t outsideVideo = 0;            // Clips that start after the end of the video, left out
+};
+
+// Video time of a match minute
+double videoSecondsForMinute(int minute, const CutListOptions& options);
+
+// Cuts for the clips (e.g. a HighlightReel's, or all scored highlights): a clip of a
+// highlight at minute m runs from videoSecondsForMinute(m) - leadSeconds for its
+// clipSeconds, its start snapped to the last keyframe at or before it and its end
+// kept within the video. O(n log k) for n clips and k keyframes.
+CutList buildCutList(const std::vector<ScoredHighlight>& clips, const KeyframeIndex& keyframes,
+                     const CutListOptions& options);
+
+// CMX3600 EDL, one event per cut, in non-drop-frame timecode at the video's
+// frame rate; the source clip and each highlight are given as comments
+void writeCutListEdl(std::ostream& out, const CutList& cutList, const EventStore& events,
+                     const KeyframeIndex& keyframes, const std::string& title, const std::string& videoName);
+
+// {"video":..., "frameRate":..., "cuts":[{"start":..., "end":..., "highlights":[...]}], ...}
+void writeCutListJson(std::ostream& out, const CutList& cutList, const EventStore& events,
+                      const KeyframeIndex& keyframes, const std::string& videoName);
+
+#endif // CUTLIST_H
@@ -0,0 +1,583 @@
+#include "highlightService.h"
+#include "matchLogs.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Local query daemon: loads match logs once and answers highlight and time-range
+// queries (see highlightService.h) from any number of local tools over a Unix
+// domain socket. Followed logs keep growing in the daemon while it serves.
+//
+// Every message on the socket is a frame: the payload length as 4 bytes, little
+// endian, then the payload. A connection sends requests one after another and
+// reads each response before the next request.
+//
+// The same program is also the client: --query sends one request, and
+// --bench-clients measures latency and throughput with many concurrent clients.
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::uint32_t maxRequestBytes = 64 * 1024;
+constexpr std::uint32_t maxResponseBytes = 1u << 30;
+
+struct DaemonOptions {
+    std::vector<std::string> inputs;       // Logs and/or directories to serve
+    std::vector<std::string> followed;     // Logs still being written
+    std::string socketPath = (fs::temp_directory_path() / "highlight-wizard.sock").string();
+    unsigned pollMilliseconds = 20;
+    unsigned maxClients = 256;             // Concurrent connections (reader slots)
+    bool lenient = false;
+    std::string rulesFile;
+
+    // Client modes
+    std::string query;                     // Send this request and print the response
+    unsigned benchClients = 0;             // Concurrent clients of the benchmark, 0: no benchmark
+    unsigned benchRequests = 1000;         // Requests per client
+    std::vector<std::string> benchQueries; // Empty: HIGHLIGHTS and RANGE on every match
+    std::string benchAppendLog;            // Append to this (followed) log during the benchmark
+};
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options] <log file or directory>...\n"
+              << "       " << program << " [-s <socket>] --query <request>\n"
+              << "       " << program << " [-s <socket>] --bench-clients <n> [--bench-requests <n>]\n"
+              << "\n"
+              << "Loads the match logs once and answers queries from local tools over a Unix\n"
+              << "domain socket. Logs with the same match name are merged as feeds of one match.\n"
+              << "Requests: MATCHES | HIGHLIGHTS <match> | RANGE <match> <first> <last>\n"
+              << "\n"
+              << "Daemon options:\n"
+              << "  -s, --socket <path>      Socket path (default: highlight-wizard.sock in the\n"
+              << "                           temporary directory)\n"
+              << "  --follow <log>           Also serve a log that is still being written, with\n"
+              << "                           every line appended to it\n"
+              << "  --poll-ms <n>            Poll interval for --follow (default: 20)\n"
+              << "  --max-clients <n>        Concurrent connections (default: 256)\n"
+              << "  --lenient                Skip malformed lines instead of refusing the log\n"
+              << "  --rules <file>           Highlight rules (default: every goal and red card)\n"
+              << "\n"
+              << "Client options (against a running daemon):\n"
+              << "  --query <request>        Send one request and print the response\n"
+              << "  --bench-clients <n>      Run n concurrent clients and print their latency\n"
+              << "                           percentiles and throughput as a JSON line\n"
+              << "  --bench-requests <n>     Requests per client (default: 1000)\n"
+              << "  --bench-query <request>  Request the clients send (repeatable; default:\n"
+              << "                           HIGHLIGHTS and a RANGE on every match)\n"
+              << "  --bench-append <log>     Append an event to this log every millisecond while\n"
+              << "                           the clients run (follow it in the daemon)\n"
+              << "  -h, --help               Show this help\n";
+}
+
+unsigned parseCount(const std::string& option, const std::string& value) {
+    try {
+        std::size_t used = 0;
+        int count = std::stoi(value, &used);
+        if (used == value.size() && count >= 0) {
+            return static_cast<unsigned>(count);
+        }
+    } catch (const std::exception&) {
+        // Reported below
+    }
+    throw std::runtime_error("Invalid value for " + option + ": '" + value + "'");
+}
+
+// Returns false if the program should exit right away (help was shown)
+bool parseArguments(int argc, char* argv[], DaemonOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        auto nextValue = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("Missing value for " + arg);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "-h" || arg == "--help") {
+            printUsage(argv[0]);
+            return false;
+        } else if (arg == "-s" || arg == "--socket") {
+            options.socketPath = nextValue();
+        } else if (arg == "--follow") {
+            options.followed.push_back(nextValue());
+        } else if (arg == "--poll-ms") {
+            options.pollMilliseconds = parseCount(arg, nextValue());
+        } else if (arg == "--max-clients") {
+            options.maxClients = parseCount(arg, nextValue());
+        } else if (arg == "--lenient") {
+            options.lenient = true;
+        } else if (arg == "--rules") {
+            options.rulesFile = nextValue();
+        } else if (arg == "--query") {
+            options.query = nextValue();
+        } else if (arg == "--bench-clients") {
+            options.benchClients = parseCount(arg, nextValue());
+        } else if (arg == "--bench-requests") {
+            options.benchRequests = parseCount(arg, nextValue());
+        } else if (arg == "--bench-query") {
+            options.benchQueries.push_back(nextValue());
+        } else if (arg == "--bench-append") {
+            options.benchAppendLog = nextValue();
+        } else if (!arg.empty() && arg[0] == '-') {
+            throw std::runtime_error("Unknown option: " + arg);
+        } else {
+            options.inputs.push_back(arg);
+        }
+    }
+    const bool client = !options.query.empty() || options.benchClients > 0;
+    if (client && (!options.inputs.empty() || !options.followed.empty())) {
+        throw std::runtime_error("--query and --bench-clients talk to a running daemon: give no logs");
+    }
+    if (!client && options.inputs.empty() && options.followed.empty()) {
+        throw std::runtime_error("No logs to serve (see --help)");
+    }
+    if (options.maxClients == 0) {
+        throw std::runtime_error("--max-clients must be at least 1");
+    }
+    return true;
+}
+
+// --- Match logs (found and named like the batch tool does, see matchLogs.h) ---
+
+// Match name -> its logs (feeds), directories searched recursively
+std::map<std::string, std::vector<std::string>> collectMatches(const std::vector<std::string>& inputs) {
+    std::map<std::string, std::vector<std::string>> matches;
+    for (const auto& log : collectMatchLogs(inputs)) {
+        matches[matchNameOf(log)].push_back(log.string());
+    }
+    return matches;
+}
+
+// --- Frames ---
+
+bool readExactly(int fd, char* data, std::size_t size) {
+    while (size > 0) {
+        const ssize_t count = ::read(fd, data, size);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        data += count;
+        size -= static_cast<std::size_t>(count);
+    }
+    return true;
+}
+
+// False at the end of the connection; throws std::runtime_error for an oversized frame
+bool readFrame(int fd, std::string& payload, std::uint32_t maxBytes) {
+    unsigned char header[4];
+    if (!readExactly(fd, reinterpret_cast<char*>(header), sizeof(header))) {
+        return false;
+    }
+    const std::uint32_t size = header[0] | (header[1] << 8) | (header[2] << 16) | (std::uint32_t{header[3]} << 24);
+    if (size > maxBytes) {
+        throw std::runtime_error("Frame of " + std::to_string(size) + " bytes is too large");
+    }
+    payload.resize(size);
+    return readExactly(fd, payload.data(), size);
+}
+
+// Header and payload in one system call (more if the socket buffer fills up)
+bool writeFrame(int fd, std::string_view payload) {
+    const auto size = static_cast<std::uint32_t>(payload.size());
+    unsigned char header[4] = {static_cast<unsigned char>(size), static_cast<unsigned char>(size >> 8),
+                               static_cast<unsigned char>(size >> 16), static_cast<unsigned char>(size >> 24)};
+    iovec parts[2] = {{header, sizeof(header)}, {const_cast<char*>(payload.data()), payload.size()}};
+    iovec* pending = parts;
+    int pendingCount = 2;
+    while (pendingCount > 0) {
+        const ssize_t count = ::writev(fd, pending, pendingCount);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count <= 0) {
+            return false;
+        }
+        auto written = static_cast<std::size_t>(count);
+        while (pendingCount > 0 && written >= pending->iov_len) {
+            written -= pending->iov_len;
+            ++pending;
+            --pendingCount;
+        }
+        if (pendingCount > 0) {
+            pending->iov_base = static_cast<char*>(pending->iov_base) + written;
+            pending->iov_len -= written;
+        }
+    }
+    return true;
+}
+
+sockaddr_un socketAddress(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Socket path is too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+int connectTo(const std::string& path) {
+    const sockaddr_un address = socketAddress(path);
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        const std::string reason = std::strerror(errno);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        throw std::runtime_error("Could not connect to " + path + ": " + reason);
+    }
+    return fd;
+}
+
+// Sends a request and reads its response; throws std::runtime_error if the connection fails
+void exchange(int fd, std::string_view request, std::string& response) {
+    if (!writeFrame(fd, request) || !readFrame(fd, response, maxResponseBytes)) {
+        throw std::runtime_error("The daemon closed the connection");
+    }
+}
+
+// --- Daemon ---
+
+volatile std::sig_atomic_t stopRequested = 0;
+
+void requestStop(int) {
+    stopRequested = 1;
+}
+
+// The open connections and the threads serving them. Threads are joined, never
+// detached: a finished one is reaped when the next connection starts, and
+// shutdown wakes and joins the rest, so none outlives the daemon's state.
+class ConnectionSet {
+public:
+    ~ConnectionSet() { closeAll(); }
+
+    // Serves the connection on a thread of its own with serve(fd)
+    template <typename Serve>
+    void start(int fd, Serve serve) {
+        reapFinished();
+        std::lock_guard<std::mutex> lock(mutex);
+        const std::uint64_t id = nextId++;
+        open.insert(fd);
+        // Under the lock, so the thread is registered before it can report itself finished
+        threads.emplace(id, std::thread([this, fd, id, serve] {
+            serve(fd);
+            close(fd, id);
+        }));
+    }
+
+    // Ends every connection's blocking read and joins their threads
+    void closeAll() {
+        std::map<std::uint64_t, std::thread> running;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (int fd : open) {
+                ::shutdown(fd, SHUT_RDWR);
+            }
+            running.swap(threads);
+            finished.clear();
+        }
+        for (auto& [id, thread] : running) {
+            thread.join();
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::set<int> open;
+    std::map<std::uint64_t, std::thread> threads;
+    std::vector<std::uint64_t> finished; // Threads that are done serving, still to be joined
+    std::uint64_t nextId = 0;
+
+    // The last thing a connection thread does; closed under the lock, so accept
+    // cannot hand out the same descriptor before it is forgotten
+    void close(int fd, std::uint64_t id) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ::close(fd);
+        open.erase(fd);
+        finished.push_back(id);
+    }
+
+    void reapFinished() {
+        std::vector<std::thread> done;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (std::uint64_t id : finished) {
+                const auto found = threads.find(id);
+                if (found != threads.end()) {
+                    done.push_back(std::move(found->second));
+                    threads.erase(found);
+                }
+            }
+            finished.clear();
+        }
+        for (std::thread& thread : done) {
+            thread.join();
+        }
+    }
+};
+
+void serveConnection(HighlightService& service, int fd) {
+    std::string request;
+    std::string response;
+    try {
+        const std::size_t reader = service.registerReader();
+        try {
+            while (readFrame(fd, request, maxRequestBytes)) {
+                service.answer(reader, request, response);
+                if (!writeFrame(fd, response)) {
+                    break;
+                }
+            }
+        } catch (const std::exception& e) {
+            writeFrame(fd, std::string("ERROR ") + e.what() + "\n");
+        }
+        service.unregisterReader(reader);
+    } catch (const std::exception& e) { // No reader slot left
+        writeFrame(fd, std::string("ERROR ") + e.what() + "\n");
+    }
+}
+
+int runDaemon(const DaemonOptions& options) {
+    HighlightService service(options.maxClients);
+    LoadOptions loadOptions;
+    loadOptions.lenient = options.lenient;
+    service.setLoadOptions(loadOptions);
+    if (!options.rulesFile.empty()) {
+        service.setHighlightRules(HighlightRuleSet::fromFile(options.rulesFile));
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (const auto& [name, feeds] : collectMatches(options.inputs)) {
+        service.loadMatch(name, feeds);
+    }
+    for (const auto& log : options.followed) {
+        service.followMatch(matchNameOf(log), log);
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Replace a stale socket left by a daemon that did not exit cleanly, but nothing else
+    const sockaddr_un address = socketAddress(options.socketPath);
+    struct stat existing{};
+    if (::lstat(options.socketPath.c_str(), &existing) == 0) {
+        if (!S_ISSOCK(existing.st_mode)) {
+            throw std::runtime_error("Not a socket, refusing to replace it: " + options.socketPath);
+        }
+        // Only a socket nobody listens on refuses the connection
+        const int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        const bool connected =
+            probe >= 0 && ::connect(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+        const int probeError = errno;
+        if (probe >= 0) {
+            ::close(probe);
+        }
+        if (connected) {
+            throw std::runtime_error("A daemon is already running on " + options.socketPath);
+        }
+        if (probeError != ECONNREFUSED) {
+            throw std::runtime_error("Could not check whether a daemon is running on " + options.socketPath + ": " +
+                                     std::strerror(probeError));
+        }
+        ::unlink(options.socketPath.c_str());
+    }
+    const int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || ::bind(listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listener, SOMAXCONN) != 0) {
+        throw std::runtime_error("Could not listen on " + options.socketPath + ": " + std::strerror(errno));
+    }
+
+    std::signal(SIGINT, requestStop);
+    std::signal(SIGTERM, requestStop);
+    if (!options.followed.empty()) {
+        service.startPolling(std::chrono::milliseconds(options.pollMilliseconds));
+    }
+    std::cout << "Serving " << service.matchCount() << " match(es), loaded in " << seconds << " s, on "
+              << options.socketPath << std::endl;
+
+    ConnectionSet connections;
+    while (!stopRequested) {
+        pollfd waiting{listener, POLLIN, 0};
+        if (::poll(&waiting, 1, 200) <= 0) {
+            continue; // Timeout (check for a stop request) or a signal
+        }
+        const int fd = ::accept(listener, nullptr, nullptr);
+        if (fd < 0) {
+            continue;
+        }
+        connections.start(fd, [&service](int connection) { serveConnection(service, connection); });
+    }
+
+    ::close(listener);
+    ::unlink(options.socketPath.c_str());
+    service.stopPolling();
+    connections.closeAll();
+    std::cout << "Stopped." << std::endl;
+    return EXIT_SUCCESS;
+}
+
+// --- Clients ---
+
+int runQuery(const DaemonOptions& options) {
+    const int fd = connectTo(options.socketPath);
+    std::string response;
+    exchange(fd, options.query, response);
+    ::close(fd);
+    std::cout << response;
+    return response.compare(0, 3, "OK ") == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+// Appends one event line to a log every millisecond until stopped
+void appendEvents(const std::string& log, const std::atomic<bool>& stop, std::uint64_t& appended) {
+    std::ofstream out(log, std::ios::app);
+    if (!out.is_open()) {
+        throw std::runtime_error("Could not open " + log);
+    }
+    while (!stop.load()) {
+        out << "90,OTHER,bench append " << appended++ << '\n';
+        out.flush();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+double percentile(const std::vector<double>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    const auto index = static_cast<std::size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+    return sorted[std::min(index, sorted.size() - 1)];
+}
+
+int runBenchmark(const DaemonOptions& options) {
+    std::vector<std::string> queries = options.benchQueries;
+    if (queries.empty()) {
+        const int fd = connectTo(options.socketPath);
+        std::string response;
+        exchange(fd, "MATCHES", response);
+        ::close(fd);
+        std::size_t line = response.find('\n');
+        while (line != std::string::npos && line + 1 < response.size()) {
+            const std::size_t end = response.find('\n', line + 1);
+            const std::string name = response.substr(line + 1, response.find(' ', line + 1) - line - 1);
+            queries.push_back("HIGHLIGHTS " + name);
+            queries.push_back("RANGE " + name + " 40 50");
+            line = end;
+        }
+        if (queries.empty()) {
+            throw std::runtime_error("The daemon serves no matches");
+        }
+    }
+
+    std::vector<std::vector<double>> latencies(options.benchClients); // Microseconds, per client
+    std::vector<std::uint64_t> responseBytes(options.benchClients, 0);
+    std::atomic<std::size_t> failures{0};
+    std::atomic<bool> appendStop{false};
+    std::uint64_t appended = 0;
+    std::thread appender;
+    if (!options.benchAppendLog.empty()) {
+        appender = std::thread(appendEvents, options.benchAppendLog, std::cref(appendStop), std::ref(appended));
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    {
+        std::vector<std::thread> clients;
+        for (unsigned client = 0; client < options.benchClients; ++client) {
+            clients.emplace_back([&, client] {
+                try {
+                    const int fd = connectTo(options.socketPath);
+                    std::string response;
+                    latencies[client].reserve(options.benchRequests);
+                    for (unsigned i = 0; i < options.benchRequests; ++i) {
+                        const std::string& query = queries[(client + i) % queries.size()];
+                        const auto sent = std::chrono::steady_clock::now();
+                        exchange(fd, query, response);
+                        latencies[client].push_back(
+                            std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - sent).count());
+                        responseBytes[client] += response.size();
+                        if (response.compare(0, 3, "OK ") != 0) {
+                            ++failures;
+                        }
+                    }
+                    ::close(fd);
+                } catch (const std::exception& e) {
+                    ++failures;
+                    std::cerr << "Client " << client << ": " << e.what() << std::endl;
+                }
+            });
+        }
+        for (auto& client : clients) {
+            client.join();
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (appender.joinable()) {
+        appendStop = true;
+        appender.join();
+    }
+
+    std::vector<double> all;
+    std::uint64_t bytes = 0;
+    for (unsigned client = 0; client < options.benchClients; ++client) {
+        all.insert(all.end(), latencies[client].begin(), latencies[client].end());
+        bytes += responseBytes[client];
+    }
+    std::sort(all.begin(), all.end());
+    std::cout << "{\"benchmark\":\"daemonQueries\""
+              << ",\"clients\":" << options.benchClients
+              << ",\"requests\":" << all.size()
+              << ",\"failures\":" << failures.load()
+              << ",\"appended_events\":" << appended
+              << ",\"seconds\":" << seconds
+              << ",\"requests_per_second\":" << (seconds > 0 ? static_cast<double>(all.size()) / seconds : 0.0)
+              << ",\"response_bytes\":" << bytes
+              << ",\"p50_us\":" << percentile(all, 0.50)
+              << ",\"p99_us\":" << percentile(all, 0.99)
+              << ",\"p999_us\":" << percentile(all, 0.999)
+              << ",\"max_us\":" << (all.empty() ? 0.0 : all.back()) << "}" << std::endl;
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    DaemonOptions options;
+    std::signal(SIGPIPE, SIG_IGN); // A peer that went away is seen as a failed write
+    try {
+        if (!parseArguments(argc, argv, options)) {
+            return EXIT_SUCCESS;
+        }
+        if (!options.query.empty()) {
+            return runQuery(options);
+        }
+        if (options.benchClients > 0) {
+            return runBenchmark(options);
+        }
+        return runDaemon(options);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
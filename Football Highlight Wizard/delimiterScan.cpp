@@ -0,0 +1,274 @@
+#include "delimiterScan.h"
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define HIGHLIGHT_WIZARD_SCAN_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang compile a function for AVX2 only when asked to; MSVC always can
+#if defined(HIGHLIGHT_WIZARD_SCAN_X86) && (defined(__GNUC__) || defined(__clang__))
+#define HIGHLIGHT_WIZARD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define HIGHLIGHT_WIZARD_TARGET_AVX2
+#endif
+
+namespace {
+
+constexpr std::size_t npos = std::string_view::npos;
+
+int countTrailingZeros(std::uint32_t bits) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, bits);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(bits);
+#endif
+}
+
+// Turns the newlines and commas the kernels find, in text order, into lines
+class LineCollector {
+public:
+    LineCollector(std::vector<LineDelimiters>& lines, std::size_t from, std::size_t maxLines)
+        : lines(lines), maxLines(maxLines), current{from, 0, npos, npos} {}
+
+    // False once maxLines lines are collected
+    bool newline(std::size_t position) {
+        current.end = position;
+        lines.push_back(current);
+        current = LineDelimiters{position + 1, 0, npos, npos};
+        return lines.size() < maxLines;
+    }
+    void comma(std::size_t position) {
+        if (current.firstComma == npos) {
+            current.firstComma = position;
+        } else if (current.secondComma == npos) {
+            current.secondComma = position;
+        }
+    }
+    // The delimiters of one block of a vector kernel: bit i of each mask stands for
+    // the byte at base + i. False once maxLines lines are collected
+    bool block(std::uint32_t newlines, std::uint32_t commas, std::size_t base) {
+        for (std::uint32_t delimiters = newlines | commas; delimiters != 0; delimiters &= delimiters - 1) {
+            const int bit = countTrailingZeros(delimiters);
+            if (newlines & (std::uint32_t{1} << bit)) {
+                if (!newline(base + bit)) {
+                    return false;
+                }
+            } else {
+                comma(base + bit);
+            }
+        }
+        return true;
+    }
+    // The last line, if the text does not end with a newline
+    void finish(std::size_t size) {
+        if (current.begin < size) {
+            current.end = size;
+            lines.push_back(current);
+            current = LineDelimiters{size, 0, npos, npos};
+        }
+    }
+    // Where the line after the collected ones starts
+    std::size_t resume() const { return current.begin; }
+
+private:
+    std::vector<LineDelimiters>& lines;
+    const std::size_t maxLines;
+    LineDelimiters current;
+};
+
+// Each kernel scans from position on and leaves position where it stopped (the
+// scalar kernel finishes what a vector kernel leaves over); false once the collector is full
+bool scanScalar(const char* data, std::size_t& position, std::size_t size, LineCollector& lines) {
+    for (; position < size; ++position) {
+        if (data[position] == '\n') {
+            if (!lines.newline(position)) {
+                return false;
+            }
+        } else if (data[position] == ',') {
+            lines.comma(position);
+        }
+    }
+    return true;
+}
+
+std::size_t countScalar(const char* data, std::size_t size) {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+        count += data[i] == '\n';
+    }
+    return count;
+}
+
+#ifdef HIGHLIGHT_WIZARD_SCAN_X86
+
+bool scanSse2(const char* data, std::size_t& position, std::size_t size, LineCollector& lines) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i comma = _mm_set1_epi8(',');
+    for (; position + 16 <= size; position += 16) {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+        const auto newlines = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)));
+        const auto commas = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, comma)));
+        if (!lines.block(newlines, commas, position)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+HIGHLIGHT_WIZARD_TARGET_AVX2
+bool scanAvx2(const char* data, std::size_t& position, std::size_t size, LineCollector& lines) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i comma = _mm256_set1_epi8(',');
+    for (; position + 32 <= size; position += 32) {
+        const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position));
+        const auto newlines = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, newline)));
+        const auto commas = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, comma)));
+        if (!lines.block(newlines, commas, position)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Newlines are counted in byte lanes (a match is -1, subtracted) and the lanes are
+// summed before any of them can pass 255
+std::size_t countSse2(const char* data, std::size_t& position, std::size_t size) {
+    const __m128i newline = _mm_set1_epi8('\n');
+    const __m128i zero = _mm_setzero_si128();
+    std::size_t count = 0;
+    while (position + 16 <= size) {
+        __m128i lanes = zero;
+        for (int round = 0; round < 255 && position + 16 <= size; ++round, position += 16) {
+            const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + position));
+            lanes = _mm_sub_epi8(lanes, _mm_cmpeq_epi8(bytes, newline));
+        }
+        const __m128i sums = _mm_sad_epu8(lanes, zero);
+        count += static_cast<std::size_t>(_mm_cvtsi128_si64(sums)) +
+                 static_cast<std::size_t>(_mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums)));
+    }
+    return count;
+}
+
+HIGHLIGHT_WIZARD_TARGET_AVX2
+std::size_t countAvx2(const char* data, std::size_t& position, std::size_t size) {
+    const __m256i newline = _mm256_set1_epi8('\n');
+    const __m256i zero = _mm256_setzero_si256();
+    std::size_t count = 0;
+    while (position + 32 <= size) {
+        __m256i lanes = zero;
+        for (int round = 0; round < 255 && position + 32 <= size; ++round, position += 32) {
+            const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + position));
+            lanes = _mm256_sub_epi8(lanes, _mm256_cmpeq_epi8(bytes, newline));
+        }
+        const __m256i sums = _mm256_sad_epu8(lanes, zero);
+        count += static_cast<std::size_t>(_mm256_extract_epi64(sums, 0)) +
+                 static_cast<std::size_t>(_mm256_extract_epi64(sums, 1)) +
+                 static_cast<std::size_t>(_mm256_extract_epi64(sums, 2)) +
+                 static_cast<std::size_t>(_mm256_extract_epi64(sums, 3));
+    }
+    return count;
+}
+
+bool cpuHasAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    const bool osSavesYmm = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6; // OSXSAVE, XMM and YMM state
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2"); // Also checks that the OS saves the AVX registers
+#endif
+}
+
+#endif // HIGHLIGHT_WIZARD_SCAN_X86
+
+ScanKernel detectScanKernel() {
+#ifdef HIGHLIGHT_WIZARD_SCAN_X86
+    return cpuHasAvx2() ? ScanKernel::AVX2 : ScanKernel::SSE2; // SSE2 is part of x86-64
+#else
+    return ScanKernel::SCALAR;
+#endif
+}
+
+void requireSupported(ScanKernel kernel) {
+    if (!scanKernelSupported(kernel)) {
+        throw std::invalid_argument(std::string("This CPU cannot run the ") + scanKernelName(kernel) + " scan kernel");
+    }
+}
+
+} // namespace
+
+ScanKernel bestScanKernel() {
+    static const ScanKernel best = detectScanKernel();
+    return best;
+}
+
+bool scanKernelSupported(ScanKernel kernel) {
+    return static_cast<int>(kernel) <= static_cast<int>(bestScanKernel());
+}
+
+const char* scanKernelName(ScanKernel kernel) {
+    switch (kernel) {
+        case ScanKernel::SCALAR: return "scalar";
+        case ScanKernel::SSE2: return "sse2";
+        case ScanKernel::AVX2: return "avx2";
+    }
+    return "unknown";
+}
+
+std::size_t scanLines(std::string_view text, std::size_t from, std::size_t maxLines,
+                      std::vector<LineDelimiters>& lines, ScanKernel kernel) {
+    requireSupported(kernel);
+    lines.clear();
+    if (from >= text.size()) {
+        return text.size();
+    }
+    if (maxLines == 0) {
+        return from;
+    }
+    LineCollector collector(lines, from, maxLines);
+    std::size_t position = from;
+    bool more = true;
+#ifdef HIGHLIGHT_WIZARD_SCAN_X86
+    if (kernel == ScanKernel::AVX2) {
+        more = scanAvx2(text.data(), position, text.size(), collector);
+    } else if (kernel == ScanKernel::SSE2) {
+        more = scanSse2(text.data(), position, text.size(), collector);
+    }
+#endif
+    if (more) {
+        more = scanScalar(text.data(), position, text.size(), collector);
+    }
+    if (!more) {
+        return collector.resume();
+    }
+    collector.finish(text.size());
+    return text.size();
+}
+
+std::size_t countNewlines(std::string_view text, ScanKernel kernel) {
+    requireSupported(kernel);
+    std::size_t position = 0;
+    std::size_t count = 0;
+#ifdef HIGHLIGHT_WIZARD_SCAN_X86
+    if (kernel == ScanKernel::AVX2) {
+        count = countAvx2(text.data(), position, text.size());
+    } else if (kernel == ScanKernel::SSE2) {
+        count = countSse2(text.data(), position, text.size());
+    }
+#endif
+    return count + countScalar(text.data() + position, text.size() - position);
+}
@@ -0,0 +1,42 @@
+#ifndef DELIMITERSCAN_H
+#define DELIMITERSCAN_H
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+// Vectorised search for the delimiters of an event log: the end of every line and
+// the first two commas in it, which is all parseEventLine needs to cut a line into
+// <minute>,<EVENT_TYPE>,<description>. One pass over the text compares 16 (SSE2)
+// or 32 (AVX2) bytes at a time against '\n' and ',' and only visits the bytes that
+// match, instead of a search for the newline and then two more for the commas.
+//
+// The kernel is chosen at run time from what the CPU supports; every kernel gives
+// exactly the result of the scalar one.
+
+// Offsets into the scanned text
+struct LineDelimiters {
+    std::size_t begin = 0;
+    std::size_t end = 0;                                // Of the line: its '\n', or the end of the text
+    std::size_t firstComma = std::string_view::npos;    // npos if the line has none
+    std::size_t secondComma = std::string_view::npos;   // npos if it has fewer than two
+};
+
+enum class ScanKernel { SCALAR, SSE2, AVX2 };
+
+// The fastest kernel this CPU runs (decided once)
+ScanKernel bestScanKernel();
+bool scanKernelSupported(ScanKernel kernel);
+const char* scanKernelName(ScanKernel kernel);
+
+// Scans the lines of text that start at from or later, at most maxLines of them,
+// into lines (cleared first). A last line without a trailing '\n' ends at the end
+// of the text; an empty text after from has no lines. Returns where the next scan
+// starts: after the last line scanned, text.size() once the text is done.
+std::size_t scanLines(std::string_view text, std::size_t from, std::size_t maxLines,
+                      std::vector<LineDelimiters>& lines, ScanKernel kernel = bestScanKernel());
+
+// Number of '\n' in text
+std::size_t countNewlines(std::string_view text, ScanKernel kernel = bestScanKernel());
+
+#endif // DELIMITERSCAN_H
@@ -0,0 +1,160 @@
+#include "delimiterScan.h"
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Checks every scan kernel this CPU runs against a plain reference scan, on the
+// edge cases of the log format, from every start offset and in windows of several
+// sizes. Run by ctest; prints each mismatch and exits non-zero if there is one.
+
+namespace {
+
+constexpr std::size_t npos = std::string_view::npos;
+
+int failures = 0;
+
+void fail(const std::string& message) {
+    std::cerr << "FAILED: " << message << '\n';
+    ++failures;
+}
+
+// What scanLines must return, written the obvious way with find
+std::size_t referenceScan(std::string_view text, std::size_t from, std::size_t maxLines,
+                          std::vector<LineDelimiters>& lines) {
+    lines.clear();
+    std::size_t position = from;
+    while (position < text.size() && lines.size() < maxLines) {
+        const std::size_t end = std::min(text.find('\n', position), text.size());
+        const std::string_view line = text.substr(position, end - position);
+        LineDelimiters delimiters{position, end, npos, npos};
+        const std::size_t firstComma = line.find(',');
+        if (firstComma != npos) {
+            delimiters.firstComma = position + firstComma;
+            const std::size_t secondComma = line.find(',', firstComma + 1);
+            if (secondComma != npos) {
+                delimiters.secondComma = position + secondComma;
+            }
+        }
+        lines.push_back(delimiters);
+        position = end + 1;
+    }
+    return position < text.size() ? position : text.size();
+}
+
+bool sameLines(const std::vector<LineDelimiters>& a, const std::vector<LineDelimiters>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        if (a[i].begin != b[i].begin || a[i].end != b[i].end || a[i].firstComma != b[i].firstComma ||
+            a[i].secondComma != b[i].secondComma) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::size_t referenceNewlines(std::string_view text) {
+    std::size_t count = 0;
+    for (char c : text) {
+        count += c == '\n';
+    }
+    return count;
+}
+
+void checkKernel(ScanKernel kernel, const std::string& caseName, std::string_view text) {
+    const std::string where = std::string(scanKernelName(kernel)) + " kernel, " + caseName;
+    std::vector<LineDelimiters> lines;
+    std::vector<LineDelimiters> expected;
+    for (std::size_t maxLines : {std::size_t{1}, std::size_t{2}, std::size_t{3}, std::size_t{1024}}) {
+        for (std::size_t from = 0; from <= text.size(); ++from) {
+            // Window after window, as the parser scans, until the text is done
+            for (std::size_t position = from; position < text.size();) {
+                const std::size_t next = scanLines(text, position, maxLines, lines, kernel);
+                const std::size_t expectedNext = referenceScan(text, position, maxLines, expected);
+                if (next != expectedNext || !sameLines(lines, expected)) {
+                    fail(where + ": lines from offset " + std::to_string(position) + " in windows of " +
+                         std::to_string(maxLines));
+                    return;
+                }
+                position = next;
+            }
+        }
+    }
+    if (scanLines(text, text.size(), 1024, lines, kernel) != text.size() || !lines.empty()) {
+        fail(where + ": a scan from the end found lines");
+    }
+    if (!text.empty() && (scanLines(text, 0, 0, lines, kernel) != 0 || !lines.empty())) {
+        fail(where + ": a scan of zero lines moved on");
+    }
+    if (countNewlines(text, kernel) != referenceNewlines(text)) {
+        fail(where + ": newline count");
+    }
+}
+
+struct TestCase {
+    std::string name;
+    std::string text;
+};
+
+std::vector<TestCase> testCases() {
+    std::vector<TestCase> cases = {
+        {"empty text", ""},
+        {"one newline", "\n"},
+        {"CRLF lines", "1,GOAL,Neymar\r\n2,FOUL,x\r\n\r\n3,GOAL,last\r\n"},
+        {"trailing commas", "1,GOAL,\n2,GOAL,,\n3,GOAL,a,b,\n,\n,,\n,,,\n"},
+        {"empty lines", "\n\n1,GOAL,a\n\n\n2,FOUL,b\n\n"},
+        {"# comments", "# header, with, commas\n#\n1,GOAL,a\n  # not at the start\n#,\n"},
+        {"no trailing newline", "1,GOAL,a\n2,FOUL,no newline at the end"},
+        {"no delimiters", std::string(100, 'x')},
+    };
+
+    // A delimiter at every offset around the 16 and 32 byte blocks of the kernels,
+    // and lines long enough to span several blocks
+    std::string boundaries;
+    for (std::size_t length = 0; length < 70; ++length) {
+        boundaries += std::string(length, 'x') + (length % 2 == 0 ? "," : "") + "\n";
+    }
+    cases.push_back({"delimiters on block boundaries", boundaries});
+
+    std::string commas;
+    for (std::size_t length = 0; length < 70; ++length) {
+        commas += std::string(length, ',') + "\n";
+    }
+    cases.push_back({"lines of commas", commas});
+
+    std::string longLine = "90,GOAL," + std::string(300, 'y') + ',' + std::string(40, 'z');
+    cases.push_back({"long line", longLine + "\n" + longLine});
+    return cases;
+}
+
+} // namespace
+
+int main() {
+    const std::vector<TestCase> cases = testCases();
+    for (ScanKernel kernel : {ScanKernel::SCALAR, ScanKernel::SSE2, ScanKernel::AVX2}) {
+        if (!scanKernelSupported(kernel)) {
+            std::vector<LineDelimiters> lines;
+            try {
+                scanLines("1,GOAL,a\n", 0, 1, lines, kernel);
+                fail(std::string("an unsupported ") + scanKernelName(kernel) + " kernel ran");
+            } catch (const std::invalid_argument&) {
+                // Expected
+            }
+            std::cout << scanKernelName(kernel) << ": not supported by this CPU, skipped\n";
+            continue;
+        }
+        for (const TestCase& testCase : cases) {
+            checkKernel(kernel, testCase.name, testCase.text);
+        }
+        std::cout << scanKernelName(kernel) << ": " << cases.size() << " cases checked\n";
+    }
+    if (!scanKernelSupported(bestScanKernel())) {
+        fail("the best kernel is not supported");
+    }
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
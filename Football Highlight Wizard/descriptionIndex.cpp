@@ -0,0 +1,546 @@
+#include "descriptionIndex.h"
+#include <algorithm>
+#include <array>
+#include <cstring> // For std::memcpy
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+// Lower-case form of every byte that belongs to a word, 0 for separators
+constexpr std::array<char, 256> makeWordByteTable() {
+    std::array<char, 256> table{};
+    for (int c = 0; c < 256; ++c) {
+        if (c >= 'A' && c <= 'Z') {
+            table[c] = static_cast<char>(c - 'A' + 'a');
+        } else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c >= 0x80) {
+            table[c] = static_cast<char>(c);
+        }
+    }
+    return table;
+}
+
+constexpr std::array<char, 256> wordBytes = makeWordByteTable();
+
+// Calls onWord with every word of text, lower-cased into buffer
+template <typename OnWord>
+void forEachWord(std::string_view text, std::string& buffer, const OnWord& onWord) {
+    if (buffer.size() < text.size()) {
+        buffer.resize(text.size());
+    }
+    // Plain pointers: stores through a char* may alias anything, which would make
+    // the compiler reload every string member after each byte written
+    const char* in = text.data();
+    const char* const end = in + text.size();
+    char* const out = buffer.data();
+    while (in != end) {
+        while (in != end && wordBytes[static_cast<unsigned char>(*in)] == 0) {
+            ++in;
+        }
+        std::size_t length = 0;
+        char folded;
+        while (in != end && (folded = wordBytes[static_cast<unsigned char>(*in)]) != 0) {
+            out[length++] = folded;
+            ++in;
+        }
+        if (length != 0) {
+            onWord(std::string_view(out, length));
+        }
+    }
+}
+
+std::vector<std::string> wordsOf(std::string_view text) {
+    std::vector<std::string> words;
+    std::string buffer;
+    forEachWord(text, buffer, [&](std::string_view word) { words.emplace_back(word); });
+    return words;
+}
+
+// FNV-1a; terms are short, and the full comparison after the lookup settles collisions
+std::uint32_t termHash(std::string_view term) {
+    std::uint32_t hash = 2166136261u;
+    for (char c : term) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return hash;
+}
+
+// Hash of the first rowCount descriptions, 8 bytes at a time; a saved index is only
+// accepted for a store with the same fingerprint
+std::uint64_t descriptionFingerprint(const EventStore& events, std::size_t rowCount) {
+    constexpr std::uint64_t multiplier = 0x9E3779B97F4A7C15ull;
+    std::uint64_t hash = rowCount * multiplier;
+    auto mix = [&](std::uint64_t word) {
+        hash = (hash ^ word) * multiplier;
+        hash ^= hash >> 29;
+    };
+    for (std::size_t row = 0; row < rowCount; ++row) {
+        const std::string_view description = events.descriptionAt(row);
+        mix(description.size());
+        std::size_t i = 0;
+        for (; i + 8 <= description.size(); i += 8) {
+            std::uint64_t word;
+            std::memcpy(&word, description.data() + i, 8);
+            mix(word);
+        }
+        if (i < description.size()) {
+            std::uint64_t word = 0;
+            std::memcpy(&word, description.data() + i, description.size() - i);
+            mix(word);
+        }
+    }
+    return hash;
+}
+
+// Word positions of a term in a description, one bit each for the first 31 words;
+// the top bit stands for "somewhere after those" and sends the row to a full check
+constexpr std::uint32_t overflowPositionBit = 1u << 31;
+constexpr std::size_t positionBitCount = 31;
+
+constexpr std::uint32_t positionBit(std::uint32_t position) {
+    return position < positionBitCount ? (1u << position) : overflowPositionBit;
+}
+
+// First position in [first, last) not less than value, probing 1, 2, 4... ahead
+// first: cheap when consecutive lookups land close together, as in an intersection
+const std::uint32_t* gallopLowerBound(const std::uint32_t* first, const std::uint32_t* last, std::uint32_t value) {
+    std::size_t step = 1;
+    const std::uint32_t* low = first;
+    while (low + step < last && low[step] < value) {
+        low += step;
+        step *= 2;
+    }
+    return std::lower_bound(low, std::min(low + step + 1, last), value);
+}
+
+// Checks descriptions for a set of phrases. The description is folded into a
+// buffer that is reused, so checking many candidates allocates nothing.
+class PhraseMatcher {
+public:
+    explicit PhraseMatcher(const std::vector<std::vector<std::string>>& phrases) : phrases(phrases) {}
+
+    // Whether every phrase occurs in the description, each as a run of adjacent words
+    bool matches(std::string_view description) {
+        folded.resize(description.size());
+        for (std::size_t i = 0; i < description.size(); ++i) {
+            folded[i] = wordBytes[static_cast<unsigned char>(description[i])];
+        }
+        words.clear();
+        for (std::size_t i = 0; i < folded.size();) {
+            while (i < folded.size() && folded[i] == 0) {
+                ++i;
+            }
+            const std::size_t start = i;
+            while (i < folded.size() && folded[i] != 0) {
+                ++i;
+            }
+            if (i > start) {
+                words.emplace_back(folded.data() + start, i - start);
+            }
+        }
+        for (const auto& phrase : phrases) {
+            if (std::search(words.begin(), words.end(), phrase.begin(), phrase.end(),
+                            [](std::string_view word, const std::string& phraseWord) { return word == phraseWord; }) == words.end()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    const std::vector<std::vector<std::string>>& phrases;
+    std::string folded;
+    std::vector<std::string_view> words;
+};
+
+// Layout of a saved index: this header, then the arrays in member order
+struct IndexFileHeader {
+    char magic[8];
+    std::uint64_t rowCount;
+    std::uint64_t fingerprint;
+    std::uint64_t termCount;
+    std::uint64_t termArenaBytes;
+    std::uint64_t postingCount;
+};
+
+constexpr char indexFileMagic[8] = {'H', 'W', 'D', 'I', 'N', 'D', 'X', '1'};
+
+template <typename T>
+void writeArray(std::ofstream& out, const std::vector<T>& values) {
+    out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+// The counts come from a header that may be damaged: each one is checked against
+// what is left of the file before anything is allocated for it
+// Throws std::runtime_error if the file is too short for count values
+template <typename T>
+void readArray(std::ifstream& in, std::uint64_t& remainingBytes, std::vector<T>& values, std::uint64_t count,
+               const std::string& filename) {
+    if (count > remainingBytes / sizeof(T)) {
+        throw std::runtime_error("Damaged description index: " + filename);
+    }
+    remainingBytes -= count * sizeof(T);
+    values.resize(static_cast<std::size_t>(count));
+    in.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+} // namespace
+
+DescriptionQuery DescriptionQuery::parse(std::string_view text) {
+    DescriptionQuery query;
+    auto addPhrase = [&](std::string_view phraseText) {
+        std::vector<std::string> words = wordsOf(phraseText);
+        if (!words.empty()) {
+            query.phrases.push_back(std::move(words));
+        }
+    };
+    std::size_t i = 0;
+    while (i < text.size()) {
+        if (text[i] == '"') {
+            // The quoted words form one phrase
+            const std::size_t close = std::min(text.find('"', i + 1), text.size());
+            addPhrase(text.substr(i + 1, close - i - 1));
+            i = close + 1;
+        } else if (text[i] == ' ' || text[i] == '\t') {
+            ++i;
+        } else {
+            // An unquoted word is a phrase too if it splits, e.g. "free-kick"
+            const std::size_t end = std::min(text.find_first_of(" \t\"", i), text.size());
+            addPhrase(text.substr(i, end - i));
+            i = end;
+        }
+    }
+    return query;
+}
+
+void DescriptionIndex::build(const EventStore& events) {
+    clear();
+    rowCount = events.size();
+    fingerprint = descriptionFingerprint(events, rowCount);
+    termOffsets.push_back(0);
+    termSlots.assign(1024, 0);
+
+    // Pass 1: the distinct terms of every row with their word positions (a forward
+    // index), numbering new terms as they are met and counting the rows of each
+    std::vector<std::uint32_t> rowTerms;
+    std::vector<std::uint32_t> rowTermPositions;
+    std::vector<std::uint64_t> rowTermEnds(rowCount);
+    std::vector<std::uint64_t> lastEntryOfTerm; // Index + 1 in rowTerms of the term's latest entry
+    std::vector<std::uint64_t> termRowCounts;
+    std::string buffer;
+    for (std::size_t row = 0; row < rowCount; ++row) {
+        const std::size_t rowStart = rowTerms.size();
+        std::uint32_t position = 0;
+        forEachWord(events.descriptionAt(row), buffer, [&](std::string_view word) {
+            std::uint32_t term = findTerm(word);
+            if (term == termCount()) {
+                termArena.append(word);
+                termOffsets.push_back(static_cast<std::uint32_t>(termArena.size()));
+                lastEntryOfTerm.push_back(0);
+                termRowCounts.push_back(0);
+                if (termCount() * 2 > termSlots.size()) {
+                    rebuildTermSlots(); // Grows the table
+                } else {
+                    std::size_t slot = termHash(word) & (termSlots.size() - 1);
+                    while (termSlots[slot] != 0) {
+                        slot = (slot + 1) & (termSlots.size() - 1);
+                    }
+                    termSlots[slot] = term + 1;
+                }
+            }
+            if (lastEntryOfTerm[term] > rowStart) {
+                rowTermPositions[lastEntryOfTerm[term] - 1] |= positionBit(position); // Again in this row
+            } else {
+                lastEntryOfTerm[term] = rowTerms.size() + 1;
+                rowTerms.push_back(term);
+                rowTermPositions.push_back(positionBit(position));
+                termRowCounts[term] += 1;
+            }
+            ++position;
+        });
+        rowTermEnds[row] = rowTerms.size();
+    }
+
+    // Pass 2: transpose into the posting lists. Rows are visited in order, so every
+    // list comes out sorted.
+    postingOffsets.assign(termCount() + 1, 0);
+    for (std::size_t term = 0; term < termCount(); ++term) {
+        postingOffsets[term + 1] = postingOffsets[term] + termRowCounts[term];
+    }
+    postingRows.resize(rowTerms.size());
+    postingPositions.resize(rowTerms.size());
+    std::vector<std::uint64_t> cursors(postingOffsets.begin(), postingOffsets.end() - 1);
+    std::size_t entry = 0;
+    for (std::size_t row = 0; row < rowCount; ++row) {
+        for (; entry < rowTermEnds[row]; ++entry) {
+            const std::uint64_t posting = cursors[rowTerms[entry]]++;
+            postingRows[posting] = static_cast<std::uint32_t>(row);
+            postingPositions[posting] = rowTermPositions[entry];
+        }
+    }
+}
+
+void DescriptionIndex::extend(const EventStore& events) {
+    constexpr std::size_t minUnindexedRows = 4096; // Scanning this many per query costs next to nothing
+    if (events.size() < rowCount) {
+        build(events); // The store was reset under us
+        return;
+    }
+    const std::size_t unindexedRows = events.size() - rowCount;
+    if (unindexedRows > std::max(minUnindexedRows, rowCount / 4)) {
+        build(events); // Rebuilding once the tail grows by a quarter keeps the total cost linear
+    }
+}
+
+void DescriptionIndex::clear() {
+    rowCount = 0;
+    fingerprint = 0;
+    termArena.clear();
+    termOffsets.clear();
+    postingOffsets.clear();
+    postingRows.clear();
+    postingPositions.clear();
+    termSlots.clear();
+}
+
+std::size_t DescriptionIndex::memoryUsage() const {
+    return termArena.capacity() + termOffsets.capacity() * sizeof(std::uint32_t) +
+           postingOffsets.capacity() * sizeof(std::uint64_t) + (postingRows.capacity() + postingPositions.capacity()) * sizeof(std::uint32_t) +
+           termSlots.capacity() * sizeof(std::uint32_t);
+}
+
+std::uint32_t DescriptionIndex::findTerm(std::string_view term) const {
+    const std::uint32_t notFound = static_cast<std::uint32_t>(termCount());
+    if (termSlots.empty()) {
+        return notFound;
+    }
+    const std::size_t mask = termSlots.size() - 1;
+    for (std::size_t slot = termHash(term) & mask; termSlots[slot] != 0; slot = (slot + 1) & mask) {
+        const std::uint32_t candidate = termSlots[slot] - 1;
+        if (termAt(candidate) == term) {
+            return candidate;
+        }
+    }
+    return notFound;
+}
+
+void DescriptionIndex::rebuildTermSlots() {
+    std::size_t capacity = termSlots.empty() ? 1024 : termSlots.size();
+    while (termCount() * 2 > capacity) {
+        capacity *= 2;
+    }
+    termSlots.assign(capacity, 0);
+    for (std::uint32_t term = 0; term < termCount(); ++term) {
+        std::size_t slot = termHash(termAt(term)) & (capacity - 1);
+        while (termSlots[slot] != 0) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        termSlots[slot] = term + 1;
+    }
+}
+
+std::vector<std::uint32_t> DescriptionIndex::search(const EventStore& events, const DescriptionQuery& query) const {
+    std::array<bool, eventTypeCount> typeWanted{};
+    typeWanted.fill(query.types.empty());
+    for (EventType type : query.types) {
+        typeWanted[static_cast<std::size_t>(type)] = true;
+    }
+    auto passesFilters = [&](std::uint32_t row) {
+        const int minute = events.timestampAt(row);
+        return typeWanted[static_cast<std::size_t>(events.typeAt(row))] &&
+               minute >= query.firstMinute && minute <= query.lastMinute;
+    };
+
+    // Normalize the phrases the way descriptions are split into words
+    std::vector<std::vector<std::string>> phrases;
+    bool multiWordPhrases = false;
+    for (const auto& phrase : query.phrases) {
+        std::vector<std::string> words;
+        for (const std::string& word : phrase) {
+            std::vector<std::string> parts = wordsOf(word);
+            words.insert(words.end(), parts.begin(), parts.end());
+        }
+        if (!words.empty()) {
+            multiWordPhrases = multiWordPhrases || words.size() > 1;
+            phrases.push_back(std::move(words));
+        }
+    }
+    PhraseMatcher phraseMatcher(phrases);
+    auto matchesPhrases = [&](std::uint32_t row) {
+        return phraseMatcher.matches(events.descriptionAt(row));
+    };
+
+    std::vector<std::uint32_t> matches;
+    const std::uint32_t indexed = static_cast<std::uint32_t>(std::min(rowCount, events.size()));
+    if (phrases.empty()) {
+        // Only filters: every indexed row is a candidate
+        for (std::uint32_t row = 0; row < indexed; ++row) {
+            if (passesFilters(row)) {
+                matches.push_back(row);
+            }
+        }
+    } else {
+        // One posting list per distinct word; every phrase word refers to its list
+        struct WordList {
+            const std::uint32_t* begin;
+            const std::uint32_t* end;
+            const std::uint32_t* position; // Where the intersection got to
+            std::uint32_t term;
+        };
+        std::vector<WordList> lists;
+        std::vector<std::vector<std::size_t>> phraseLists;
+        bool everyWordIndexed = true;
+        for (const auto& phrase : phrases) {
+            std::vector<std::size_t> wordLists;
+            for (const std::string& word : phrase) {
+                const std::uint32_t term = findTerm(word);
+                if (term == termCount()) {
+                    everyWordIndexed = false; // No indexed row can match
+                    break;
+                }
+                std::size_t list = 0;
+                while (list < lists.size() && lists[list].term != term) {
+                    ++list;
+                }
+                if (list == lists.size()) {
+                    const std::uint32_t* first = postingRows.data() + postingOffsets[term];
+                    lists.push_back(WordList{first, postingRows.data() + postingOffsets[term + 1], first, term});
+                }
+                wordLists.push_back(list);
+            }
+            phraseLists.push_back(std::move(wordLists));
+        }
+
+        // Phrases are checked on the position bits of the postings; only a phrase that
+        // may run past the 31st word makes the row's description be read
+        auto matchesPhrasePositions = [&](std::uint32_t row) {
+            bool needsFullCheck = false;
+            for (const auto& wordLists : phraseLists) {
+                if (wordLists.size() > positionBitCount) {
+                    needsFullCheck = true; // Longer than the position bits can place
+                    continue;
+                }
+                std::uint32_t starts = ~overflowPositionBit;
+                bool overflow = false;
+                for (std::size_t i = 0; i < wordLists.size(); ++i) {
+                    const std::uint32_t positions = postingPositions[lists[wordLists[i]].position - postingRows.data()];
+                    overflow = overflow || (positions & overflowPositionBit) != 0;
+                    starts &= (positions & ~overflowPositionBit) >> i;
+                }
+                if (starts == 0) {
+                    if (!overflow) {
+                        return false;
+                    }
+                    needsFullCheck = true;
+                }
+            }
+            return !needsFullCheck || matchesPhrases(row);
+        };
+
+        if (everyWordIndexed) {
+            // Intersect: walk the rarest list and look each row up in the others
+            std::size_t rarest = 0;
+            for (std::size_t i = 1; i < lists.size(); ++i) {
+                if (lists[i].end - lists[i].begin < lists[rarest].end - lists[rarest].begin) {
+                    rarest = i;
+                }
+            }
+            for (const std::uint32_t* candidate = lists[rarest].begin; candidate != lists[rarest].end; ++candidate) {
+                lists[rarest].position = candidate;
+                bool inAll = true;
+                for (std::size_t i = 0; i < lists.size() && inAll; ++i) {
+                    if (i != rarest) {
+                        lists[i].position = gallopLowerBound(lists[i].position, lists[i].end, *candidate);
+                        inAll = lists[i].position != lists[i].end && *lists[i].position == *candidate;
+                    }
+                }
+                if (inAll && passesFilters(*candidate) && (!multiWordPhrases || matchesPhrasePositions(*candidate))) {
+                    matches.push_back(*candidate);
+                }
+            }
+        }
+    }
+
+    // Rows appended since the last build
+    for (std::uint32_t row = indexed; row < events.size(); ++row) {
+        if (passesFilters(row) && (phrases.empty() || matchesPhrases(row))) {
+            matches.push_back(row);
+        }
+    }
+    return matches;
+}
+
+void DescriptionIndex::save(const std::string& filename) const {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("Could not write description index: " + filename);
+    }
+    IndexFileHeader header{};
+    std::memcpy(header.magic, indexFileMagic, sizeof(header.magic));
+    header.rowCount = rowCount;
+    header.fingerprint = fingerprint;
+    header.termCount = termCount();
+    header.termArenaBytes = termArena.size();
+    header.postingCount = postingRows.size();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeArray(out, termOffsets);
+    out.write(termArena.data(), static_cast<std::streamsize>(termArena.size()));
+    writeArray(out, postingOffsets);
+    writeArray(out, postingRows);
+    writeArray(out, postingPositions);
+    if (!out) {
+        throw std::runtime_error("Could not write description index: " + filename);
+    }
+}
+
+void DescriptionIndex::load(const std::string& filename, const EventStore& events) {
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if (!in.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    const std::streamoff fileSize = in.tellg();
+    in.seekg(0);
+    if (fileSize < static_cast<std::streamoff>(sizeof(IndexFileHeader))) {
+        throw std::runtime_error("Not a description index: " + filename);
+    }
+    std::uint64_t remainingBytes = static_cast<std::uint64_t>(fileSize) - sizeof(IndexFileHeader);
+    IndexFileHeader header{};
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!in || std::memcmp(header.magic, indexFileMagic, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("Not a description index: " + filename);
+    }
+    if (header.rowCount > events.size() || header.fingerprint != descriptionFingerprint(events, header.rowCount)) {
+        throw std::runtime_error("Description index " + filename + " was built from other events");
+    }
+
+    DescriptionIndex loaded;
+    loaded.rowCount = static_cast<std::size_t>(header.rowCount);
+    loaded.fingerprint = header.fingerprint;
+    if (header.termCount >= remainingBytes) { // Also keeps termCount + 1 from wrapping around
+        throw std::runtime_error("Damaged description index: " + filename);
+    }
+    readArray(in, remainingBytes, loaded.termOffsets, header.termCount + 1, filename);
+    if (header.termArenaBytes > remainingBytes) {
+        throw std::runtime_error("Damaged description index: " + filename);
+    }
+    remainingBytes -= header.termArenaBytes;
+    loaded.termArena.resize(static_cast<std::size_t>(header.termArenaBytes));
+    in.read(loaded.termArena.data(), static_cast<std::streamsize>(loaded.termArena.size()));
+    readArray(in, remainingBytes, loaded.postingOffsets, header.termCount + 1, filename);
+    readArray(in, remainingBytes, loaded.postingRows, header.postingCount, filename);
+    readArray(in, remainingBytes, loaded.postingPositions, header.postingCount, filename);
+
+    // A truncated or damaged file must not make queries read out of bounds
+    const bool consistent = in && loaded.termOffsets.front() == 0 && loaded.postingOffsets.front() == 0 &&
+                            loaded.termOffsets.back() == header.termArenaBytes &&
+                            loaded.postingOffsets.back() == header.postingCount &&
+                            std::is_sorted(loaded.termOffsets.begin(), loaded.termOffsets.end()) &&
+                            std::is_sorted(loaded.postingOffsets.begin(), loaded.postingOffsets.end()) &&
+                            std::all_of(loaded.postingRows.begin(), loaded.postingRows.end(),
+                                        [&](std::uint32_t row) { return row < header.rowCount; });
+    if (!consistent) {
+        throw std::runtime_error("Damaged description index: " + filename);
+    }
+    loaded.rebuildTermSlots();
+    *this = std::move(loaded);
+}
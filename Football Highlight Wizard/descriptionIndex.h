@@ -0,0 +1,82 @@
+#ifndef DESCRIPTIONINDEX_H
+#define DESCRIPTIONINDEX_H
+
+#include "eventStore.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A description search: every word must occur in the description (AND), and the
+// words of a quoted phrase must occur next to each other in that order.
+// Words are compared case-insensitively (ASCII); a word is a run of ASCII letters
+// and digits, or of any non-ASCII bytes, so "João" and "Vinícius" stay whole words.
+struct DescriptionQuery {
+    std::vector<std::vector<std::string>> phrases; // A single word is a one-word phrase
+    std::vector<EventType> types;                  // Only these types; empty: any type
+    int firstMinute = std::numeric_limits<int>::min();
+    int lastMinute = std::numeric_limits<int>::max();
+
+    // Parses free text such as: neymar "free kick" -> {neymar} AND {free kick}
+    // An unterminated quote runs to the end of the text
+    static DescriptionQuery parse(std::string_view text);
+};
+
+// Inverted index over the descriptions of an EventStore: for every word, the rows
+// whose description contains it, in row order, each with a bit mask of where the
+// word stands in it. Terms and rows are kept in CSR form (one offsets array, one
+// rows array), so a query costs an intersection of sorted row lists, starting from
+// the rarest word, instead of a scan of every description; phrases are then
+// checked on the masks.
+//
+// Rows appended to the store after the last build are not indexed until the
+// next one; queries scan those few rows directly, so results are always complete.
+class DescriptionIndex {
+public:
+    // Indexes every row of the store, replacing the previous index
+    void build(const EventStore& events);
+
+    // Rebuilds once the rows appended since the last build are too many to scan on
+    // every query (more than a quarter of the indexed ones); does nothing otherwise
+    void extend(const EventStore& events);
+
+    void clear();
+
+    // Rows covered by the index (the rows after them are scanned by queries)
+    std::size_t indexedRows() const { return rowCount; }
+    std::size_t termCount() const { return termOffsets.empty() ? 0 : termOffsets.size() - 1; }
+    // Bytes reserved by the index
+    std::size_t memoryUsage() const;
+
+    // Rows (in row order) of the events of the store that match the query. The store
+    // must be the one the index was built on, possibly with rows appended since.
+    std::vector<std::uint32_t> search(const EventStore& events, const DescriptionQuery& query) const;
+
+    // Persistence. The file records a fingerprint of the descriptions it was built
+    // from, and load refuses it (throws std::runtime_error) for any other store, so a
+    // saved index can be kept next to its log and trusted after a reload.
+    // Throws std::runtime_error if the file cannot be written or read
+    void save(const std::string& filename) const;
+    void load(const std::string& filename, const EventStore& events);
+
+private:
+    std::size_t rowCount = 0;
+    std::uint64_t fingerprint = 0;              // Of the indexed descriptions, see save/load
+    std::string termArena;                      // Every term, lower case, back to back
+    std::vector<std::uint32_t> termOffsets;     // Term t is termArena[termOffsets[t], termOffsets[t + 1])
+    std::vector<std::uint64_t> postingOffsets;  // Rows of term t are rows[postingOffsets[t], postingOffsets[t + 1])
+    std::vector<std::uint32_t> postingRows;
+    std::vector<std::uint32_t> postingPositions; // Per posting: bit i set if word i of the row is the term
+    std::vector<std::uint32_t> termSlots;       // Open-addressing table of term ids + 1 (0: empty slot)
+
+    std::string_view termAt(std::uint32_t term) const {
+        return std::string_view(termArena).substr(termOffsets[term], termOffsets[term + 1] - termOffsets[term]);
+    }
+    // Id of the (lower case) term, or termCount() if it is not indexed
+    std::uint32_t findTerm(std::string_view term) const;
+    void rebuildTermSlots();
+};
+
+#endif // DESCRIPTIONINDEX_H
@@ -0,0 +1,262 @@
+#include "eventCache.h"
+#include "mappedFile.h"
+#include <algorithm>
+#include <atomic>
+#include <cstddef> // For offsetof
+#include <cstring> // For std::memcpy
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h> // For _getpid
+#else
+#include <unistd.h>  // For getpid
+#endif
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr char cacheFileMagic[8] = {'H', 'W', 'C', 'A', 'C', 'H', 'E', '1'};
+constexpr std::uint32_t byteOrderMark = 0x01020304; // Reads back differently on a machine of the other byte order
+
+// Layout of a cache file: this header, then the sections at the recorded offsets
+struct CacheFileHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byteOrder;
+    std::uint64_t sourceSize;
+    std::int64_t sourceModified;
+    std::uint64_t sourceHash;
+    std::uint64_t eventCount;
+    std::uint64_t descriptionBytes;
+    std::uint64_t descriptionOffsetsAt; // eventCount + 1 uint64 (none if eventCount is 0)
+    std::uint64_t timestampsAt;         // eventCount int32
+    std::uint64_t typesAt;              // eventCount bytes
+    std::uint64_t descriptionsAt;       // descriptionBytes bytes
+    std::uint64_t columnsChecksum;      // Of the four sections, see columnsChecksum()
+    std::uint64_t headerChecksum;       // Of every field above
+};
+
+// Sections follow the header back to back; the header size keeps the offsets
+// column 8-byte aligned in the (page-aligned) mapping, and the timestamps after it
+static_assert(sizeof(CacheFileHeader) % 8 == 0, "The columns must stay aligned");
+
+constexpr std::uint64_t prime1 = 0x9E3779B185EBCA87ull;
+constexpr std::uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+
+constexpr std::uint64_t rotateLeft(std::uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+constexpr std::uint64_t finalMix(std::uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= prime2;
+    hash ^= hash >> 29;
+    return hash;
+}
+
+// 64-bit checksum over four independent lanes, so it runs at memory speed
+// rather than at the latency of one multiply per word
+std::uint64_t checksum(const char* data, std::size_t size, std::uint64_t seed) {
+    std::uint64_t lanes[4] = {seed + prime1, seed + prime2, seed, seed - prime1};
+    std::size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        for (int lane = 0; lane < 4; ++lane) {
+            std::uint64_t word;
+            std::memcpy(&word, data + i + 8 * lane, 8);
+            lanes[lane] = rotateLeft(lanes[lane] + word * prime2, 31) * prime1;
+        }
+    }
+    std::uint64_t hash = rotateLeft(lanes[0], 1) + rotateLeft(lanes[1], 7) + rotateLeft(lanes[2], 12) +
+                         rotateLeft(lanes[3], 18) + size;
+    for (; i < size; ++i) {
+        hash = rotateLeft(hash ^ (static_cast<unsigned char>(data[i]) * prime1), 11) * prime2;
+    }
+    return finalMix(hash);
+}
+
+// The four sections, in file order, each hashed on its own
+std::uint64_t columnsChecksum(const ColumnView<std::uint64_t>& descriptionOffsets, const ColumnView<int>& timestamps,
+                              const ColumnView<EventType>& types, std::string_view descriptions) {
+    std::uint64_t hash = checksum(reinterpret_cast<const char*>(descriptionOffsets.data()),
+                                  descriptionOffsets.size() * sizeof(std::uint64_t), 1);
+    hash = checksum(reinterpret_cast<const char*>(timestamps.data()), timestamps.size() * sizeof(int), hash);
+    hash = checksum(reinterpret_cast<const char*>(types.data()), types.size() * sizeof(EventType), hash);
+    return checksum(descriptions.data(), descriptions.size(), hash);
+}
+
+std::uint64_t headerChecksum(const CacheFileHeader& header) {
+    return checksum(reinterpret_cast<const char*>(&header), offsetof(CacheFileHeader, headerChecksum), 0);
+}
+
+// A name beside the cache that no other writer uses, in this process or another
+// (CLI jobs, the GUI), so concurrent writers never truncate each other's file;
+// whichever rename comes last wins with a complete cache
+std::string temporaryFileFor(const std::string& cacheFile) {
+    static std::atomic<std::uint64_t> writes{0};
+#ifdef _WIN32
+    const long long processId = _getpid();
+#else
+    const long long processId = getpid();
+#endif
+    return cacheFile + "." + std::to_string(processId) + "." + std::to_string(writes.fetch_add(1)) + ".tmp";
+}
+
+} // namespace
+
+EventCacheKey eventCacheKeyFor(const std::string& logFile) {
+    std::error_code error;
+    EventCacheKey key;
+    key.sourceSize = fs::file_size(logFile, error);
+    const fs::file_time_type modified = fs::last_write_time(logFile, error);
+    std::ifstream in(logFile, std::ios::binary);
+    if (error || !in.is_open()) {
+        throw std::runtime_error("Could not open file: " + logFile);
+    }
+    key.sourceModified = static_cast<std::int64_t>(modified.time_since_epoch().count());
+
+    // The head and the tail catch a log rewritten with the same size and time stamp,
+    // without reading a large log in full
+    std::vector<char> bytes(static_cast<std::size_t>(std::min<std::uint64_t>(key.sourceSize, 2 * eventCacheHashedBytes)));
+    if (key.sourceSize <= bytes.size()) {
+        in.read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    } else {
+        in.read(bytes.data(), static_cast<std::streamsize>(eventCacheHashedBytes));
+        in.seekg(static_cast<std::streamoff>(key.sourceSize - eventCacheHashedBytes));
+        in.read(bytes.data() + eventCacheHashedBytes, static_cast<std::streamsize>(eventCacheHashedBytes));
+    }
+    if (!in) {
+        throw std::runtime_error("Could not read file: " + logFile);
+    }
+    key.sourceHash = checksum(bytes.data(), bytes.size(), key.sourceSize);
+    return key;
+}
+
+std::string eventCachePathFor(const std::string& logFile, const std::string& cacheDirectory) {
+    if (cacheDirectory.empty()) {
+        return logFile + ".hwc";
+    }
+    return (fs::path(cacheDirectory) / (fs::path(logFile).filename().string() + ".hwc")).string();
+}
+
+void writeEventCache(const std::string& cacheFile, const EventCacheKey& key, const EventStore& events) {
+    const ColumnView<std::uint64_t> descriptionOffsets = events.descriptionOffsets();
+    const ColumnView<int> timestamps = events.timestamps();
+    const ColumnView<EventType> types = events.types();
+    const std::string_view descriptions = events.descriptionArena();
+
+    CacheFileHeader header{};
+    std::memcpy(header.magic, cacheFileMagic, sizeof(header.magic));
+    header.version = eventCacheVersion;
+    header.byteOrder = byteOrderMark;
+    header.sourceSize = key.sourceSize;
+    header.sourceModified = key.sourceModified;
+    header.sourceHash = key.sourceHash;
+    header.eventCount = events.size();
+    header.descriptionBytes = descriptions.size();
+    header.descriptionOffsetsAt = sizeof(CacheFileHeader);
+    header.timestampsAt = header.descriptionOffsetsAt + descriptionOffsets.size() * sizeof(std::uint64_t);
+    header.typesAt = header.timestampsAt + timestamps.size() * sizeof(int);
+    header.descriptionsAt = header.typesAt + types.size() * sizeof(EventType);
+    header.columnsChecksum = columnsChecksum(descriptionOffsets, timestamps, types, descriptions);
+    header.headerChecksum = headerChecksum(header);
+
+    const std::string temporaryFile = temporaryFileFor(cacheFile);
+    {
+        std::ofstream out(temporaryFile, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) {
+            throw std::runtime_error("Could not write cache: " + temporaryFile);
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(descriptionOffsets.data()),
+                  static_cast<std::streamsize>(descriptionOffsets.size() * sizeof(std::uint64_t)));
+        out.write(reinterpret_cast<const char*>(timestamps.data()), static_cast<std::streamsize>(timestamps.size() * sizeof(int)));
+        out.write(reinterpret_cast<const char*>(types.data()), static_cast<std::streamsize>(types.size() * sizeof(EventType)));
+        out.write(descriptions.data(), static_cast<std::streamsize>(descriptions.size()));
+        if (!out.flush()) {
+            out.close();
+            std::error_code error;
+            fs::remove(temporaryFile, error);
+            throw std::runtime_error("Could not write cache: " + temporaryFile);
+        }
+    }
+    std::error_code error;
+    fs::rename(temporaryFile, cacheFile, error);
+    if (error) {
+        fs::remove(temporaryFile, error);
+        throw std::runtime_error("Could not write cache: " + cacheFile);
+    }
+}
+
+std::optional<EventStore> readEventCache(const std::string& cacheFile, const EventCacheKey& key) {
+    std::error_code error;
+    if (!fs::is_regular_file(cacheFile, error)) {
+        return std::nullopt;
+    }
+    std::shared_ptr<const MappedFile> file;
+    try {
+        file = std::make_shared<const MappedFile>(cacheFile);
+    } catch (const std::runtime_error&) {
+        return std::nullopt;
+    }
+
+    // The header: format, then the log it belongs to, then the section bounds
+    CacheFileHeader header;
+    if (file->size() < sizeof(header)) {
+        return std::nullopt;
+    }
+    std::memcpy(&header, file->data(), sizeof(header));
+    if (std::memcmp(header.magic, cacheFileMagic, sizeof(header.magic)) != 0 || header.version != eventCacheVersion ||
+        header.byteOrder != byteOrderMark || header.headerChecksum != headerChecksum(header)) {
+        return std::nullopt;
+    }
+    if (EventCacheKey{header.sourceSize, header.sourceModified, header.sourceHash} != key) {
+        return std::nullopt; // The log changed since the cache was written
+    }
+    // Every section must lie inside the file before any of it is viewed or hashed.
+    // Each event takes at least bytesPerEvent, which bounds the count so the offsets
+    // below cannot overflow; the descriptions then end exactly at the end of the file
+    const std::uint64_t fileSize = file->size();
+    const std::uint64_t eventCount = header.eventCount;
+    const std::uint64_t offsetCount = eventCount == 0 ? 0 : eventCount + 1;
+    constexpr std::uint64_t bytesPerEvent = sizeof(std::uint64_t) + sizeof(int) + sizeof(EventType);
+    if (eventCount > (fileSize - sizeof(CacheFileHeader)) / bytesPerEvent ||
+        header.descriptionOffsetsAt != sizeof(CacheFileHeader) ||
+        header.timestampsAt != header.descriptionOffsetsAt + offsetCount * sizeof(std::uint64_t) ||
+        header.typesAt != header.timestampsAt + eventCount * sizeof(int) ||
+        header.descriptionsAt != header.typesAt + eventCount * sizeof(EventType) || header.descriptionsAt > fileSize ||
+        header.descriptionBytes != fileSize - header.descriptionsAt) {
+        return std::nullopt;
+    }
+
+    const char* base = file->data();
+    const ColumnView<std::uint64_t> descriptionOffsets(reinterpret_cast<const std::uint64_t*>(base + header.descriptionOffsetsAt),
+                                                       static_cast<std::size_t>(offsetCount));
+    const ColumnView<int> timestamps(reinterpret_cast<const int*>(base + header.timestampsAt), static_cast<std::size_t>(eventCount));
+    const ColumnView<EventType> types(reinterpret_cast<const EventType*>(base + header.typesAt), static_cast<std::size_t>(eventCount));
+    const std::string_view descriptions(base + header.descriptionsAt, static_cast<std::size_t>(header.descriptionBytes));
+    if (columnsChecksum(descriptionOffsets, timestamps, types, descriptions) != header.columnsChecksum) {
+        return std::nullopt;
+    }
+
+    // The checksum proves the file is the one that was written; these checks keep the
+    // columns of a crafted one from pointing the store outside its descriptions
+    if (eventCount != 0 && (descriptionOffsets[0] != 0 || descriptionOffsets[eventCount] != header.descriptionBytes)) {
+        return std::nullopt;
+    }
+    bool columnsValid = true;
+    for (std::size_t i = 0; i < eventCount; ++i) {
+        columnsValid &= descriptionOffsets[i] <= descriptionOffsets[i + 1];
+        columnsValid &= static_cast<std::size_t>(types[i]) < eventTypeCount;
+    }
+    if (!columnsValid) {
+        return std::nullopt;
+    }
+
+    return EventStore::fromExternalColumns(file, static_cast<std::size_t>(eventCount), timestamps.data(), types.data(),
+                                           descriptionOffsets.data(), descriptions.data());
+}
@@ -0,0 +1,54 @@
+#ifndef EVENTCACHE_H
+#define EVENTCACHE_H
+
+#include "eventStore.h"
+#include <cstdint>
+#include <optional>
+#include <string>
+
+// Binary cache of the events parsed from a match log, so a log that is opened
+// again is mapped instead of parsed. The file is a header followed by the
+// columns of an EventStore exactly as they sit in memory (description offsets,
+// timestamps, types, then the description bytes), so a loaded cache is read in
+// place: opening it costs an mmap and one checksum pass, whatever the log size.
+//
+// The header records a format version, the byte order, a checksum of the
+// columns and the key of the log the events came from; a cache is only used
+// for the same key, format and byte order.
+
+// Bump whenever the layout of the file or of the columns changes
+inline constexpr std::uint32_t eventCacheVersion = 1;
+
+// Identifies the content of a log file without reading all of it
+struct EventCacheKey {
+    std::uint64_t sourceSize = 0;
+    std::int64_t sourceModified = 0; // Last write time, in ticks of the file clock
+    std::uint64_t sourceHash = 0;    // Of the first and last eventCacheHashedBytes of the file
+
+    bool operator==(const EventCacheKey& other) const {
+        return sourceSize == other.sourceSize && sourceModified == other.sourceModified &&
+               sourceHash == other.sourceHash;
+    }
+    bool operator!=(const EventCacheKey& other) const { return !(*this == other); }
+};
+
+inline constexpr std::size_t eventCacheHashedBytes = 64 * 1024;
+
+// The key of the log as it is on disk now
+// Throws std::runtime_error if the file cannot be opened
+EventCacheKey eventCacheKeyFor(const std::string& logFile);
+
+// "<log>.hwc", next to the log or in cacheDirectory if it is not empty
+std::string eventCachePathFor(const std::string& logFile, const std::string& cacheDirectory = {});
+
+// Writes the events to a temporary file and renames it over cacheFile, so
+// readers never see a partial cache
+// Throws std::runtime_error if the file cannot be written
+void writeEventCache(const std::string& cacheFile, const EventCacheKey& key, const EventStore& events);
+
+// A store reading the events straight from the mapped cache file; the mapping
+// lives as long as the store (or a copy of it) does. Returns nothing if the file
+// does not exist, was made for another key or format, or is damaged.
+std::optional<EventStore> readEventCache(const std::string& cacheFile, const EventCacheKey& key);
+
+#endif // EVENTCACHE_H
@@ -0,0 +1,82 @@
+#ifndef EVENTEXPORT_H
+#define EVENTEXPORT_H
+
+#include "eventStore.h"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string_view>
+#include <vector>
+
+// Machine-readable exports of events (all of a match, or its highlights) for
+// downstream tools. Every format has one record per event with the same fields:
+// its row in the match's events (so a highlight export joins with the full one),
+// minute, type and description.
+//
+//   JSON Lines  {"row":12,"minute":34,"type":"GOAL","description":"..."}
+//   CSV         row,minute,type,description (RFC 4180 quoting, a header line first)
+//   Binary      (.hwe) little endian, whatever the machine:
+//                 "HWEXPORT", uint32 version, uint8 type count, then for each
+//                 type its name as uint8 length + bytes (the codes below index them);
+//                 per event uint32 row, int32 minute, uint8 type code, uint32
+//                 description length + bytes;
+//                 a trailer of uint32 0xFFFFFFFF and the uint64 event count, so a
+//                 truncated file is told apart from a complete one
+//
+// Records are formatted straight into one preallocated buffer (numbers with
+// std::to_chars) that goes to the stream only when it is full, never per line,
+// so an export of any number of events needs the buffer and nothing more.
+
+enum class ExportFormat { JSON_LINES, CSV, BINARY };
+
+// "jsonl", "csv" or "binary"
+// Throws std::invalid_argument for any other name
+ExportFormat exportFormatFromName(std::string_view name);
+const char* exportFormatName(ExportFormat format);
+// "jsonl", "csv" or "hwe"
+const char* exportFileExtension(ExportFormat format);
+
+// Bump whenever the binary layout changes
+inline constexpr std::uint32_t eventExportVersion = 1;
+inline constexpr std::size_t eventExportBufferBytes = 1 << 20;
+
+// Writes the records of events handed to it one at a time, e.g. while they are
+// read; finish() must be called once after the last one
+class EventExporter {
+public:
+    EventExporter(std::ostream& out, ExportFormat format, std::size_t bufferBytes = eventExportBufferBytes);
+    EventExporter(const EventExporter&) = delete;
+    EventExporter& operator=(const EventExporter&) = delete;
+
+    void write(std::uint32_t row, const EventView& event);
+    // Writes the trailer, if the format has one, and whatever is still buffered;
+    // returns the bytes of the whole export
+    // Throws std::runtime_error if the stream failed at any point
+    std::uint64_t finish();
+
+    std::uint64_t eventCount() const { return events; }
+
+private:
+    std::ostream& out;
+    const ExportFormat format;
+    std::vector<char> buffer;
+    std::size_t used = 0;
+    std::uint64_t bytesWritten = 0;
+    std::uint64_t events = 0;
+
+    void put(const char* data, std::size_t size);
+    void put(std::string_view text) { put(text.data(), text.size()); }
+    void putNumber(long long value);
+    void putLittleEndian(std::uint64_t value, int bytes);
+    void putJsonString(std::string_view text);
+    void putCsvField(std::string_view text);
+    void flush();
+};
+
+// Every event of the store, or of the view (e.g. HighlightWizard::getHighlights()),
+// in order; returns the bytes written
+// Throws std::runtime_error if the stream fails
+std::uint64_t exportEvents(std::ostream& out, const EventStore& events, ExportFormat format);
+std::uint64_t exportEvents(std::ostream& out, const EventIndexView& events, ExportFormat format);
+
+#endif // EVENTEXPORT_H
@@ -0,0 +1,95 @@
+#include "eventListModel.h"
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+// Views address rows with an int
+int clampRowCount(std::size_t count) {
+    return static_cast<int>(std::min<std::size_t>(count, std::numeric_limits<int>::max()));
+}
+
+} // namespace
+
+EventListModel::EventListModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+}
+
+void EventListModel::showEvents(const EventStore& events)
+{
+    beginResetModel();
+    content = Content::AllEvents;
+    this->events = &events;
+    rows = EventIndexView();
+    message.clear();
+    endResetModel();
+}
+
+void EventListModel::showRows(const EventIndexView& rows)
+{
+    beginResetModel();
+    content = Content::Rows;
+    events = nullptr;
+    this->rows = rows;
+    message.clear();
+    endResetModel();
+}
+
+void EventListModel::showMessage(const QString& message)
+{
+    beginResetModel();
+    content = Content::Message;
+    events = nullptr;
+    rows = EventIndexView();
+    this->message = message;
+    endResetModel();
+}
+
+std::size_t EventListModel::eventCount() const
+{
+    switch (content) {
+        case Content::AllEvents:
+            return events->size();
+        case Content::Rows:
+            return rows.size();
+        case Content::Message:
+            break;
+    }
+    return 0;
+}
+
+int EventListModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid()) {
+        return 0; // A list has no children
+    }
+    if (content == Content::Message) {
+        return message.isEmpty() ? 0 : 1;
+    }
+    return clampRowCount(eventCount());
+}
+
+QVariant EventListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    if (content == Content::Message) {
+        return message;
+    }
+
+    // Built on demand: only the rows the view is painting are ever formatted
+    const EventView event = eventAt(index.row());
+    const std::string_view type = GameEvent::typeToString(event.type);
+    return QString("[%1'] %2: %3")
+        .arg(event.timestampMinutes)
+        .arg(QLatin1String(type.data(), static_cast<int>(type.size())))
+        .arg(QString::fromUtf8(event.description.data(), static_cast<int>(event.description.size())));
+}
+
+EventView EventListModel::eventAt(int row) const
+{
+    const std::size_t position = static_cast<std::size_t>(row);
+    return content == Content::AllEvents ? (*events)[position] : rows[position];
+}
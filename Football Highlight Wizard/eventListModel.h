@@ -0,0 +1,46 @@
+#ifndef EVENTLISTMODEL_H
+#define EVENTLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QString>
+#include "eventStore.h"
+
+// List model that reads straight from a HighlightWizard's EventStore.
+// No row is copied or converted up front: a row's text is only built when a
+// view asks for it, i.e. when it scrolls into sight. Use it with a QListView
+// that has uniformItemSizes set, otherwise the view measures every row.
+//
+// The model keeps pointers into the store (and the index array of a view):
+// call showEvents/showRows/showMessage before (or right after) those change.
+class EventListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit EventListModel(QObject *parent = nullptr);
+
+    // Shows every event of the store
+    void showEvents(const EventStore& events);
+    // Shows a selection of rows, e.g. the wizard's highlights
+    void showRows(const EventIndexView& rows);
+    // Shows nothing but the message (an empty message shows an empty list)
+    void showMessage(const QString& message);
+
+    // Number of events shown (0 while a message is shown)
+    std::size_t eventCount() const;
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    enum class Content { Message, AllEvents, Rows };
+
+    Content content = Content::Message;
+    const EventStore* events = nullptr; // Content::AllEvents
+    EventIndexView rows;                // Content::Rows
+    QString message;                    // Content::Message
+
+    EventView eventAt(int row) const;
+};
+
+#endif // EVENTLISTMODEL_H
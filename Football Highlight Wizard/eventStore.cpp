@@ -0,0 +1,165 @@
+#include "eventStore.h"
+#include <utility> // For std::exchange
+
+GameEvent EventView::toGameEvent() const {
+    GameEvent event;
+    event.timestampMinutes = timestampMinutes;
+    event.type = type;
+    event.description.assign(description.data(), description.size());
+    return event;
+}
+
+EventStore::EventStore(const EventStore& other)
+    : timestampColumn(other.timestampColumn)
+    , typeColumn(other.typeColumn)
+    , descriptionOffsetColumn(other.descriptionOffsetColumn)
+    , descriptionArenaColumn(other.descriptionArenaColumn)
+    , owner(other.owner)
+    , columns(other.columns) {
+    if (!owner) {
+        useOwnColumns();
+    }
+}
+
+EventStore::EventStore(EventStore&& other) noexcept
+    : timestampColumn(std::move(other.timestampColumn))
+    , typeColumn(std::move(other.typeColumn))
+    , descriptionOffsetColumn(std::move(other.descriptionOffsetColumn))
+    , descriptionArenaColumn(std::move(other.descriptionArenaColumn))
+    , owner(std::move(other.owner))
+    , columns(std::exchange(other.columns, Columns{})) {
+    if (!owner) {
+        useOwnColumns(); // A short arena lives inside the string object, so it moved
+    }
+    other.clear();
+}
+
+EventStore& EventStore::operator=(const EventStore& other) {
+    if (this != &other) {
+        *this = EventStore(other);
+    }
+    return *this;
+}
+
+EventStore& EventStore::operator=(EventStore&& other) noexcept {
+    if (this != &other) {
+        timestampColumn = std::move(other.timestampColumn);
+        typeColumn = std::move(other.typeColumn);
+        descriptionOffsetColumn = std::move(other.descriptionOffsetColumn);
+        descriptionArenaColumn = std::move(other.descriptionArenaColumn);
+        owner = std::move(other.owner);
+        columns = std::exchange(other.columns, Columns{});
+        if (!owner) {
+            useOwnColumns();
+        }
+        other.clear();
+    }
+    return *this;
+}
+
+EventStore EventStore::fromExternalColumns(std::shared_ptr<const void> owner, std::size_t eventCount,
+                                           const int* timestamps, const EventType* types,
+                                           const std::uint64_t* descriptionOffsets, const char* descriptionArena) {
+    EventStore store;
+    if (eventCount == 0) {
+        return store;
+    }
+    store.owner = std::move(owner);
+    store.columns = Columns{eventCount, timestamps, types, descriptionOffsets, descriptionArena};
+    return store;
+}
+
+void EventStore::clear() {
+    timestampColumn.clear();
+    typeColumn.clear();
+    descriptionOffsetColumn.clear();
+    descriptionArenaColumn.clear();
+    owner.reset();
+    useOwnColumns();
+}
+
+void EventStore::reserve(std::size_t eventCount, std::size_t descriptionBytes) {
+    ownColumns();
+    timestampColumn.reserve(eventCount);
+    typeColumn.reserve(eventCount);
+    descriptionOffsetColumn.reserve(eventCount + 1);
+    descriptionArenaColumn.reserve(descriptionBytes);
+    useOwnColumns();
+}
+
+void EventStore::push_back(int timestampMinutes, EventType type, std::string_view description) {
+    ownColumns();
+    timestampColumn.push_back(timestampMinutes);
+    typeColumn.push_back(type);
+    if (descriptionOffsetColumn.empty()) {
+        descriptionOffsetColumn.push_back(0);
+    }
+    descriptionArenaColumn.append(description.data(), description.size());
+    descriptionOffsetColumn.push_back(descriptionArenaColumn.size());
+    useOwnColumns();
+}
+
+void EventStore::push_back(const EventView& event) {
+    push_back(event.timestampMinutes, event.type, event.description);
+}
+
+void EventStore::push_back(const GameEvent& event) {
+    push_back(event.timestampMinutes, event.type, event.description);
+}
+
+void EventStore::append(const EventStore& other) {
+    ownColumns();
+    const ColumnView<int> otherTimestamps = other.timestamps();
+    const ColumnView<EventType> otherTypes = other.types();
+    timestampColumn.insert(timestampColumn.end(), otherTimestamps.begin(), otherTimestamps.end());
+    typeColumn.insert(typeColumn.end(), otherTypes.begin(), otherTypes.end());
+
+    // The other store's offsets are relative to its own arena
+    const std::uint64_t base = descriptionArenaColumn.size();
+    if (descriptionOffsetColumn.empty()) {
+        descriptionOffsetColumn.push_back(0);
+    }
+    const ColumnView<std::uint64_t> otherOffsets = other.descriptionOffsets();
+    descriptionOffsetColumn.reserve(descriptionOffsetColumn.size() + other.size());
+    for (std::size_t i = 1; i < otherOffsets.size(); ++i) {
+        descriptionOffsetColumn.push_back(base + otherOffsets[i]);
+    }
+    descriptionArenaColumn.append(other.descriptionArena());
+    useOwnColumns();
+}
+
+ColumnView<std::uint64_t> EventStore::descriptionOffsets() const {
+    return {columns.descriptionOffsets, columns.rowCount == 0 ? 0 : columns.rowCount + 1};
+}
+
+std::string_view EventStore::descriptionArena() const {
+    return columns.rowCount == 0 ? std::string_view()
+                                 : std::string_view(columns.descriptionArena,
+                                                    static_cast<std::size_t>(columns.descriptionOffsets[columns.rowCount]));
+}
+
+std::size_t EventStore::memoryUsage() const {
+    return timestampColumn.capacity() * sizeof(int)
+         + typeColumn.capacity() * sizeof(EventType)
+         + descriptionOffsetColumn.capacity() * sizeof(std::uint64_t)
+         + descriptionArenaColumn.capacity();
+}
+
+void EventStore::useOwnColumns() {
+    columns = Columns{timestampColumn.size(), timestampColumn.data(), typeColumn.data(),
+                      descriptionOffsetColumn.data(), descriptionArenaColumn.data()};
+}
+
+void EventStore::ownColumns() {
+    if (!owner) {
+        return;
+    }
+    const Columns external = columns;
+    timestampColumn.assign(external.timestamps, external.timestamps + external.rowCount);
+    typeColumn.assign(external.types, external.types + external.rowCount);
+    descriptionOffsetColumn.assign(external.descriptionOffsets, external.descriptionOffsets + external.rowCount + 1);
+    descriptionArenaColumn.assign(external.descriptionArena,
+                                  static_cast<std::size_t>(external.descriptionOffsets[external.rowCount]));
+    owner.reset();
+    useOwnColumns();
+}
@@ -0,0 +1,228 @@
+#ifndef EVENTSTORE_H
+#define EVENTSTORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "gameEvent.h"
+
+// Row-style view of one stored event
+// The description points into the store's arena: it stays valid until the
+// store is modified (appending can move the arena) or destroyed.
+struct EventView {
+    int timestampMinutes = -1;
+    EventType type = EventType::UNKNOWN;
+    std::string_view description;
+
+    // Copies the row into a self-contained GameEvent
+    GameEvent toGameEvent() const;
+};
+
+// Read-only view of a contiguous column (C++17 has no std::span)
+template <typename T>
+class ColumnView {
+public:
+    ColumnView() = default;
+    ColumnView(const T* data, std::size_t size) : first(data), count(size) {}
+
+    const T* data() const { return first; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T& operator[](std::size_t i) const { return first[i]; }
+    const T* begin() const { return first; }
+    const T* end() const { return first + count; }
+
+private:
+    const T* first = nullptr;
+    std::size_t count = 0;
+};
+
+// Columnar (struct-of-arrays) storage for the events of a match.
+// Timestamps and types live in their own contiguous arrays, so scans that only
+// look at the type (highlight classification) touch 1 byte per event instead of
+// a whole GameEvent. All descriptions are packed back to back into one arena;
+// event i owns arena[descriptionOffsets[i], descriptionOffsets[i + 1]), so
+// consecutive offsets double as the offset/length pair of each description.
+//
+// The columns can also live outside the store, in a mapped binary cache (see
+// eventCache.h): such a store reads them in place, and copies them into columns
+// of its own only when it is first modified.
+class EventStore {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = EventView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = EventView;
+
+        const_iterator() = default;
+        const_iterator(const EventStore* store, std::size_t index) : store(store), index(index) {}
+
+        EventView operator*() const { return (*store)[index]; }
+        EventView operator[](difference_type n) const { return (*store)[index + n]; }
+        const_iterator& operator++() { ++index; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; ++index; return old; }
+        const_iterator& operator--() { --index; return *this; }
+        const_iterator operator--(int) { const_iterator old = *this; --index; return old; }
+        const_iterator& operator+=(difference_type n) { index += n; return *this; }
+        const_iterator& operator-=(difference_type n) { index -= n; return *this; }
+        const_iterator operator+(difference_type n) const { return const_iterator(store, index + n); }
+        const_iterator operator-(difference_type n) const { return const_iterator(store, index - n); }
+        difference_type operator-(const const_iterator& other) const {
+            return static_cast<difference_type>(index) - static_cast<difference_type>(other.index);
+        }
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+        bool operator<(const const_iterator& other) const { return index < other.index; }
+
+    private:
+        const EventStore* store = nullptr;
+        std::size_t index = 0;
+    };
+
+    EventStore() = default;
+    EventStore(const EventStore& other);
+    EventStore(EventStore&& other) noexcept;
+    EventStore& operator=(const EventStore& other);
+    EventStore& operator=(EventStore&& other) noexcept;
+
+    // A store reading columns laid out like its own (descriptionOffsets has eventCount + 1
+    // entries starting at 0) from memory it does not own; owner keeps that memory alive
+    // for as long as the store, or a copy of it, reads from it
+    static EventStore fromExternalColumns(std::shared_ptr<const void> owner, std::size_t eventCount,
+                                          const int* timestamps, const EventType* types,
+                                          const std::uint64_t* descriptionOffsets, const char* descriptionArena);
+    bool hasExternalColumns() const { return owner != nullptr; }
+
+    std::size_t size() const { return columns.rowCount; }
+    bool empty() const { return columns.rowCount == 0; }
+
+    void clear();
+    void reserve(std::size_t eventCount, std::size_t descriptionBytes);
+
+    // Appends one event; the description bytes are copied into the arena
+    void push_back(int timestampMinutes, EventType type, std::string_view description);
+    void push_back(const EventView& event);
+    void push_back(const GameEvent& event);
+
+    // Appends every event of another store (used to stitch parallel parse chunks)
+    void append(const EventStore& other);
+
+    // Row access
+    EventView operator[](std::size_t index) const {
+        return EventView{columns.timestamps[index], columns.types[index], descriptionAt(index)};
+    }
+    int timestampAt(std::size_t index) const { return columns.timestamps[index]; }
+    EventType typeAt(std::size_t index) const { return columns.types[index]; }
+    std::string_view descriptionAt(std::size_t index) const {
+        const std::uint64_t begin = columns.descriptionOffsets[index];
+        return std::string_view(columns.descriptionArena + begin,
+                                static_cast<std::size_t>(columns.descriptionOffsets[index + 1] - begin));
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    // Column access for scans that only need one field
+    ColumnView<int> timestamps() const { return {columns.timestamps, columns.rowCount}; }
+    ColumnView<EventType> types() const { return {columns.types, columns.rowCount}; }
+    // size() + 1 entries starting at 0 (none while the store is empty), and the arena
+    ColumnView<std::uint64_t> descriptionOffsets() const;
+    std::string_view descriptionArena() const;
+
+    // Bytes currently reserved by the columns and the arena (external columns not included)
+    std::size_t memoryUsage() const;
+
+private:
+    // Where the accessors read: the columns below, or the external ones
+    struct Columns {
+        std::size_t rowCount = 0;
+        const int* timestamps = nullptr;
+        const EventType* types = nullptr;
+        const std::uint64_t* descriptionOffsets = nullptr;
+        const char* descriptionArena = nullptr;
+    };
+
+    std::vector<int> timestampColumn;
+    std::vector<EventType> typeColumn;
+    std::vector<std::uint64_t> descriptionOffsetColumn; // size() + 1 entries starting at 0 (empty while the store is)
+    std::string descriptionArenaColumn;
+    std::shared_ptr<const void> owner; // Of the external columns, null while the store uses its own
+    Columns columns;
+
+    // Points columns at the store's own columns, after any change to them
+    void useOwnColumns();
+    // Copies external columns into the store's own before it is modified
+    void ownColumns();
+};
+
+// Read-only view of selected events: a span of row indices into an EventStore.
+// Used for highlights (and other selections) so the rows are never copied.
+// The view does not own anything: it is invalidated when the index array it
+// points into or the store changes (reload, findHighlights, live tail appends).
+class EventIndexView {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = EventView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = EventView;
+
+        const_iterator() = default;
+        const_iterator(const EventStore* store, const std::uint32_t* position) : store(store), position(position) {}
+
+        EventView operator*() const { return (*store)[*position]; }
+        EventView operator[](difference_type n) const { return (*store)[position[n]]; }
+        const_iterator& operator++() { ++position; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; ++position; return old; }
+        const_iterator& operator--() { --position; return *this; }
+        const_iterator operator--(int) { const_iterator old = *this; --position; return old; }
+        const_iterator& operator+=(difference_type n) { position += n; return *this; }
+        const_iterator& operator-=(difference_type n) { position -= n; return *this; }
+        const_iterator operator+(difference_type n) const { return const_iterator(store, position + n); }
+        const_iterator operator-(difference_type n) const { return const_iterator(store, position - n); }
+        difference_type operator-(const const_iterator& other) const { return position - other.position; }
+        bool operator==(const const_iterator& other) const { return position == other.position; }
+        bool operator!=(const const_iterator& other) const { return position != other.position; }
+        bool operator<(const const_iterator& other) const { return position < other.position; }
+
+        // Row index in the store of the current element
+        std::uint32_t storeIndex() const { return *position; }
+
+    private:
+        const EventStore* store = nullptr;
+        const std::uint32_t* position = nullptr;
+    };
+
+    EventIndexView() = default;
+    EventIndexView(const EventStore& store, const std::uint32_t* indices, std::size_t count)
+        : store(&store), indices(indices), count(count) {}
+    EventIndexView(const EventStore& store, const std::vector<std::uint32_t>& indices)
+        : EventIndexView(store, indices.data(), indices.size()) {}
+
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    EventView operator[](std::size_t i) const { return (*store)[indices[i]]; }
+    // Row index in the store of the i-th element
+    std::uint32_t storeIndex(std::size_t i) const { return indices[i]; }
+    const std::uint32_t* storeIndices() const { return indices; }
+
+    const_iterator begin() const { return const_iterator(store, indices); }
+    const_iterator end() const { return const_iterator(store, indices + count); }
+
+private:
+    const EventStore* store = nullptr;
+    const std::uint32_t* indices = nullptr;
+    std::size_t count = 0;
+};
+
+#endif // EVENTSTORE_H
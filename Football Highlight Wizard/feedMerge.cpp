@@ -0,0 +1,270 @@
+#include "feedMerge.h"
+#include <algorithm>
+#include <cstdlib> // For std::abs
+
+namespace {
+
+// Smaller than DecompressingReader's defaults: a merge may read hundreds of feeds at once
+constexpr std::size_t feedBlockBytes = 256 * 1024;
+constexpr std::size_t feedBlockCount = 3;
+
+constexpr bool isWordByte(unsigned char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c >= 0x80;
+}
+
+constexpr char asciiLower(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+// Per byte: the byte as it appears in a key (lower case), or 0 for a separator
+struct KeyByteTable {
+    char bytes[256] = {};
+};
+
+constexpr KeyByteTable buildKeyByteTable() {
+    KeyByteTable table;
+    for (int c = 1; c < 256; ++c) {
+        if (isWordByte(static_cast<unsigned char>(c))) {
+            table.bytes[c] = asciiLower(static_cast<char>(c));
+        }
+    }
+    return table;
+}
+
+constexpr KeyByteTable keyBytes = buildKeyByteTable();
+
+} // namespace
+
+// DuplicateFilter::keyOf hashes the same bytes without building the string; keep the two in step
+void normalizeDescription(std::string_view description, std::string& key) {
+    key.clear();
+    bool inWord = false;
+    for (char c : description) {
+        const char keyByte = keyBytes.bytes[static_cast<unsigned char>(c)];
+        if (keyByte != 0) {
+            if (!inWord && !key.empty()) {
+                key.push_back(' ');
+            }
+            key.push_back(keyByte);
+            inWord = true;
+        } else {
+            inWord = false;
+        }
+    }
+}
+
+// --- FeedLineReader ---
+
+FeedLineReader::FeedLineReader(const std::string& filename)
+    : file(filename) { // Throws std::runtime_error("Could not open file: ...")
+    const LogCompression compression = detectLogCompression(file.view().substr(0, 4));
+    if (compression == LogCompression::NONE) {
+        block = file.view();
+    } else {
+        decompressor = std::make_unique<DecompressingReader>(filename, compression, feedBlockBytes, feedBlockCount);
+    }
+}
+
+bool FeedLineReader::next(std::string_view& line) {
+    if (partialLineReturned) {
+        partialLine.clear();
+        partialLineReturned = false;
+    }
+    while (!ended) {
+        const std::size_t newline = block.find('\n', position);
+        if (newline != std::string_view::npos) {
+            if (partialLine.empty()) {
+                line = block.substr(position, newline - position);
+            } else {
+                partialLine.append(block.substr(position, newline - position));
+                line = partialLine;
+                partialLineReturned = true;
+            }
+            position = newline + 1;
+            ++lines;
+            return true;
+        }
+
+        // The rest of the block is the start of a line that goes on in the next block
+        partialLine.append(block.substr(position));
+        block = decompressor ? decompressor->next() : std::string_view();
+        position = 0;
+        if (block.empty()) {
+            ended = true;
+            if (!partialLine.empty()) { // Last line without a trailing newline
+                line = partialLine;
+                partialLineReturned = true;
+                ++lines;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+std::uint64_t FeedLineReader::bytesRead() const {
+    return decompressor ? decompressor->compressedBytesRead() : position;
+}
+
+// --- ReorderBuffer ---
+
+ReorderBuffer::ReorderBuffer(std::size_t capacity)
+    : slots(std::max<std::size_t>(capacity, 1)) {
+    heap.reserve(slots.size());
+    freeSlots.reserve(slots.size());
+    for (std::size_t i = slots.size(); i-- > 0;) {
+        freeSlots.push_back(static_cast<std::uint32_t>(i));
+    }
+}
+
+void ReorderBuffer::push(const EventView& event, std::uint64_t duplicateKey) {
+    const std::uint32_t index = freeSlots.back();
+    freeSlots.pop_back();
+    Slot& slot = slots[index];
+    slot.type = event.type;
+    slot.duplicateKey = duplicateKey;
+    slot.description.assign(event.description.data(), event.description.size());
+    heap.push_back(HeapEntry{event.timestampMinutes, index, nextSequence++});
+    std::push_heap(heap.begin(), heap.end());
+}
+
+EventView ReorderBuffer::top() const {
+    const Slot& slot = slots[heap.front().slot];
+    EventView event;
+    event.timestampMinutes = heap.front().timestampMinutes;
+    event.type = slot.type;
+    event.description = slot.description;
+    return event;
+}
+
+void ReorderBuffer::pop() {
+    std::pop_heap(heap.begin(), heap.end());
+    freeSlots.push_back(heap.back().slot);
+    heap.pop_back();
+}
+
+// --- DuplicateFilter ---
+
+bool DuplicateFilter::isDuplicate(const EventView& event, std::uint64_t key, std::size_t feed) {
+    if (tolerance < 0) {
+        return false;
+    }
+    newestMinute = window.empty() ? event.timestampMinutes : std::max(newestMinute, event.timestampMinutes);
+    expire();
+    if (event.timestampMinutes < newestMinute - tolerance) {
+        return false; // Far out of order: kept, but not remembered, so the window stays small
+    }
+
+    // Of the kept events with this key, in tolerance, that the feed has not matched yet,
+    // the earliest: with both sides in minute order, matching the earliest candidate
+    // pairs up the most events (the closest one could take the only partner of the next)
+    const std::uint64_t feedBit = std::uint64_t{1} << (feed % 64);
+    const Bucket* bucket = findBucket(key);
+    KeptEvent* earliest = nullptr;
+    for (std::uint64_t serial = bucket ? bucket->newestSerial : 0; serial >= firstSerial;) {
+        KeptEvent& kept = window[static_cast<std::size_t>(serial - firstSerial)];
+        if (std::abs(kept.timestampMinutes - event.timestampMinutes) <= tolerance && (kept.feeds & feedBit) == 0 &&
+            (!earliest || kept.timestampMinutes <= earliest->timestampMinutes)) {
+            earliest = &kept; // The chain runs from newest to oldest: on equal minutes the older wins
+        }
+        serial = kept.previousWithKey;
+    }
+    if (earliest) {
+        earliest->feeds |= feedBit;
+        return true;
+    }
+    const std::uint64_t serial = firstSerial + window.size();
+    window.push_back(KeptEvent{key, bucket ? bucket->newestSerial : 0, event.timestampMinutes, feedBit});
+    insertKey(key, serial);
+    return false;
+}
+
+std::uint64_t DuplicateFilter::keyOf(const EventView& event) {
+    // 64-bit FNV-1a over the type and the bytes normalizeDescription would write
+    constexpr std::uint64_t prime = 0x100000001b3ull;
+    std::uint64_t hash = 0xcbf29ce484222325ull ^ static_cast<std::uint64_t>(event.type);
+    bool separatorPending = false;
+    bool anyWord = false;
+    for (char c : event.description) {
+        const char keyByte = keyBytes.bytes[static_cast<unsigned char>(c)];
+        if (keyByte != 0) {
+            if (separatorPending) {
+                hash = (hash ^ static_cast<unsigned char>(' ')) * prime;
+                separatorPending = false;
+            }
+            hash = (hash ^ static_cast<unsigned char>(keyByte)) * prime;
+            anyWord = true;
+        } else {
+            separatorPending = anyWord;
+        }
+    }
+    return hash;
+}
+
+DuplicateFilter::Bucket* DuplicateFilter::findBucket(std::uint64_t key) {
+    if (buckets.empty()) {
+        return nullptr;
+    }
+    const std::size_t mask = buckets.size() - 1;
+    for (std::size_t i = static_cast<std::size_t>(key) & mask;; i = (i + 1) & mask) {
+        if (buckets[i].newestSerial == 0) {
+            return nullptr;
+        }
+        if (buckets[i].key == key) {
+            return &buckets[i];
+        }
+    }
+}
+
+void DuplicateFilter::insertKey(std::uint64_t key, std::uint64_t serial) {
+    if (Bucket* bucket = findBucket(key)) {
+        bucket->newestSerial = serial;
+        return;
+    }
+    if (2 * (usedBuckets + 1) > buckets.size()) {
+        std::vector<Bucket> old(std::max<std::size_t>(64, 2 * buckets.size()));
+        old.swap(buckets);
+        usedBuckets = 0;
+        for (const Bucket& bucket : old) {
+            if (bucket.newestSerial != 0) {
+                insertKey(bucket.key, bucket.newestSerial);
+            }
+        }
+    }
+    const std::size_t mask = buckets.size() - 1;
+    std::size_t i = static_cast<std::size_t>(key) & mask;
+    while (buckets[i].newestSerial != 0) {
+        i = (i + 1) & mask;
+    }
+    buckets[i] = Bucket{key, serial};
+    usedBuckets += 1;
+}
+
+void DuplicateFilter::eraseBucket(Bucket* bucket) {
+    // Backward-shift deletion: later buckets of the probe run move up into the gap,
+    // so lookups never need tombstones
+    const std::size_t mask = buckets.size() - 1;
+    std::size_t gap = static_cast<std::size_t>(bucket - buckets.data());
+    for (std::size_t i = (gap + 1) & mask; buckets[i].newestSerial != 0; i = (i + 1) & mask) {
+        const std::size_t home = static_cast<std::size_t>(buckets[i].key) & mask;
+        // The bucket may fill the gap unless its home lies cyclically in (gap, i]
+        if (((i - home) & mask) >= ((i - gap) & mask)) {
+            buckets[gap] = buckets[i];
+            gap = i;
+        }
+    }
+    buckets[gap] = Bucket();
+    usedBuckets -= 1;
+}
+
+void DuplicateFilter::expire() {
+    while (!window.empty() && window.front().timestampMinutes < newestMinute - tolerance) {
+        // Older kept events of a key are simply no longer reached; the key goes once its newest does
+        Bucket* bucket = findBucket(window.front().key);
+        if (bucket && bucket->newestSerial == firstSerial) {
+            eraseBucket(bucket);
+        }
+        window.pop_front();
+        ++firstSerial;
+    }
+}
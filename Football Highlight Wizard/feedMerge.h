@@ -0,0 +1,164 @@
+#ifndef FEEDMERGE_H
+#define FEEDMERGE_H
+
+#include "compressedLog.h"
+#include "eventStore.h"
+#include "gameEvent.h"
+#include "mappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Building blocks of HighlightWizard::loadEventsFromFiles, which loads one match
+// from several feeds (typically one per data provider) as a single event list:
+// every feed is read line by line, put in minute order by a small ReorderBuffer,
+// the feeds are merged with a k-way heap merge, and the events that two feeds
+// both report are dropped by a DuplicateFilter. Memory stays bounded by the
+// buffers, whatever the number and size of the feeds.
+
+// Options of a multi-feed load (LoadOptions::feedMerge)
+struct FeedMergeOptions {
+    // Events of the same type and description key (see normalizeDescription) from
+    // two different feeds are one event if at most this many minutes apart.
+    // Negative: keep every event.
+    int duplicateToleranceMinutes = 1;
+    // Events a feed may run ahead of an earlier-minute event and still have it put
+    // back in order; each feed buffers this many events
+    std::size_t reorderWindow = 256;
+};
+
+// What the last multi-feed load did
+struct FeedMergeStats {
+    std::size_t feeds = 0;
+    std::uint64_t eventsRead = 0;        // From every feed, before de-duplication
+    std::uint64_t duplicatesDropped = 0;
+    std::uint64_t lateEvents = 0;        // Out of order by more than the reorder window; kept where they came
+};
+
+// The key duplicates are compared on: the words of the description (runs of ASCII
+// letters and digits, or of non-ASCII bytes), lower case, joined by single spaces.
+// "GOAL! Neymar (Brazil)" and "goal - neymar, brazil" have the same key.
+// Writes to key, so one buffer can be reused for every event
+void normalizeDescription(std::string_view description, std::string& key);
+
+// The lines of one log, plain (mapped) or gzip/zstd compressed (decompressed in
+// blocks on a second thread), in file order
+class FeedLineReader {
+public:
+    // Throws std::runtime_error if the file cannot be opened or its compression is not supported
+    explicit FeedLineReader(const std::string& filename);
+
+    // The next line, without its newline; false after the last one. The view is
+    // valid until the next call.
+    // Throws std::runtime_error if compressed data is damaged or truncated
+    bool next(std::string_view& line);
+
+    // Number of the line last returned by next(), from 1
+    int lineNumber() const { return lines; }
+    // Bytes of the file read so far (compressed bytes for a compressed log)
+    std::uint64_t bytesRead() const;
+    std::uint64_t size() const { return file.size(); }
+
+private:
+    MappedFile file;
+    std::unique_ptr<DecompressingReader> decompressor; // Null for a plain log
+    std::string_view block;                            // The whole file, or the current decompressed block
+    std::size_t position = 0;
+    std::string partialLine;                           // A line split over two blocks
+    bool partialLineReturned = false;
+    bool ended = false;
+    int lines = 0;
+};
+
+// Holds up to a fixed number of events of one feed and hands out the earliest
+// (smallest minute, then first read), so a feed that is only locally out of order
+// leaves it sorted. Descriptions are copied into slots that keep their capacity,
+// so a long feed allocates nothing once the buffer has filled; the heap itself
+// holds just the sort keys, so reordering never touches the descriptions.
+class ReorderBuffer {
+public:
+    explicit ReorderBuffer(std::size_t capacity);
+
+    bool empty() const { return heap.empty(); }
+    bool full() const { return freeSlots.empty(); }
+    // Must not be full. duplicateKey travels with the event (see DuplicateFilter::keyOf),
+    // so it is computed while the description is still in cache
+    void push(const EventView& event, std::uint64_t duplicateKey = 0);
+    // The earliest event; must not be empty. Valid until the next push or pop
+    EventView top() const;
+    std::uint64_t topDuplicateKey() const { return slots[heap.front().slot].duplicateKey; }
+    void pop();
+
+private:
+    struct Slot {
+        EventType type = EventType::OTHER;
+        std::uint64_t duplicateKey = 0;
+        std::string description;
+    };
+    struct HeapEntry {
+        int timestampMinutes;
+        std::uint32_t slot;
+        std::uint64_t sequence;
+
+        // Orders the min-heap: the later entry sinks
+        bool operator<(const HeapEntry& other) const {
+            return timestampMinutes != other.timestampMinutes ? timestampMinutes > other.timestampMinutes
+                                                              : sequence > other.sequence;
+        }
+    };
+    std::vector<Slot> slots;
+    std::vector<HeapEntry> heap;
+    std::vector<std::uint32_t> freeSlots;
+    std::uint64_t nextSequence = 0;
+};
+
+// Remembers the events kept in the last toleranceMinutes of a merged stream and
+// recognises an event another feed already reported. Each kept event absorbs at
+// most one event per other feed, so two identical events of one provider still
+// match the two of another; events of the same feed never absorb each other.
+class DuplicateFilter {
+public:
+    explicit DuplicateFilter(int toleranceMinutes) : tolerance(toleranceMinutes) {}
+
+    // Whether the event (with key keyOf(event)) duplicates a kept one; otherwise it is
+    // kept (remembered). Expects (nearly) ascending minutes, as the merge produces them.
+    bool isDuplicate(const EventView& event, std::uint64_t key, std::size_t feed);
+
+    // Whether any event can be a duplicate (the tolerance is not negative)
+    bool enabled() const { return tolerance >= 0; }
+
+    // The key events are compared on: a 64-bit hash of the type and of the
+    // normalizeDescription key of the description, computed without building it
+    static std::uint64_t keyOf(const EventView& event);
+
+private:
+    struct KeptEvent {
+        std::uint64_t key;
+        std::uint64_t previousWithKey; // Serial of the kept event before it with the same key, 0: none
+        int timestampMinutes;
+        std::uint64_t feeds;           // Bit feed % 64 for the feeds reported in it
+    };
+    // Open-addressing table (linear probing) from a key to the serial of the newest
+    // kept event with it; an empty bucket holds serial 0
+    struct Bucket {
+        std::uint64_t key = 0;
+        std::uint64_t newestSerial = 0;
+    };
+    int tolerance;
+    int newestMinute = 0;
+    std::uint64_t firstSerial = 1;  // Serial of window.front(); serials start at 1
+    std::deque<KeptEvent> window;   // Kept events, in merge order
+    std::vector<Bucket> buckets;    // Size a power of two, at most half full
+    std::size_t usedBuckets = 0;
+
+    Bucket* findBucket(std::uint64_t key);
+    void insertKey(std::uint64_t key, std::uint64_t serial);
+    void eraseBucket(Bucket* bucket);
+    void expire();
+};
+
+#endif // FEEDMERGE_H
@@ -0,0 +1,66 @@
+#ifndef GAMEEVENT_H
+#define GAMEEVENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept> // For exceptions
+#include <string>
+#include <string_view>
+
+// Every event type, in enum order. This list is the single source for the enum
+// and for both directions of the name mapping, so adding a type here is enough.
+#define HIGHLIGHT_WIZARD_EVENT_TYPES(X) \
+    X(GOAL)                             \
+    X(YELLOW_CARD)                      \
+    X(RED_CARD)                         \
+    X(FOUL)                             \
+    X(SUBSTITUTION)                     \
+    X(GAME_START)                       \
+    X(HALF_TIME)                        \
+    X(FULL_TIME)                        \
+    X(OTHER)   /* For events not explicitly handled */ \
+    X(UNKNOWN) /* For parsing errors */
+
+// Enum to represent different types of game events
+// One byte wide so EventStore can keep the types as a compact column
+enum class EventType : std::uint8_t {
+#define HIGHLIGHT_WIZARD_ENUM_VALUE(name) name,
+    HIGHLIGHT_WIZARD_EVENT_TYPES(HIGHLIGHT_WIZARD_ENUM_VALUE)
+#undef HIGHLIGHT_WIZARD_ENUM_VALUE
+};
+
+// Names of the event types, indexed by the enum value
+inline constexpr std::string_view eventTypeNames[] = {
+#define HIGHLIGHT_WIZARD_TYPE_NAME(name) #name,
+    HIGHLIGHT_WIZARD_EVENT_TYPES(HIGHLIGHT_WIZARD_TYPE_NAME)
+#undef HIGHLIGHT_WIZARD_TYPE_NAME
+};
+inline constexpr std::size_t eventTypeCount = sizeof(eventTypeNames) / sizeof(eventTypeNames[0]);
+
+// Struct to hold information about a single game event
+struct GameEvent {
+    int timestampMinutes = -1;
+    EventType type = EventType::UNKNOWN;
+    std::string description;
+
+    // Optional: Add player, team info later if needed
+    // std::string player;
+    // std::string team;
+
+    // Helper to convert EventType to string for printing (a constexpr table lookup)
+    static constexpr std::string_view typeToString(EventType t) {
+        const auto index = static_cast<std::size_t>(t);
+        return index < eventTypeCount ? eventTypeNames[index] : std::string_view("INVALID_TYPE");
+    }
+    // Helper to convert string to EventType for parsing
+    // Case-insensitive, allocation-free lookup in a compile-time perfect hash table
+    static EventType stringToType(std::string_view s);
+};
+
+// Exception class for file parsing errors
+class ParseException : public std::runtime_error {
+public:
+    ParseException(const std::string& message) : std::runtime_error(message) {}
+};
+
+#endif // GAMEEVENT_H
@@ -0,0 +1,116 @@
+#include "matchLogGenerator.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// Writes a synthetic match log, from a single match to tens of millions of
+// lines, for benchmarks and load tests
+
+namespace {
+
+void printUsage(const char* program) {
+    std::cout << "Usage: " << program << " [options]\n"
+              << "\n"
+              << "Writes a synthetic <minute>,<EVENT_TYPE>,<description> match log.\n"
+              << "\n"
+              << "Options:\n"
+              << "  -n, --events <n>         Lines to write (default: 2000, about one match)\n"
+              << "  -o, --output <file>      Output file (default: standard output)\n"
+              << "  --seed <n>               Random seed; the same options and seed give the same log\n"
+              << "  --minutes <n>            Length of the match in minutes (default: 90)\n"
+              << "  --mix <TYPE=w,...>       Event type weights (default: GOAL=3,YELLOW_CARD=4,\n"
+              << "                           RED_CARD=0.3,FOUL=25,SUBSTITUTION=6,OTHER=60)\n"
+              << "  --words <min>-<max>      Words per description (default: 3-10)\n"
+              << "  --comma-rate <r>         Fraction of descriptions containing a comma (default: 0.05)\n"
+              << "  --malformed-rate <r>     Fraction of lines the parser rejects (default: 0)\n"
+              << "  -h, --help               Show this help\n";
+}
+
+unsigned long long parseUnsigned(const std::string& option, const std::string& value) {
+    try {
+        std::size_t used = 0;
+        const unsigned long long number = std::stoull(value, &used);
+        if (used == value.size() && value[0] != '-') {
+            return number;
+        }
+    } catch (const std::exception&) {
+        // Reported below
+    }
+    throw std::runtime_error("Invalid value for " + option + ": '" + value + "'");
+}
+
+double parseRate(const std::string& option, const std::string& value) {
+    try {
+        std::size_t used = 0;
+        const double rate = std::stod(value, &used);
+        if (used == value.size() && rate >= 0 && rate <= 1) {
+            return rate;
+        }
+    } catch (const std::exception&) {
+        // Reported below
+    }
+    throw std::runtime_error("Invalid value for " + option + " (expected 0..1): '" + value + "'");
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    MatchLogOptions options;
+    std::string outputFile;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const std::string arg = argv[i];
+            auto nextValue = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::runtime_error("Missing value for " + arg);
+                }
+                return argv[++i];
+            };
+
+            if (arg == "-h" || arg == "--help") {
+                printUsage(argv[0]);
+                return EXIT_SUCCESS;
+            } else if (arg == "-n" || arg == "--events") {
+                options.eventCount = parseUnsigned(arg, nextValue());
+            } else if (arg == "-o" || arg == "--output") {
+                outputFile = nextValue();
+            } else if (arg == "--seed") {
+                options.seed = parseUnsigned(arg, nextValue());
+            } else if (arg == "--minutes") {
+                options.matchMinutes = static_cast<int>(parseUnsigned(arg, nextValue()));
+            } else if (arg == "--mix") {
+                options.typeWeights = parseTypeWeights(nextValue());
+            } else if (arg == "--words") {
+                const std::string value = nextValue();
+                const std::size_t dash = value.find('-');
+                if (dash == std::string::npos) {
+                    throw std::runtime_error("Invalid value for " + arg + " (expected <min>-<max>): '" + value + "'");
+                }
+                options.minDescriptionWords = static_cast<int>(parseUnsigned(arg, value.substr(0, dash)));
+                options.maxDescriptionWords = static_cast<int>(parseUnsigned(arg, value.substr(dash + 1)));
+            } else if (arg == "--comma-rate") {
+                options.commaRate = parseRate(arg, nextValue());
+            } else if (arg == "--malformed-rate") {
+                options.malformedRate = parseRate(arg, nextValue());
+            } else {
+                throw std::runtime_error("Unknown option: " + arg);
+            }
+        }
+
+        if (outputFile.empty()) {
+            generateMatchLog(options, std::cout);
+        } else {
+            std::ofstream out(outputFile, std::ios::binary);
+            if (!out.is_open()) {
+                throw std::runtime_error("Could not write file: " + outputFile);
+            }
+            generateMatchLog(options, out);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
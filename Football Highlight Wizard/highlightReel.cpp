@@ -0,0 +1,172 @@
+#include "highlightReel.h"
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+// Whether a makes the reel before b: heavier, then earlier, then first in the file
+bool ranksBefore(const ScoredHighlight& a, const ScoredHighlight& b) {
+    if (a.weight != b.weight) {
+        return a.weight > b.weight;
+    }
+    if (a.timestampMinutes != b.timestampMinutes) {
+        return a.timestampMinutes < b.timestampMinutes;
+    }
+    return a.row < b.row;
+}
+
+} // namespace
+
+std::array<double, eventTypeCount> HighlightScoring::defaultTypeWeights() {
+    std::array<double, eventTypeCount> weights{};
+    weights[static_cast<std::size_t>(EventType::GOAL)] = 10;
+    weights[static_cast<std::size_t>(EventType::RED_CARD)] = 7;
+    weights[static_cast<std::size_t>(EventType::YELLOW_CARD)] = 2;
+    weights[static_cast<std::size_t>(EventType::FOUL)] = 0.5;
+    weights[static_cast<std::size_t>(EventType::SUBSTITUTION)] = 0.25;
+    weights[static_cast<std::size_t>(EventType::OTHER)] = 0.1;
+    return weights;
+}
+
+std::array<int, eventTypeCount> HighlightScoring::defaultClipSeconds() {
+    std::array<int, eventTypeCount> seconds;
+    seconds.fill(15);
+    seconds[static_cast<std::size_t>(EventType::GOAL)] = 40;
+    seconds[static_cast<std::size_t>(EventType::RED_CARD)] = 30;
+    seconds[static_cast<std::size_t>(EventType::YELLOW_CARD)] = 20;
+    seconds[static_cast<std::size_t>(EventType::SUBSTITUTION)] = 10;
+    seconds[static_cast<std::size_t>(EventType::GAME_START)] = 10;
+    seconds[static_cast<std::size_t>(EventType::HALF_TIME)] = 10;
+    return seconds;
+}
+
+std::vector<ScoredHighlight> scoreHighlights(const EventStore& events, const TimeIndex& timeIndex,
+                                             const std::vector<std::uint32_t>& candidates,
+                                             const HighlightScoring& scoring) {
+    for (int seconds : scoring.clipSeconds) {
+        if (seconds < 1) {
+            throw std::invalid_argument("Clip lengths must be at least one second");
+        }
+    }
+    const ColumnView<int> timestamps = events.timestamps();
+    const ColumnView<EventType> types = events.types();
+    const std::vector<std::uint32_t>& rows = timeIndex.rowsInTimeOrder();
+    const auto typeWeight = [&](std::uint32_t row) {
+        return scoring.typeWeights[static_cast<std::size_t>(types[row])];
+    };
+
+    // Candidates in the time index's order (minute, then row), so one sweep over the
+    // rows serves them all
+    std::vector<std::size_t> order(candidates.size());
+    std::iota(order.begin(), order.end(), std::size_t{0});
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+        const int minuteA = timestamps[candidates[a]];
+        const int minuteB = timestamps[candidates[b]];
+        return minuteA != minuteB ? minuteA < minuteB : candidates[a] < candidates[b];
+    });
+
+    std::vector<ScoredHighlight> scored(candidates.size());
+    std::size_t before = 0;                   // rows[0, before): the events before the candidate
+    std::uint64_t goalsBefore = 0;
+    int lastYellowMinute = std::numeric_limits<int>::min();
+    std::size_t windowBegin = 0;              // rows[windowBegin, windowEnd): within clusterMinutes
+    std::size_t windowEnd = 0;
+    double windowWeight = 0;
+    std::size_t windowClusterEvents = 0;
+
+    for (std::size_t index : order) {
+        const std::uint32_t row = candidates[index];
+        const int minute = timestamps[row];
+        const EventType type = types[row];
+
+        while (before < rows.size() &&
+               (timestamps[rows[before]] < minute || (timestamps[rows[before]] == minute && rows[before] < row))) {
+            const EventType earlierType = types[rows[before]];
+            if (earlierType == EventType::GOAL) {
+                ++goalsBefore;
+            } else if (earlierType == EventType::YELLOW_CARD) {
+                lastYellowMinute = timestamps[rows[before]];
+            }
+            ++before;
+        }
+        while (windowEnd < rows.size() && timestamps[rows[windowEnd]] <= minute + scoring.clusterMinutes) {
+            windowWeight += typeWeight(rows[windowEnd]);
+            windowClusterEvents += typeWeight(rows[windowEnd]) >= scoring.clusterEventMinWeight;
+            ++windowEnd;
+        }
+        while (windowBegin < windowEnd && timestamps[rows[windowBegin]] < minute - scoring.clusterMinutes) {
+            windowWeight -= typeWeight(rows[windowBegin]);
+            windowClusterEvents -= typeWeight(rows[windowBegin]) >= scoring.clusterEventMinWeight;
+            ++windowBegin;
+        }
+
+        double weight = typeWeight(row);
+        if (type == EventType::GOAL && goalsBefore % 2 == 1) {
+            weight += scoring.equaliserBonus;
+        }
+        if (type == EventType::RED_CARD && lastYellowMinute != std::numeric_limits<int>::min() &&
+            minute - lastYellowMinute <= scoring.secondYellowMinutes) {
+            weight += scoring.secondYellowBonus;
+        }
+        // The window holds the candidate itself too; max() absorbs rounding of the running sum
+        const double neighbourWeight = std::max(0.0, windowWeight - typeWeight(row));
+        const std::size_t neighbours = windowClusterEvents - (typeWeight(row) >= scoring.clusterEventMinWeight ? 1 : 0);
+        weight += std::min(scoring.maxClusterBonus, scoring.clusterFactor * neighbourWeight);
+        if (minute >= scoring.lateFromMinute) {
+            weight *= scoring.lateMultiplier;
+        }
+
+        ScoredHighlight& highlight = scored[index];
+        highlight.row = row;
+        highlight.timestampMinutes = minute;
+        highlight.weight = weight;
+        highlight.clipSeconds = scoring.clipSeconds[static_cast<std::size_t>(type)] +
+                                scoring.clusterClipSeconds *
+                                    static_cast<int>(std::min<std::size_t>(neighbours, std::max(scoring.maxClusterEvents, 0)));
+    }
+    return scored;
+}
+
+HighlightReel selectHighlightReel(const std::vector<ScoredHighlight>& scored, int budgetSeconds) {
+    HighlightReel reel;
+    reel.budgetSeconds = budgetSeconds;
+    if (scored.empty() || budgetSeconds <= 0) {
+        return reel;
+    }
+    int shortest = std::numeric_limits<int>::max();
+    for (const ScoredHighlight& highlight : scored) {
+        shortest = std::min(shortest, std::max(highlight.clipSeconds, 1));
+    }
+    const std::size_t capacity = std::min<std::size_t>(scored.size(), static_cast<std::size_t>(budgetSeconds / shortest));
+    if (capacity == 0) {
+        return reel;
+    }
+
+    // The best `capacity` candidates so far; the heap's front is the weakest of them
+    std::vector<ScoredHighlight> best;
+    best.reserve(capacity);
+    for (const ScoredHighlight& highlight : scored) {
+        if (best.size() < capacity) {
+            best.push_back(highlight);
+            std::push_heap(best.begin(), best.end(), ranksBefore);
+        } else if (ranksBefore(highlight, best.front())) {
+            std::pop_heap(best.begin(), best.end(), ranksBefore);
+            best.back() = highlight;
+            std::push_heap(best.begin(), best.end(), ranksBefore);
+        }
+    }
+    std::sort_heap(best.begin(), best.end(), ranksBefore); // Best first
+
+    for (const ScoredHighlight& highlight : best) {
+        if (highlight.clipSeconds <= budgetSeconds - reel.totalSeconds) {
+            reel.clips.push_back(highlight);
+            reel.totalSeconds += highlight.clipSeconds;
+        }
+    }
+    std::sort(reel.clips.begin(), reel.clips.end(), [](const ScoredHighlight& a, const ScoredHighlight& b) {
+        return a.timestampMinutes != b.timestampMinutes ? a.timestampMinutes < b.timestampMinutes : a.row < b.row;
+    });
+    return reel;
+}
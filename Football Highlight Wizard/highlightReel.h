@@ -0,0 +1,84 @@
+#ifndef HIGHLIGHTREEL_H
+#define HIGHLIGHTREEL_H
+
+#include "eventStore.h"
+#include "gameEvent.h"
+#include "timeIndex.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Ranking of the highlights and selection of a reel that fits a time budget
+// ("the best 4 minutes of this match"). scoreHighlights gives every candidate a
+// weight and a clip length in one pass over the events in time order;
+// selectHighlightReel keeps the best candidates in a bounded heap and fills the
+// budget from them, in O(n log k) for n candidates and at most k clips.
+
+// How highlights are weighted and how long their clips are
+struct HighlightScoring {
+    // Base weight and clip length of each event type
+    std::array<double, eventTypeCount> typeWeights = defaultTypeWeights();
+    std::array<int, eventTypeCount> clipSeconds = defaultClipSeconds();
+
+    // Highlights from this minute on (the closing stage) weigh lateMultiplier times as much
+    int lateFromMinute = 75;
+    double lateMultiplier = 1.5;
+
+    // Logs do not say which team scored, so a goal after an odd number of goals is
+    // taken as a possible equaliser (the score cannot be level before it) and gains
+    // equaliserBonus; with the late multiplier, a late equaliser ranks near the top
+    double equaliserBonus = 4;
+
+    // A RED_CARD at most secondYellowMinutes after a YELLOW_CARD is taken for a second
+    // yellow and gains secondYellowBonus
+    int secondYellowMinutes = 1;
+    double secondYellowBonus = 3;
+
+    // Busy passages: every other event within clusterMinutes adds clusterFactor times
+    // its type weight (at most maxClusterBonus in all), and every one whose type weighs
+    // at least clusterEventMinWeight (a foul or more, by default) lengthens the clip by
+    // clusterClipSeconds, at most maxClusterEvents times
+    int clusterMinutes = 1;
+    double clusterFactor = 0.25;
+    double maxClusterBonus = 5;
+    double clusterEventMinWeight = 0.5;
+    int clusterClipSeconds = 5;
+    int maxClusterEvents = 4;
+
+    static std::array<double, eventTypeCount> defaultTypeWeights();
+    static std::array<int, eventTypeCount> defaultClipSeconds();
+};
+
+// A highlight with its score
+struct ScoredHighlight {
+    std::uint32_t row = 0;      // In the EventStore
+    int timestampMinutes = 0;
+    double weight = 0;
+    int clipSeconds = 0;
+};
+
+// The clips chosen for a time budget
+struct HighlightReel {
+    std::vector<ScoredHighlight> clips; // In time order, as they are played
+    int totalSeconds = 0;
+    int budgetSeconds = 0;
+};
+
+// Scores the candidate rows (e.g. the highlights found by the rules), returned in
+// the order given. The time index must cover every event of the store.
+// O(n) for n events, plus sorting the candidates by time.
+// Throws std::invalid_argument if a clip length is below one second
+std::vector<ScoredHighlight> scoreHighlights(const EventStore& events, const TimeIndex& timeIndex,
+                                             const std::vector<std::uint32_t>& candidates,
+                                             const HighlightScoring& scoring);
+
+// The heaviest clips that fit in budgetSeconds together: candidates are taken by
+// descending weight (then earlier minute) and a clip that no longer fits is
+// skipped for the next ones. Only the k best candidates can take part, k being the
+// most clips the budget holds (budget / shortest clip), so they are kept in a heap
+// of k entries. Every candidate left out that would still fit weighs no more than
+// any chosen clip.
+HighlightReel selectHighlightReel(const std::vector<ScoredHighlight>& scored, int budgetSeconds);
+
+#endif // HIGHLIGHTREEL_H
@@ -0,0 +1,228 @@
+#include "highlightRules.h"
+#include <algorithm>
+#include <charconv>  // For std::from_chars
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <stdexcept> // For runtime_error
+
+namespace {
+
+// Minute stored in a SEQUENCE slot before its first type was ever seen
+constexpr int noMinute = std::numeric_limits<int>::min();
+
+std::vector<std::string_view> splitFields(std::string_view line) {
+    std::vector<std::string_view> fields;
+    std::size_t position = 0;
+    while (true) {
+        position = line.find_first_not_of(" \t\r", position);
+        if (position == std::string_view::npos) {
+            break;
+        }
+        const std::size_t end = std::min(line.find_first_of(" \t\r", position), line.size());
+        fields.push_back(line.substr(position, end - position));
+        position = end;
+    }
+    return fields;
+}
+
+[[noreturn]] void throwRuleError(int lineNumber, const std::string& message, std::string_view line) {
+    throw ParseException("Error parsing rule line " + std::to_string(lineNumber) + ": " + message + ". Line: '" + std::string(line) + "'");
+}
+
+EventType parseRuleType(std::string_view field, int lineNumber, std::string_view line) {
+    const EventType type = GameEvent::stringToType(field);
+    if (type == EventType::UNKNOWN) {
+        throwRuleError(lineNumber, "Unknown event type '" + std::string(field) + "'", line);
+    }
+    return type;
+}
+
+int parseRuleNumber(std::string_view field, int minimum, int maximum, int lineNumber, std::string_view line) {
+    int value = 0;
+    const auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+    if (result.ec != std::errc() || result.ptr != field.data() + field.size() || value < minimum || value > maximum) {
+        const std::string range = maximum == std::numeric_limits<int>::max()
+            ? ">= " + std::to_string(minimum)
+            : "from " + std::to_string(minimum) + " to " + std::to_string(maximum);
+        throwRuleError(lineNumber, "Expected a number " + range + ", found '" + std::string(field) + "'", line);
+    }
+    return value;
+}
+
+} // namespace
+
+HighlightRuleSet HighlightRuleSet::defaults() {
+    HighlightRuleSet ruleSet;
+    ruleSet.addRule({"goal", HighlightRuleKind::SINGLE, EventType::GOAL});
+    ruleSet.addRule({"red_card", HighlightRuleKind::SINGLE, EventType::RED_CARD});
+    return ruleSet;
+}
+
+HighlightRuleSet HighlightRuleSet::fromFile(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    const std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    try {
+        return fromText(text);
+    } catch (const ParseException& e) {
+        throw ParseException(std::string(e.what()) + " in file " + filename);
+    }
+}
+
+HighlightRuleSet HighlightRuleSet::fromText(std::string_view text) {
+    HighlightRuleSet ruleSet;
+    int lineNumber = 0;
+    while (!text.empty()) {
+        ++lineNumber;
+        const std::size_t newline = text.find('\n');
+        const std::string_view line = text.substr(0, newline);
+        text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+
+        const std::vector<std::string_view> fields = splitFields(line.substr(0, line.find('#')));
+        if (fields.empty()) {
+            continue; // Blank or comment-only line
+        }
+        if (fields.size() < 3) {
+            throwRuleError(lineNumber, "Expected '<name> <kind> ...'", line);
+        }
+
+        HighlightRule rule;
+        rule.name = std::string(fields[0]);
+        const std::string_view kind = fields[1];
+        if (kind == "single" && fields.size() == 3) {
+            rule.kind = HighlightRuleKind::SINGLE;
+            rule.firstType = parseRuleType(fields[2], lineNumber, line);
+        } else if (kind == "count" && fields.size() == 6 && fields[4] == "within") {
+            rule.kind = HighlightRuleKind::COUNT;
+            rule.count = parseRuleNumber(fields[2], 1, maxRuleCount, lineNumber, line);
+            rule.firstType = parseRuleType(fields[3], lineNumber, line);
+            rule.windowMinutes = parseRuleNumber(fields[5], 0, std::numeric_limits<int>::max(), lineNumber, line);
+        } else if (kind == "sequence" && fields.size() == 6 && fields[4] == "within") {
+            rule.kind = HighlightRuleKind::SEQUENCE;
+            rule.firstType = parseRuleType(fields[2], lineNumber, line);
+            rule.secondType = parseRuleType(fields[3], lineNumber, line);
+            rule.windowMinutes = parseRuleNumber(fields[5], 0, std::numeric_limits<int>::max(), lineNumber, line);
+        } else {
+            throwRuleError(lineNumber, "Expected 'single <TYPE>', 'count <n> <TYPE> within <minutes>' or 'sequence <TYPE> <TYPE> within <minutes>'", line);
+        }
+        ruleSet.addRule(rule);
+    }
+    return ruleSet;
+}
+
+void HighlightRuleSet::addRule(const HighlightRule& rule) {
+    if (rule.firstType == EventType::UNKNOWN ||
+        (rule.kind == HighlightRuleKind::SEQUENCE && rule.secondType == EventType::UNKNOWN)) {
+        throw std::invalid_argument("Highlight rule '" + rule.name + "' uses the UNKNOWN event type");
+    }
+    if (rule.count < 1 || rule.count > maxRuleCount || rule.windowMinutes < 0) {
+        throw std::invalid_argument("Highlight rule '" + rule.name + "' needs a count from 1 to " +
+                                    std::to_string(maxRuleCount) + " and a window >= 0");
+    }
+    rules.push_back(rule);
+    compile();
+}
+
+void HighlightRuleSet::compile() {
+    // Bucket the (type, rule) pairs by event type. Within a type, SEQUENCE_END entries
+    // come before SEQUENCE_START ones, so "sequence GOAL GOAL" compares a goal with the
+    // previous goal before remembering it.
+    std::vector<std::vector<Entry>> byType(eventTypeCount);
+    stateOffsets.assign(1, 0);
+    singleEventTypes.fill(false);
+    for (std::size_t i = 0; i < rules.size(); ++i) {
+        const HighlightRule& rule = rules[i];
+        const std::uint32_t index = static_cast<std::uint32_t>(i);
+        std::uint32_t stateSlots = 0;
+        switch (rule.kind) {
+            case HighlightRuleKind::SINGLE:
+                byType[static_cast<std::size_t>(rule.firstType)].push_back({Action::MATCH, index});
+                singleEventTypes[static_cast<std::size_t>(rule.firstType)] = true;
+                break;
+            case HighlightRuleKind::COUNT:
+                byType[static_cast<std::size_t>(rule.firstType)].push_back({Action::COUNT, index});
+                stateSlots = static_cast<std::uint32_t>(rule.count);
+                break;
+            case HighlightRuleKind::SEQUENCE:
+                byType[static_cast<std::size_t>(rule.secondType)].push_back({Action::SEQUENCE_END, index});
+                byType[static_cast<std::size_t>(rule.firstType)].push_back({Action::SEQUENCE_START, index});
+                stateSlots = 1;
+                break;
+        }
+        stateOffsets.push_back(stateOffsets.back() + stateSlots);
+    }
+
+    entries.clear();
+    entryOffsets.assign(eventTypeCount + 1, 0);
+    for (std::size_t type = 0; type < eventTypeCount; ++type) {
+        std::stable_sort(byType[type].begin(), byType[type].end(), [](const Entry& a, const Entry& b) {
+            return (a.action == Action::SEQUENCE_START) < (b.action == Action::SEQUENCE_START);
+        });
+        entries.insert(entries.end(), byType[type].begin(), byType[type].end());
+        entryOffsets[type + 1] = static_cast<std::uint32_t>(entries.size());
+    }
+}
+
+HighlightRuleMatcher::HighlightRuleMatcher(const HighlightRuleSet& rules) : ruleSet(rules) {
+    reset();
+}
+
+void HighlightRuleMatcher::reset() {
+    state.assign(ruleSet.stateOffsets.back(), noMinute);
+    ringPositions.assign(ruleSet.rules.size(), 0);
+    ringFill.assign(ruleSet.rules.size(), 0);
+}
+
+bool HighlightRuleMatcher::feed(int minute, EventType type, std::vector<std::size_t>* matchedRules) {
+    const std::size_t typeIndex = static_cast<std::size_t>(type);
+    if (typeIndex >= eventTypeCount) {
+        return false;
+    }
+
+    bool matched = false;
+    const std::uint32_t end = ruleSet.entryOffsets[typeIndex + 1];
+    for (std::uint32_t e = ruleSet.entryOffsets[typeIndex]; e < end; ++e) {
+        const HighlightRuleSet::Entry entry = ruleSet.entries[e];
+        const HighlightRule& rule = ruleSet.rules[entry.rule];
+        int* slots = state.data() + ruleSet.stateOffsets[entry.rule];
+        bool ruleMatched = false;
+
+        switch (entry.action) {
+            case HighlightRuleSet::Action::MATCH:
+                ruleMatched = true;
+                break;
+            case HighlightRuleSet::Action::COUNT: {
+                // Ring of the last `count` minutes; once full, the slot about to be
+                // overwritten next holds the oldest of them
+                const std::uint32_t count = static_cast<std::uint32_t>(rule.count);
+                std::uint32_t& position = ringPositions[entry.rule];
+                std::uint32_t& fill = ringFill[entry.rule];
+                slots[position] = minute;
+                position = (position + 1 == count) ? 0 : position + 1;
+                if (fill < count) {
+                    ++fill;
+                }
+                ruleMatched = (fill == count) && (minute - slots[position] <= rule.windowMinutes);
+                break;
+            }
+            case HighlightRuleSet::Action::SEQUENCE_END:
+                ruleMatched = slots[0] != noMinute && minute >= slots[0] &&
+                              minute - slots[0] <= rule.windowMinutes;
+                break;
+            case HighlightRuleSet::Action::SEQUENCE_START:
+                slots[0] = minute;
+                break;
+        }
+
+        if (ruleMatched) {
+            matched = true;
+            if (matchedRules) {
+                matchedRules->push_back(entry.rule);
+            }
+        }
+    }
+    return matched;
+}
@@ -0,0 +1,113 @@
+#ifndef HIGHLIGHTRULES_H
+#define HIGHLIGHTRULES_H
+
+#include "gameEvent.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// What a rule looks for
+enum class HighlightRuleKind : std::uint8_t {
+    SINGLE,   // Every event of firstType                        "single GOAL"
+    COUNT,    // count events of firstType within the window     "count 2 YELLOW_CARD within 10"
+    SEQUENCE  // secondType at most window minutes after firstType "sequence GOAL SUBSTITUTION within 2"
+};
+
+// Largest n of a COUNT rule; its matcher keeps the minutes of the last n events
+inline constexpr int maxRuleCount = 10000;
+
+struct HighlightRule {
+    std::string name;
+    HighlightRuleKind kind = HighlightRuleKind::SINGLE;
+    EventType firstType = EventType::UNKNOWN;
+    EventType secondType = EventType::UNKNOWN; // SEQUENCE only
+    int count = 1;                             // COUNT only, at most maxRuleCount
+    int windowMinutes = 0;                     // COUNT and SEQUENCE
+};
+
+// A set of highlight rules, compiled into a per-event-type dispatch table.
+//
+// Rule file format: one rule per line, '#' starts a comment, fields are
+// separated by whitespace and type names are case-insensitive:
+//
+//     <name> single   <TYPE>
+//     <name> count    <n> <TYPE> within <minutes>
+//     <name> sequence <FIRST_TYPE> <SECOND_TYPE> within <minutes>
+//
+// The event that completes a pattern is the highlight: the n-th card of a
+// COUNT rule, the SECOND_TYPE event of a SEQUENCE rule.
+class HighlightRuleSet {
+public:
+    // The built-in rules: every GOAL and every RED_CARD
+    static HighlightRuleSet defaults();
+
+    // Throws std::runtime_error if the file cannot be opened
+    // Throws ParseException if a rule line is malformed
+    static HighlightRuleSet fromFile(const std::string& filename);
+    static HighlightRuleSet fromText(std::string_view text);
+
+    // Throws std::invalid_argument for an UNKNOWN type, a count outside 1..maxRuleCount
+    // or a negative window
+    void addRule(const HighlightRule& rule);
+
+    const std::vector<HighlightRule>& getRules() const { return rules; }
+
+    // True if some rule looks at more than one event (COUNT or SEQUENCE). Only
+    // those need the events in time order; SINGLE rules can be fed in any order.
+    bool hasWindowedRules() const { return stateOffsets.back() != 0; }
+
+    // True if a SINGLE rule makes every event of this type a highlight
+    bool isSingleEventHighlight(EventType type) const { return singleEventTypes[static_cast<std::size_t>(type)]; }
+
+private:
+    friend class HighlightRuleMatcher;
+
+    // One table entry per (event type, rule) pair that reacts to that type
+    enum class Action : std::uint8_t {
+        MATCH,          // SINGLE rule: this type is a highlight
+        COUNT,          // COUNT rule: add to the window, match when it holds count events
+        SEQUENCE_END,   // SEQUENCE rule: match if the first type was seen recently
+        SEQUENCE_START  // SEQUENCE rule: remember the minute of the first type
+    };
+    struct Entry {
+        Action action;
+        std::uint32_t rule;
+    };
+
+    std::vector<HighlightRule> rules;
+    std::array<bool, eventTypeCount> singleEventTypes{}; // Types matched by a SINGLE rule
+    std::vector<std::uint32_t> entryOffsets = std::vector<std::uint32_t>(eventTypeCount + 1, 0);
+    std::vector<Entry> entries; // Grouped by event type, see entryOffsets
+    std::vector<std::uint32_t> stateOffsets = {0}; // Per rule: first slot in the matcher's state, plus the total
+
+    void compile();
+};
+
+// Streaming evaluation of a HighlightRuleSet with sliding-window state.
+// Feed events in time order; each event costs one table lookup plus the
+// rules that mention its type, whatever the total number of rules.
+class HighlightRuleMatcher {
+public:
+    HighlightRuleMatcher() = default;
+    explicit HighlightRuleMatcher(const HighlightRuleSet& rules);
+
+    // Forgets every window, as if no event had been fed
+    void reset();
+
+    // Returns true if the event completes at least one rule; when matchedRules
+    // is given, the indices of those rules are appended to it
+    bool feed(int minute, EventType type, std::vector<std::size_t>* matchedRules = nullptr);
+
+private:
+    HighlightRuleSet ruleSet; // A private copy: rule sets are small, and the matcher stays self-contained
+    // COUNT rules: ring buffer of the last `count` minutes + write position
+    // SEQUENCE rules: minute of the last first-type event
+    std::vector<int> state;
+    std::vector<std::uint32_t> ringPositions;
+    std::vector<std::uint32_t> ringFill;
+};
+
+#endif // HIGHLIGHTRULES_H
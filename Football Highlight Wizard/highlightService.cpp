@@ -0,0 +1,291 @@
+#include "highlightService.h"
+#include <algorithm>
+#include <charconv> // For std::to_chars, std::from_chars
+#include <exception>
+#include <iostream>
+
+namespace {
+
+// Keeps a reader inside its read section for a scope
+class ReadSection {
+public:
+    ReadSection(SnapshotPublisher<ServiceSnapshot>& snapshots, std::size_t reader)
+        : snapshots(snapshots), reader(reader), snapshot(snapshots.enter(reader)) {}
+    ~ReadSection() { snapshots.leave(reader); }
+
+    ReadSection(const ReadSection&) = delete;
+    ReadSection& operator=(const ReadSection&) = delete;
+
+    const ServiceSnapshot& get() const { return *snapshot; }
+
+private:
+    SnapshotPublisher<ServiceSnapshot>& snapshots;
+    std::size_t reader;
+    const ServiceSnapshot* snapshot;
+};
+
+void appendNumber(std::string& out, long long value) {
+    char digits[24];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+// "<minute>,<EVENT_TYPE>,<description>\n", as in a log
+void appendEventLine(std::string& out, const EventView& event) {
+    appendNumber(out, event.timestampMinutes);
+    out += ',';
+    out += GameEvent::typeToString(event.type);
+    out += ',';
+    out += event.description;
+    out += '\n';
+}
+
+void appendCountLine(std::string& out, std::size_t count) {
+    out += "OK ";
+    appendNumber(out, static_cast<long long>(count));
+    out += '\n';
+}
+
+void setError(std::string& response, std::string_view message) {
+    response.assign("ERROR ");
+    response += message;
+    response += '\n';
+}
+
+// Splits a request line into its space-separated words (at most maxWords; false if there are more)
+bool splitWords(std::string_view line, std::string_view* words, std::size_t maxWords, std::size_t& count) {
+    count = 0;
+    while (!line.empty()) {
+        const std::size_t start = line.find_first_not_of(' ');
+        if (start == std::string_view::npos) {
+            break;
+        }
+        line.remove_prefix(start);
+        if (count == maxWords) {
+            return false;
+        }
+        const std::size_t end = std::min(line.find(' '), line.size());
+        words[count++] = line.substr(0, end);
+        line.remove_prefix(end);
+    }
+    return true;
+}
+
+bool parseMinute(std::string_view text, int& minute) {
+    const auto result = std::from_chars(text.data(), text.data() + text.size(), minute);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+} // namespace
+
+const MatchSnapshot* ServiceSnapshot::find(std::string_view name) const {
+    const auto found = std::lower_bound(matches.begin(), matches.end(), name,
+                                        [](const std::shared_ptr<const MatchSnapshot>& match, std::string_view key) {
+                                            return match->name < key;
+                                        });
+    return (found != matches.end() && (*found)->name == name) ? found->get() : nullptr;
+}
+
+HighlightService::HighlightService(std::size_t readerSlots)
+    : snapshots(readerSlots) {}
+
+HighlightService::~HighlightService() {
+    stopPolling();
+}
+
+void HighlightService::setLoadOptions(const LoadOptions& options) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    loadOptions = options;
+}
+
+void HighlightService::setHighlightRules(const HighlightRuleSet& rules) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    highlightRules = rules;
+}
+
+std::shared_ptr<const MatchSnapshot> HighlightService::snapshotOf(const std::string& name, std::uint64_t version,
+                                                                  const HighlightWizard& wizard) {
+    auto match = std::make_shared<MatchSnapshot>();
+    match->name = name;
+    match->version = version;
+    match->events = wizard.getAllEvents();
+    match->highlightRows = wizard.getHighlightIndices();
+    match->timeIndex.build(match->events); // One linear check for a sorted log
+    return match;
+}
+
+std::uint64_t HighlightService::nextVersionOf(const std::string& name) const {
+    const MatchSnapshot* published = snapshots.latest()->find(name);
+    return published ? published->version + 1 : 1;
+}
+
+void HighlightService::publishMatches(const std::vector<std::shared_ptr<const MatchSnapshot>>& changed) {
+    auto next = std::make_unique<ServiceSnapshot>(*snapshots.latest()); // Shares the unchanged matches
+    for (const auto& match : changed) {
+        const auto position = std::lower_bound(next->matches.begin(), next->matches.end(), match->name,
+                                               [](const std::shared_ptr<const MatchSnapshot>& existing,
+                                                  const std::string& name) { return existing->name < name; });
+        if (position != next->matches.end() && (*position)->name == match->name) {
+            *position = match;
+        } else {
+            next->matches.insert(position, match);
+        }
+    }
+    snapshots.publish(std::move(next));
+}
+
+void HighlightService::loadMatch(const std::string& name, const std::vector<std::string>& filenames) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    HighlightWizard wizard;
+    wizard.setLoadOptions(loadOptions);
+    wizard.setHighlightRules(highlightRules);
+    wizard.loadEventsFromFiles(filenames);
+    wizard.findHighlights();
+    liveMatches.erase(name); // A loaded match is no longer followed
+    publishMatches({snapshotOf(name, nextVersionOf(name), wizard)});
+}
+
+void HighlightService::followMatch(const std::string& name, const std::string& filename) {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    LiveMatch live;
+    live.wizard.setLoadOptions(loadOptions);
+    live.wizard.setHighlightRules(highlightRules);
+    live.wizard.startLiveTail(filename);
+    live.wizard.pollLiveTail();
+    live.version = nextVersionOf(name);
+    publishMatches({snapshotOf(name, live.version, live.wizard)});
+    liveMatches[name] = std::move(live);
+}
+
+std::size_t HighlightService::pollLiveMatches() {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    std::vector<std::shared_ptr<const MatchSnapshot>> changed;
+    std::size_t newEvents = 0;
+    std::exception_ptr firstError;
+    for (auto& [name, live] : liveMatches) {
+        const std::size_t sizeBefore = live.wizard.getAllEvents().size();
+        try {
+            live.wizard.pollLiveTail();
+        } catch (const std::exception&) {
+            // The events before the bad line are appended all the same
+            if (!firstError) {
+                firstError = std::current_exception();
+            }
+        }
+        const std::size_t sizeAfter = live.wizard.getAllEvents().size();
+        if (sizeAfter != sizeBefore) { // Grown, or restarted after the log was truncated
+            changed.push_back(snapshotOf(name, ++live.version, live.wizard));
+            newEvents += sizeAfter > sizeBefore ? sizeAfter - sizeBefore : sizeAfter;
+        }
+    }
+    if (!changed.empty()) {
+        publishMatches(changed);
+    } else {
+        snapshots.reclaim(); // Frees what readers have let go of since the last publication
+    }
+    if (firstError) {
+        std::rethrow_exception(firstError);
+    }
+    return newEvents;
+}
+
+void HighlightService::startPolling(std::chrono::milliseconds interval) {
+    stopPolling();
+    pollerStopping = false;
+    poller = std::thread([this, interval] {
+        std::unique_lock<std::mutex> lock(pollerMutex);
+        while (!pollerWake.wait_for(lock, interval, [this] { return pollerStopping; })) {
+            lock.unlock();
+            try {
+                pollLiveMatches();
+            } catch (const std::exception& e) {
+                std::cerr << "Warning: " << e.what() << std::endl; // Keep following after a bad line
+            }
+            lock.lock();
+        }
+    });
+}
+
+void HighlightService::stopPolling() {
+    if (!poller.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(pollerMutex);
+        pollerStopping = true;
+    }
+    pollerWake.notify_all();
+    poller.join();
+}
+
+std::size_t HighlightService::registerReader() {
+    return snapshots.registerReader();
+}
+
+void HighlightService::unregisterReader(std::size_t reader) {
+    snapshots.unregisterReader(reader);
+}
+
+std::size_t HighlightService::matchCount() const {
+    std::lock_guard<std::mutex> lock(writerMutex);
+    return snapshots.latest()->matches.size();
+}
+
+void HighlightService::answer(std::size_t reader, std::string_view request, std::string& response) {
+    response.clear();
+    while (!request.empty() && (request.back() == '\n' || request.back() == '\r')) {
+        request.remove_suffix(1);
+    }
+    std::string_view words[4];
+    std::size_t wordCount = 0;
+    if (!splitWords(request, words, 4, wordCount) || wordCount == 0) {
+        setError(response, "Expected MATCHES, HIGHLIGHTS <match> or RANGE <match> <first> <last>");
+        return;
+    }
+    const std::string_view command = words[0];
+
+    const ReadSection section(snapshots, reader);
+    const ServiceSnapshot& snapshot = section.get();
+    if (command == "MATCHES" && wordCount == 1) {
+        appendCountLine(response, snapshot.matches.size());
+        for (const auto& match : snapshot.matches) {
+            response += match->name;
+            response += ' ';
+            appendNumber(response, static_cast<long long>(match->events.size()));
+            response += ' ';
+            appendNumber(response, static_cast<long long>(match->highlightRows.size()));
+            response += ' ';
+            appendNumber(response, static_cast<long long>(match->version));
+            response += '\n';
+        }
+        return;
+    }
+
+    if ((command == "HIGHLIGHTS" && wordCount == 2) || (command == "RANGE" && wordCount == 4)) {
+        const MatchSnapshot* match = snapshot.find(words[1]);
+        if (!match) {
+            setError(response, "Unknown match: " + std::string(words[1]));
+            return;
+        }
+        if (command == "HIGHLIGHTS") {
+            appendCountLine(response, match->highlightRows.size());
+            for (const EventView& event : EventIndexView(match->events, match->highlightRows)) {
+                appendEventLine(response, event);
+            }
+            return;
+        }
+        int firstMinute = 0;
+        int lastMinute = 0;
+        if (!parseMinute(words[2], firstMinute) || !parseMinute(words[3], lastMinute)) {
+            setError(response, "Invalid minute range: " + std::string(words[2]) + " " + std::string(words[3]));
+            return;
+        }
+        const EventIndexView events = match->timeIndex.eventsBetween(match->events, firstMinute, lastMinute);
+        appendCountLine(response, events.size());
+        for (const EventView& event : events) {
+            appendEventLine(response, event);
+        }
+        return;
+    }
+    setError(response, "Unknown request: " + std::string(request));
+}
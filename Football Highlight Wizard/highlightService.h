@@ -0,0 +1,127 @@
+#ifndef HIGHLIGHTSERVICE_H
+#define HIGHLIGHTSERVICE_H
+
+#include "eventStore.h"
+#include "highlightRules.h"
+#include "highlightWizard.h"
+#include "snapshotPublisher.h"
+#include "timeIndex.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Loaded matches held in memory for many concurrent readers (the back end of
+// FootballHighlightWizardDaemon): tools query highlights and time ranges without
+// loading the logs themselves.
+//
+// Every query reads an immutable ServiceSnapshot published through a
+// SnapshotPublisher, so a query takes no lock and a load or live append, which
+// builds the next snapshot on the side, never makes one wait.
+//
+// Requests and responses are single text payloads (the daemon frames them):
+//
+//   MATCHES                        one line per match: <name> <events> <highlights> <version>
+//   HIGHLIGHTS <match>             the match's highlights, in file order
+//   RANGE <match> <first> <last>   its events from minute first to last, in time order
+//
+// A response is "OK <n>\n" followed by n lines, events written as log lines
+// (<minute>,<EVENT_TYPE>,<description>), or a single "ERROR <message>\n" line.
+
+// One match as queries see it; never changed once published
+struct MatchSnapshot {
+    std::string name;
+    std::uint64_t version = 0;                // 1 for the first load, one more per published change
+    EventStore events;
+    std::vector<std::uint32_t> highlightRows; // Rows of events, in file order
+    TimeIndex timeIndex;
+};
+
+// Every match the service holds
+struct ServiceSnapshot {
+    std::vector<std::shared_ptr<const MatchSnapshot>> matches; // Sorted by name
+
+    // Null if there is no match of that name
+    const MatchSnapshot* find(std::string_view name) const;
+};
+
+class HighlightService {
+public:
+    // readerSlots: the most threads that may query at the same time (see registerReader)
+    explicit HighlightService(std::size_t readerSlots = 256);
+    // Stops polling
+    ~HighlightService();
+
+    HighlightService(const HighlightService&) = delete;
+    HighlightService& operator=(const HighlightService&) = delete;
+
+    // How later loads read the logs and find the highlights
+    void setLoadOptions(const LoadOptions& options);
+    void setHighlightRules(const HighlightRuleSet& rules);
+
+    // --- Writers: any thread, one at a time (they take a writer lock) ---
+    // Loads a match from its log, or from several feeds merged (see
+    // HighlightWizard::loadEventsFromFiles), and publishes it, replacing a match of
+    // the same name. Throws like loadEventsFromFiles; the published matches stay as they were
+    void loadMatch(const std::string& name, const std::vector<std::string>& filenames);
+    // Publishes a match that follows a log still being written (see
+    // HighlightWizard::startLiveTail); pollLiveMatches publishes what it gains
+    // Throws like startLiveTail and pollLiveTail
+    void followMatch(const std::string& name, const std::string& filename);
+    // Appends what the followed logs gained and publishes the matches that grew, in
+    // one snapshot. Returns the number of new events.
+    // Throws ParseException for the first malformed line (unless lenient), once
+    // everything else is published; that line is skipped by the next poll
+    std::size_t pollLiveMatches();
+    // Calls pollLiveMatches every interval on a background thread until stopPolling;
+    // its errors are written to stderr
+    void startPolling(std::chrono::milliseconds interval);
+    void stopPolling();
+
+    // --- Readers ---
+    // Each thread that answers requests takes a slot first and gives it back when it is done
+    // Throws std::runtime_error if every slot is taken
+    std::size_t registerReader();
+    void unregisterReader(std::size_t reader);
+
+    // Writes the response to one request (see the protocol above) into response;
+    // a bad request gets an ERROR response. Takes no lock.
+    void answer(std::size_t reader, std::string_view request, std::string& response);
+
+    // The matches now published, for the writer side (e.g. a start-up summary)
+    std::size_t matchCount() const;
+
+private:
+    struct LiveMatch {
+        HighlightWizard wizard;
+        std::uint64_t version = 0;
+    };
+
+    SnapshotPublisher<ServiceSnapshot> snapshots;
+    mutable std::mutex writerMutex; // Serialises loads, polls and publications
+    LoadOptions loadOptions;
+    HighlightRuleSet highlightRules = HighlightRuleSet::defaults();
+    std::map<std::string, LiveMatch> liveMatches;
+
+    std::thread poller;
+    std::mutex pollerMutex;
+    std::condition_variable pollerWake;
+    bool pollerStopping = false;
+
+    // Copies what queries need out of a loaded wizard
+    static std::shared_ptr<const MatchSnapshot> snapshotOf(const std::string& name, std::uint64_t version,
+                                                           const HighlightWizard& wizard);
+    // The version a new snapshot of the match gets
+    std::uint64_t nextVersionOf(const std::string& name) const;
+    // Publishes a snapshot with these matches added or replaced; writerMutex must be held
+    void publishMatches(const std::vector<std::shared_ptr<const MatchSnapshot>>& changed);
+};
+
+#endif // HIGHLIGHTSERVICE_H
@@ -1,188 +1,1279 @@
 #include "highlightWizard.h"
-#include <fstream>
-#include <sstream>
+#include "delimiterScan.h"
+#include "mappedFile.h"
 #include <iostream>
 #include <algorithm> // For std::find_if, std::transform etc. if needed later
 #include <stdexcept> // For runtime_error
+#include <charconv>  // For std::from_chars
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <exception> // For std::exception_ptr
+#include <fstream>
+#include <filesystem> // For std::filesystem::file_size
+#include <utility>
+#include <array>
+#include <chrono>
+#include <sstream>
+#include <optional>
+#include <queue>
+#include <functional> // For std::greater
 
 // --- GameEvent Static Helper Implementations ---
 
-std::string GameEvent::typeToString(EventType t) {
-    switch (t) {
-        case EventType::GOAL:         return "GOAL";
-        case EventType::YELLOW_CARD:  return "YELLOW_CARD";
-        case EventType::RED_CARD:     return "RED_CARD";
-        case EventType::FOUL:         return "FOUL";
-        case EventType::SUBSTITUTION: return "SUBSTITUTION";
-        case EventType::GAME_START:   return "GAME_START";
-        case EventType::HALF_TIME:    return "HALF_TIME";
-        case EventType::FULL_TIME:    return "FULL_TIME";
-        case EventType::OTHER:        return "OTHER";
-        case EventType::UNKNOWN:      return "UNKNOWN";
-        default:                      return "INVALID_TYPE";
-    }
-}
-
-EventType GameEvent::stringToType(const std::string& s) {
-    std::string upper_s = s;
-    // Convert to uppercase for case-insensitive comparison
-    std::transform(upper_s.begin(), upper_s.end(), upper_s.begin(), ::toupper);
-
-    if (upper_s == "GOAL") return EventType::GOAL;
-    if (upper_s == "YELLOW_CARD") return EventType::YELLOW_CARD;
-    if (upper_s == "RED_CARD") return EventType::RED_CARD;
-    if (upper_s == "FOUL") return EventType::FOUL;
-    if (upper_s == "SUBSTITUTION") return EventType::SUBSTITUTION;
-    if (upper_s == "GAME_START") return EventType::GAME_START;
-    if (upper_s == "HALF_TIME") return EventType::HALF_TIME;
-    if (upper_s == "FULL_TIME") return EventType::FULL_TIME;
-    if (upper_s == "OTHER") return EventType::OTHER;
+namespace {
+
+// Same folding ::toupper does in the "C" locale
+constexpr char asciiUpper(char c) {
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+// Seeded hash of the length and the upper-cased first, middle and last bytes, so
+// "goal" and "GOAL" hash alike. It only has to separate the known names (the
+// full comparison after the lookup rejects everything else), and it costs the
+// same few instructions whatever the input length.
+constexpr std::uint32_t typeNameHash(std::string_view name, std::uint32_t seed) {
+    if (name.empty()) {
+        return 0;
+    }
+    std::uint32_t key = static_cast<std::uint32_t>(name.size()) << 24;
+    key |= static_cast<std::uint32_t>(static_cast<unsigned char>(asciiUpper(name.front())));
+    key |= static_cast<std::uint32_t>(static_cast<unsigned char>(asciiUpper(name[name.size() / 2]))) << 8;
+    key |= static_cast<std::uint32_t>(static_cast<unsigned char>(asciiUpper(name.back()))) << 16;
+    std::uint32_t hash = key * (2654435761u + 2u * seed);
+    return hash ^ (hash >> 15);
+}
+
+// Slot -> EventType index, or emptySlot. Sized so a collision-free seed exists.
+constexpr std::size_t typeTableSize = 32;
+constexpr std::uint8_t emptySlot = 0xFF;
+static_assert(typeTableSize >= 2 * eventTypeCount, "Grow typeTableSize when adding event types");
+static_assert((typeTableSize & (typeTableSize - 1)) == 0, "typeTableSize must be a power of two");
+
+struct TypeLookupTable {
+    bool found = false;
+    std::uint32_t seed = 0;
+    std::uint8_t slots[typeTableSize] = {};
+};
+
+// Searches, at compile time, for the first seed that maps every name to its own slot
+constexpr TypeLookupTable buildTypeLookupTable() {
+    for (std::uint32_t seed = 0; seed < 100000; ++seed) {
+        TypeLookupTable table;
+        table.seed = seed;
+        for (auto& slot : table.slots) {
+            slot = emptySlot;
+        }
+        bool collision = false;
+        for (std::size_t type = 0; type < eventTypeCount && !collision; ++type) {
+            std::uint8_t& slot = table.slots[typeNameHash(eventTypeNames[type], seed) & (typeTableSize - 1)];
+            collision = (slot != emptySlot);
+            slot = static_cast<std::uint8_t>(type);
+        }
+        if (!collision) {
+            table.found = true;
+            return table;
+        }
+    }
+    return TypeLookupTable{}; // Rejected by the static_assert below
+}
+
+constexpr TypeLookupTable typeLookupTable = buildTypeLookupTable();
+static_assert(typeLookupTable.found, "No perfect hash seed found for the event type names");
+
+constexpr bool equalsIgnoreCase(std::string_view text, std::string_view upperName) {
+    if (text.size() != upperName.size()) {
+        return false;
+    }
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        if (asciiUpper(text[i]) != upperName[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
 
+EventType GameEvent::stringToType(std::string_view s) {
+    // One hash and at most one comparison, instead of upper-casing a copy and
+    // trying every name in turn
+    const std::uint8_t slot = typeLookupTable.slots[typeNameHash(s, typeLookupTable.seed) & (typeTableSize - 1)];
+    if (slot != emptySlot && equalsIgnoreCase(s, eventTypeNames[slot])) {
+        return static_cast<EventType>(slot);
+    }
     return EventType::UNKNOWN; // Return UNKNOWN if string doesn't match
 }
 
 
+// --- Parsing Helpers ---
+
+namespace {
+
+enum class TimestampStatus { Ok, InvalidFormat, OutOfRange };
+
+// Same whitespace set std::stoi skips in the "C" locale
+bool isTimestampSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+// Allocation-free replacement for std::stoi that accepts exactly what stoi did:
+// leading whitespace, an optional sign, base-10 digits and ignored trailing junk.
+// Negative values are reported as out of range, like the old explicit check did.
+TimestampStatus parseTimestamp(std::string_view text, int& value) {
+    const char* first = text.data();
+    const char* last = text.data() + text.size();
+    while (first != last && isTimestampSpace(*first)) {
+        ++first;
+    }
+    bool negative = false;
+    if (first != last && (*first == '+' || *first == '-')) {
+        negative = (*first == '-');
+        ++first;
+    }
+
+    unsigned long long magnitude = 0;
+    const std::errc ec = std::from_chars(first, last, magnitude).ec; // Unsigned: rejects a second sign
+    if (ec == std::errc::invalid_argument) {
+        return TimestampStatus::InvalidFormat;
+    }
+    if (ec == std::errc::result_out_of_range
+        || magnitude > static_cast<unsigned long long>(std::numeric_limits<int>::max())
+        || (negative && magnitude != 0)) {
+        return TimestampStatus::OutOfRange;
+    }
+    value = static_cast<int>(magnitude);
+    return TimestampStatus::Ok;
+}
+
+// Warnings can come from several parser threads at once; each one is written
+// as a single string under this lock so lines never interleave.
+std::mutex warningOutputMutex;
+
+void writeWarning(const std::string& message) {
+    std::lock_guard<std::mutex> lock(warningOutputMutex);
+    std::cerr << message << std::endl;
+}
+
+// All diagnostics of a load in one write, so concurrent loads do not interleave
+void writeDiagnostics(const ParseDiagnostics& diagnostics, std::string_view source) {
+    std::ostringstream text;
+    diagnostics.write(text, source);
+    std::lock_guard<std::mutex> lock(warningOutputMutex);
+    std::cerr << text.str() << std::flush;
+}
+
+// Deals with a line the parser found an issue in: throws for an error in strict
+// mode, records it otherwise. Returns whether the line still gives an event.
+bool handleParseIssue(ParseIssue issue, std::string_view line, int lineNumber, bool lenient,
+                      ParseDiagnostics& diagnostics) {
+    if (isParseError(issue) && !lenient) {
+        throw ParseException(describeParseIssue(issue, line, lineNumber));
+    }
+    diagnostics.record(issue, line, lineNumber);
+    return !isParseError(issue);
+}
+
+// Stage timings of the lines sampled by a parser thread (one in parseSampleInterval)
+struct LineSample {
+    std::array<std::uint64_t, pipelineStageCount> nanoseconds{};
+    std::uint64_t lines = 0;
+    std::chrono::steady_clock::time_point lastLap;
+};
+
+// Points to the parser thread's LineSample while a sampled line is parsed, null otherwise
+thread_local LineSample* currentLineSample = nullptr;
+
+// Cost of one steady_clock::now() call, taken off every lap: a sampled line is
+// split into about six laps of a few dozen nanoseconds each, so the clock itself
+// would otherwise be most of what is measured
+std::uint64_t clockReadNanoseconds() {
+    static const std::uint64_t cost = [] {
+        constexpr int reads = 1000;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 1; i < reads; ++i) {
+            (void)std::chrono::steady_clock::now();
+        }
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) / reads;
+    }();
+    return cost;
+}
+
+// Charges the time since the previous lap of the sampled line to stage; does
+// nothing for any other line (and without instrumentation)
+void lapLineSample(PipelineStage stage) {
+    if constexpr (instrumentationEnabled) {
+        if (LineSample* sample = currentLineSample) {
+            const auto now = std::chrono::steady_clock::now();
+            const auto lap = static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - sample->lastLap).count());
+            const std::uint64_t clockCost = clockReadNanoseconds();
+            sample->nanoseconds[static_cast<std::size_t>(stage)] += lap > clockCost ? lap - clockCost : 0;
+            sample->lastLap = now;
+        }
+    }
+}
+
+// Chunks smaller than this are not worth a thread of their own
+constexpr std::size_t minParallelChunkBytes = 256 * 1024;
+
+unsigned resolveThreadCount(unsigned requested) {
+    if (requested != 0) {
+        return requested;
+    }
+    unsigned hardware = std::thread::hardware_concurrency();
+    return hardware == 0 ? 1 : hardware;
+}
+
+// Runs task(0) .. task(count - 1) concurrently, using the calling thread for the first one
+template <typename Task>
+void runInParallel(std::size_t count, const Task& task) {
+    std::vector<std::thread> workers;
+    workers.reserve(count > 0 ? count - 1 : 0);
+    for (std::size_t i = 1; i < count; ++i) {
+        workers.emplace_back([&task, i] { task(i); });
+    }
+    if (count > 0) {
+        task(0);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+// Splits the buffer into roughly equal chunks that all start at the beginning of a line
+std::vector<std::string_view> splitAtLineBoundaries(std::string_view buffer, std::size_t chunkCount) {
+    std::vector<std::string_view> chunks;
+    std::size_t begin = 0;
+    for (std::size_t i = 1; i <= chunkCount && begin < buffer.size(); ++i) {
+        std::size_t end = buffer.size();
+        if (i < chunkCount) {
+            std::size_t target = std::max(begin, buffer.size() / chunkCount * i);
+            std::size_t newline = buffer.find('\n', target);
+            end = (newline == std::string_view::npos) ? buffer.size() : newline + 1;
+        }
+        chunks.push_back(buffer.substr(begin, end - begin));
+        begin = end;
+    }
+    return chunks;
+}
+
+// Parsers report progress (and look for a cancellation) every this many lines
+constexpr std::size_t progressLineInterval = 64 * 1024;
+// Lines whose delimiters are found in one scan; their offsets stay in the L1 cache
+constexpr std::size_t scanWindowLines = 1024;
+// Appended bytes a live tail poll reads and parses at a time
+constexpr std::size_t liveTailBlockBytes = 1 << 20;
+
+// An offset into a scanned chunk as an offset into the line starting at lineBegin
+std::size_t offsetInLine(std::size_t offset, std::size_t lineBegin) {
+    return offset == std::string_view::npos ? std::string_view::npos : offset - lineBegin;
+}
+
+} // namespace
+
+class HighlightWizard::LoadMonitor {
+public:
+    LoadMonitor(const LoadOptions& options, std::uint64_t totalBytes, PipelineStats& stats)
+        : options(options), totalBytes(totalBytes), stats(stats) {}
+
+    // Adds what one parser did since its last update, reports the totals and
+    // throws LoadCancelled if the cancel flag is raised
+    void update(std::uint64_t newBytes, std::size_t newEvents) {
+        const std::uint64_t bytes = bytesParsed += newBytes;
+        const std::size_t events = eventsParsed += newEvents;
+        if (options.progressCallback) {
+            std::lock_guard<std::mutex> lock(callbackMutex);
+            options.progressCallback(LoadProgress{inputPosition ? inputPosition() : bytes, totalBytes, events});
+        }
+        throwIfCancelled();
+    }
+
+    void throwIfCancelled() const {
+        if (options.cancelFlag && options.cancelFlag->load(std::memory_order_relaxed)) {
+            throw LoadCancelled("Loading cancelled");
+        }
+    }
+
+    // For a compressed log: the parsed bytes do not add up to totalBytes, so progress
+    // is reported as the position in the compressed file instead
+    void trackInputPosition(std::function<std::uint64_t()> position) { inputPosition = std::move(position); }
+
+    bool isLenient() const { return options.lenient; }
+    std::size_t diagnosticSampleLimit() const { return options.diagnosticSampleLimit; }
+
+    // Adds the counters of one parsed chunk to the wizard's pipeline stats. The
+    // sampled stage times are scaled up to every parsed line of the chunk.
+    void addChunkStats(std::uint64_t lines, std::uint64_t parsedLines, const LineSample& sample) {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.lines += lines;
+        for (PipelineStage stage : {PipelineStage::LINE_SPLIT, PipelineStage::TIMESTAMP,
+                                    PipelineStage::TYPE_LOOKUP, PipelineStage::STORE}) {
+            StageStats& stageStats = stats[stage];
+            stageStats.calls += sample.lines;
+            stageStats.items += parsedLines;
+            if (sample.lines > 0) {
+                stageStats.nanoseconds += sample.nanoseconds[static_cast<std::size_t>(stage)] * parsedLines / sample.lines;
+            }
+        }
+    }
+
+private:
+    const LoadOptions& options;
+    const std::uint64_t totalBytes;
+    PipelineStats& stats;
+    std::mutex statsMutex;
+    std::atomic<std::uint64_t> bytesParsed{0};
+    std::atomic<std::size_t> eventsParsed{0};
+    std::function<std::uint64_t()> inputPosition;
+    std::mutex callbackMutex;
+};
+
+
 // --- HighlightWizard Member Function Implementations ---
 
+void HighlightWizard::setLoadOptions(const LoadOptions& options) {
+    loadOptions = options;
+}
+
+const LoadOptions& HighlightWizard::getLoadOptions() const {
+    return loadOptions;
+}
+
 bool HighlightWizard::loadEventsFromFile(const std::string& filename) {
-    std::ifstream inputFile(filename);
-    if (!inputFile.is_open()) {
-        // It's often better to throw an exception here or return false and let the caller handle it
-        // std::cerr << "Error: Could not open file " << filename << std::endl;
-         throw std::runtime_error("Could not open file: " + filename);
-        // return false;
+    // A log that has not changed since its events were cached is mapped, not parsed
+    std::optional<EventCacheKey> cacheKey;
+    if (loadOptions.useEventCache) {
+        cacheKey = eventCacheKeyFor(filename); // Throws std::runtime_error("Could not open file: ...")
+        if (loadEventsFromCache(filename, *cacheKey)) {
+            return true;
+        }
     }
 
+    MappedFile file = [&] {
+        ScopedStage stage(pipelineStats, PipelineStage::OPEN);
+        // Throws std::runtime_error("Could not open file: ...") if the file cannot be opened
+        MappedFile mapped(filename);
+        stage.addBytes(mapped.size());
+        return mapped;
+    }();
+
     allEvents.clear(); // Clear previous events
-    highlightEvents.clear(); // Also clear previous highlights
+    highlightIndices.clear(); // Also clear previous highlights
+    liveTail = LiveTailState(); // A full load ends any live tail
+    liveMatcher.reset();
+
+    const std::string_view buffer = file.view();
+    const LogCompression compression = detectLogCompression(buffer.substr(0, 4));
+    const std::size_t chunkCount = std::min<std::size_t>(resolveThreadCount(loadOptions.threadCount),
+                                                         buffer.size() / minParallelChunkBytes);
+    parseDiagnostics = ParseDiagnostics(loadOptions.diagnosticSampleLimit);
+    ParseDiagnostics diagnostics(loadOptions.diagnosticSampleLimit);
+    LoadMonitor monitor(loadOptions, buffer.size(), pipelineStats);
+    try {
+        ScopedStage stage(pipelineStats, PipelineStage::PARSE);
+        stage.addBytes(buffer.size());
+        monitor.throwIfCancelled();
+        if (compression != LogCompression::NONE) {
+            parseCompressedLog(filename, compression, diagnostics, monitor);
+        } else if (chunkCount <= 1) {
+            // The descriptions can never take more bytes than the file itself; untouched
+            // reserved pages cost no memory, and the arena is never copied while growing
+            allEvents.reserve(0, buffer.size());
+            parseChunk(buffer, 1, allEvents, diagnostics, monitor);
+        } else {
+            parseChunksInParallel(buffer, chunkCount, diagnostics, monitor);
+        }
+        stage.addItems(allEvents.size());
+    } catch (const LoadCancelled&) {
+        allEvents.clear();
+        timeIndex.clear();
+        descriptionIndex.clear();
+        throw LoadCancelled("Loading cancelled: " + filename);
+    } catch (const ParseException& e) {
+        if constexpr (instrumentationEnabled) {
+            pipelineStats.errors += 1;
+            pipelineStats.events += allEvents.size();
+        }
+        // The warnings of the lines before the bad one come first, as a serial parse
+        // would have met them; then propagate the specific parse error
+        adoptParseDiagnostics(diagnostics, filename);
+        buildIndexes();
+        throw ParseException(std::string(e.what()) + " in file " + filename);
+    } catch (const std::runtime_error&) {
+        // A damaged or truncated compressed log: none of it is loaded
+        allEvents.clear();
+        timeIndex.clear();
+        descriptionIndex.clear();
+        throw;
+    }
+
+    if constexpr (instrumentationEnabled) {
+        pipelineStats.events += allEvents.size();
+    }
+    adoptParseDiagnostics(diagnostics, filename);
+    buildIndexes();
+    // Only a log without any issue is cached, so a load from the cache (which reports
+    // nothing) gives the same result a parse would
+    if (cacheKey && parseDiagnostics.empty() && file.size() == cacheKey->sourceSize) {
+        writeEventCacheFor(filename, *cacheKey);
+    }
+    return true;
+}
+
+bool HighlightWizard::loadEventsFromCache(const std::string& filename, const EventCacheKey& key) {
+    std::optional<EventStore> cached;
+    {
+        ScopedStage stage(pipelineStats, PipelineStage::CACHE_READ);
+        cached = readEventCache(eventCachePathFor(filename, loadOptions.eventCacheDirectory), key);
+        if (!cached) {
+            return false; // Missing, stale or damaged: parse the log
+        }
+        stage.addBytes(key.sourceSize);
+        stage.addItems(cached->size());
+    }
+
+    allEvents = std::move(*cached);
+    highlightIndices.clear();
+    liveTail = LiveTailState();
+    liveMatcher.reset();
+    parseDiagnostics = ParseDiagnostics(loadOptions.diagnosticSampleLimit);
+    LoadMonitor monitor(loadOptions, key.sourceSize, pipelineStats);
+    try {
+        monitor.update(key.sourceSize, allEvents.size()); // The one progress report of the load
+    } catch (const LoadCancelled&) {
+        allEvents.clear();
+        timeIndex.clear();
+        descriptionIndex.clear();
+        throw LoadCancelled("Loading cancelled: " + filename);
+    }
+    if constexpr (instrumentationEnabled) {
+        pipelineStats.events += allEvents.size();
+    }
+    buildIndexes();
+    return true;
+}
+
+void HighlightWizard::writeEventCacheFor(const std::string& filename, const EventCacheKey& key) const {
+    ScopedStage stage(pipelineStats, PipelineStage::CACHE_WRITE);
+    try {
+        writeEventCache(eventCachePathFor(filename, loadOptions.eventCacheDirectory), key, allEvents);
+        stage.addItems(allEvents.size());
+    } catch (const std::runtime_error&) {
+        // The cache only saves time: a log in a read-only directory still loads, by parsing
+    }
+}
+
+struct HighlightWizard::MergeFeed {
+    std::string filename;
+    FeedLineReader reader;
+    ReorderBuffer pending;
+    ParseDiagnostics diagnostics;
+    bool ended = false; // Every line of the reader has been read
+
+    MergeFeed(const std::string& filename, std::size_t reorderWindow, std::size_t diagnosticSampleLimit)
+        : filename(filename), reader(filename), pending(reorderWindow), diagnostics(diagnosticSampleLimit) {}
+};
+
+bool HighlightWizard::loadEventsFromFiles(const std::vector<std::string>& filenames) {
+    if (filenames.empty()) {
+        throw std::runtime_error("No log files to load");
+    }
+    if (filenames.size() == 1) {
+        feedMergeStats = FeedMergeStats();
+        loadEventsFromFile(filenames.front());
+        feedMergeStats.feeds = 1;
+        feedMergeStats.eventsRead = allEvents.size();
+        return true;
+    }
+
+    std::vector<MergeFeed> feeds;
+    std::uint64_t totalBytes = 0;
+    {
+        ScopedStage stage(pipelineStats, PipelineStage::OPEN);
+        feeds.reserve(filenames.size());
+        for (const std::string& filename : filenames) {
+            // Throws std::runtime_error("Could not open file: ...") if the file cannot be opened
+            feeds.emplace_back(filename, loadOptions.feedMerge.reorderWindow, loadOptions.diagnosticSampleLimit);
+            totalBytes += feeds.back().reader.size();
+        }
+        stage.addBytes(totalBytes);
+    }
+
+    allEvents.clear();
+    highlightIndices.clear();
+    liveTail = LiveTailState();
+    liveMatcher.reset();
+    parseDiagnostics = ParseDiagnostics(loadOptions.diagnosticSampleLimit);
+    feedMergeStats = FeedMergeStats();
+    feedMergeStats.feeds = feeds.size();
+    LoadMonitor monitor(loadOptions, totalBytes, pipelineStats);
+    monitor.trackInputPosition([&feeds] {
+        std::uint64_t bytes = 0;
+        for (const MergeFeed& feed : feeds) {
+            bytes += feed.reader.bytesRead();
+        }
+        return bytes;
+    });
+    // Adopted feed by feed, so each report names its own file
+    const auto adoptFeedDiagnostics = [&] {
+        for (const MergeFeed& feed : feeds) {
+            adoptParseDiagnostics(feed.diagnostics, feed.filename);
+        }
+    };
+    try {
+        ScopedStage stage(pipelineStats, PipelineStage::PARSE);
+        stage.addBytes(totalBytes);
+        monitor.throwIfCancelled();
+        mergeFeeds(feeds, monitor);
+        stage.addItems(allEvents.size());
+    } catch (const LoadCancelled&) {
+        allEvents.clear();
+        timeIndex.clear();
+        descriptionIndex.clear();
+        throw LoadCancelled("Loading cancelled: " + filenames.front() + " and " +
+                            std::to_string(filenames.size() - 1) + " more feed(s)");
+    } catch (const ParseException&) {
+        if constexpr (instrumentationEnabled) {
+            pipelineStats.errors += 1;
+            pipelineStats.events += allEvents.size();
+        }
+        adoptFeedDiagnostics();
+        buildIndexes();
+        throw;
+    } catch (const std::runtime_error&) {
+        // A damaged or truncated compressed feed: none of the match is loaded
+        allEvents.clear();
+        timeIndex.clear();
+        descriptionIndex.clear();
+        throw;
+    }
+
+    if constexpr (instrumentationEnabled) {
+        pipelineStats.events += allEvents.size();
+    }
+    adoptFeedDiagnostics();
+    buildIndexes();
+    return true;
+}
+
+const FeedMergeStats& HighlightWizard::getFeedMergeStats() const {
+    return feedMergeStats;
+}
+
+const ParseDiagnostics& HighlightWizard::getParseDiagnostics() const {
+    return parseDiagnostics;
+}
+
+void HighlightWizard::adoptParseDiagnostics(const ParseDiagnostics& diagnostics, std::string_view source) {
+    parseDiagnostics.append(diagnostics);
+    if constexpr (instrumentationEnabled) {
+        pipelineStats.warnings += diagnostics.warningCount();
+        pipelineStats.errors += diagnostics.errorCount();
+    }
+    if (loadOptions.reportDiagnostics && !diagnostics.empty()) {
+        writeDiagnostics(diagnostics, source);
+    }
+}
+
+void HighlightWizard::buildIndexes() {
+    {
+        ScopedStage stage(pipelineStats, PipelineStage::TIME_INDEX);
+        stage.addItems(allEvents.size());
+        timeIndex.build(allEvents);
+    }
+    if (loadOptions.indexDescriptions) {
+        buildDescriptionIndex();
+    } else {
+        descriptionIndex.clear();
+    }
+}
+
+void HighlightWizard::buildDescriptionIndex() {
+    ScopedStage stage(pipelineStats, PipelineStage::DESCRIPTION_INDEX);
+    stage.addItems(allEvents.size());
+    descriptionIndex.build(allEvents);
+}
+
+std::vector<std::uint32_t> HighlightWizard::searchDescriptions(const DescriptionQuery& query) const {
+    return descriptionIndex.search(allEvents, query);
+}
+
+void HighlightWizard::saveDescriptionIndex(const std::string& filename) const {
+    descriptionIndex.save(filename);
+}
+
+void HighlightWizard::loadDescriptionIndex(const std::string& filename) {
+    descriptionIndex.load(filename, allEvents);
+}
+
+const DescriptionIndex& HighlightWizard::getDescriptionIndex() const {
+    return descriptionIndex;
+}
+
+const PipelineStats& HighlightWizard::getPipelineStats() const {
+    return pipelineStats;
+}
+
+PipelineStats& HighlightWizard::getPipelineStats() {
+    return pipelineStats;
+}
+
+void HighlightWizard::resetPipelineStats() {
+    pipelineStats.clear();
+}
+
+void HighlightWizard::parseChunksInParallel(std::string_view buffer, std::size_t chunkCount,
+                                            ParseDiagnostics& diagnostics, LoadMonitor& monitor) {
+    const std::vector<std::string_view> chunks = splitAtLineBoundaries(buffer, chunkCount);
+
+    // Pass 1: count the lines of every chunk so each worker knows its first global line number
+    std::vector<int> firstLineNumbers(chunks.size() + 1, 1);
+    runInParallel(chunks.size(), [&](std::size_t i) {
+        firstLineNumbers[i + 1] = static_cast<int>(countNewlines(chunks[i]));
+    });
+    for (std::size_t i = 1; i < firstLineNumbers.size(); ++i) {
+        firstLineNumbers[i] += firstLineNumbers[i - 1];
+    }
+
+    // Pass 2: parse every chunk into its own vector. A worker stops at its first bad line,
+    // and the error of the earliest failing chunk is the one a serial parse would have hit.
+    // A cancellation stops every worker at its next progress update.
+    std::vector<EventStore> chunkEvents(chunks.size());
+    std::vector<ParseDiagnostics> chunkDiagnostics(chunks.size(), ParseDiagnostics(monitor.diagnosticSampleLimit()));
+    std::vector<std::exception_ptr> chunkErrors(chunks.size());
+    runInParallel(chunks.size(), [&](std::size_t i) {
+        try {
+            parseChunk(chunks[i], firstLineNumbers[i], chunkEvents[i], chunkDiagnostics[i], monitor);
+        } catch (...) {
+            chunkErrors[i] = std::current_exception();
+        }
+    });
+    // Stitch the chunks back together in file order. On a bad line the events before
+    // it (the earlier chunks and the start of the failing one) stay loaded, as they
+    // would after a serial parse
+    for (std::size_t i = 0; i < chunks.size(); ++i) {
+        diagnostics.append(chunkDiagnostics[i]);
+        allEvents.append(chunkEvents[i]);
+        chunkEvents[i] = EventStore(); // Release each chunk as soon as it has been copied
+        if (chunkErrors[i]) {
+            std::rethrow_exception(chunkErrors[i]);
+        }
+    }
+}
+
+int HighlightWizard::parseChunk(std::string_view chunk, int firstLineNumber, EventStore& events,
+                                ParseDiagnostics& diagnostics, LoadMonitor& monitor) {
+    // Walk the chunk line by line; every line is a view into the mapped buffer,
+    // so nothing is copied until a description is packed into the store's arena.
+    // The lines and their first two commas are found a window of lines at a time,
+    // in one vectorised pass (see delimiterScan.h).
+    std::vector<LineDelimiters> lines;
+    lines.reserve(scanWindowLines);
+    std::size_t nextLine = 0;
+    std::size_t scanned = 0;
+    std::size_t position = 0;
+    int lineNumber = firstLineNumber - 1;
+    std::size_t reportedPosition = 0;
+    std::size_t reportedEvents = events.size();
+    std::size_t linesUntilReport = progressLineInterval;
+
+    // Instrumentation: every parseSampleInterval-th line is timed stage by stage.
+    // The counters reach the stats however the chunk ends (done, bad line, cancelled).
+    struct ChunkCounters {
+        LoadMonitor& monitor;
+        const EventStore& events;
+        const std::size_t firstEvent;
+        const int& lineNumber;
+        const int firstLineNumber;
+        LineSample sample;
+        std::size_t linesUntilSample;
+
+        ~ChunkCounters() {
+            if constexpr (instrumentationEnabled) {
+                currentLineSample = nullptr;
+                const std::uint64_t parsedLines = events.size() - firstEvent;
+                monitor.addChunkStats(static_cast<std::uint64_t>(lineNumber - firstLineNumber + 1), parsedLines, sample);
+            }
+        }
+    } counters{monitor, events, events.size(), lineNumber, firstLineNumber, LineSample(), parseSampleInterval};
+    const bool lenient = monitor.isLenient();
+
+    while (position < chunk.size()) {
+        if (--linesUntilReport == 0) {
+            monitor.update(position - reportedPosition, events.size() - reportedEvents);
+            reportedPosition = position;
+            reportedEvents = events.size();
+            linesUntilReport = progressLineInterval;
+        }
+        if constexpr (instrumentationEnabled) {
+            currentLineSample = nullptr;
+            if (--counters.linesUntilSample == 0) {
+                currentLineSample = &counters.sample;
+                counters.sample.lines += 1;
+                counters.sample.lastLap = std::chrono::steady_clock::now();
+                counters.linesUntilSample = parseSampleInterval;
+            }
+        }
 
-    std::string line;
-    int lineNumber = 0;
-    while (std::getline(inputFile, line)) {
+        if (nextLine == lines.size()) {
+            scanned = scanLines(chunk, scanned, scanWindowLines, lines); // Never empty: position < size
+            nextLine = 0;
+        }
+        const LineDelimiters& delimiters = lines[nextLine++];
+        const std::string_view line = chunk.substr(delimiters.begin, delimiters.end - delimiters.begin);
+        position = delimiters.end + 1; // Past the size for a last line without a trailing newline
         lineNumber++;
+
         // Skip empty lines or potential comment lines (e.g., starting with '#')
         if (line.empty() || line[0] == '#') {
             continue;
         }
 
+        lapLineSample(PipelineStage::LINE_SPLIT);
+
+        // Status codes up to here: only a strict parse of a bad line throws
+        EventView event;
+        const ParseIssue issue = parseEventFields(line, offsetInLine(delimiters.firstComma, delimiters.begin),
+                                                  offsetInLine(delimiters.secondComma, delimiters.begin), event);
+        if (issue != ParseIssue::NONE && !handleParseIssue(issue, line, lineNumber, lenient, diagnostics)) {
+            continue; // Skipped (lenient)
+        }
         try {
-            allEvents.push_back(parseEventLine(line, lineNumber));
-        } catch (const ParseException& e) {
-            // Propagate the specific parse error
-            inputFile.close(); // Ensure file is closed before throwing
-            throw ParseException(std::string(e.what()) + " in file " + filename);
+            events.push_back(event);
+            lapLineSample(PipelineStage::STORE);
         } catch (const std::exception& e) {
-            // Catch other potential errors during parsing (e.g., std::stoi)
-             inputFile.close();
-             throw ParseException("Error parsing line " + std::to_string(lineNumber) + ": " + e.what() + " in file " + filename);
+            // Catch any other unexpected error while parsing
+            throw ParseException("Error parsing line " + std::to_string(lineNumber) + ": " + e.what());
         }
     }
+    monitor.update(chunk.size() - reportedPosition, events.size() - reportedEvents);
+    return lineNumber + 1;
+}
 
-    inputFile.close();
-    return true;
+void HighlightWizard::parseCompressedLog(const std::string& filename, LogCompression compression,
+                                         ParseDiagnostics& diagnostics, LoadMonitor& monitor) {
+    // Throws std::runtime_error if the file cannot be opened or the format is not supported
+    DecompressingReader reader(filename, compression);
+    monitor.trackInputPosition([&reader] { return reader.compressedBytesRead(); });
+
+    // The complete lines of a block are parsed in place; the line a block ends in
+    // is copied to partialLine and finished with the start of the next block
+    std::string partialLine;
+    int lineNumber = 1;
+    for (std::string_view block = reader.next(); !block.empty(); block = reader.next()) {
+        const std::size_t lastNewline = block.rfind('\n');
+        if (lastNewline == std::string_view::npos) {
+            partialLine.append(block);
+            continue;
+        }
+        std::string_view lines = block.substr(0, lastNewline + 1);
+        if (!partialLine.empty()) {
+            const std::size_t firstNewline = lines.find('\n');
+            partialLine.append(lines.substr(0, firstNewline + 1));
+            lineNumber = parseChunk(partialLine, lineNumber, allEvents, diagnostics, monitor);
+            lines.remove_prefix(firstNewline + 1);
+        }
+        lineNumber = parseChunk(lines, lineNumber, allEvents, diagnostics, monitor);
+        partialLine.assign(block.substr(lastNewline + 1));
+    }
+    parseChunk(partialLine, lineNumber, allEvents, diagnostics, monitor); // Last line without a trailing newline
+}
+
+void HighlightWizard::mergeFeeds(std::vector<MergeFeed>& feeds, LoadMonitor& monitor) {
+    const bool lenient = loadOptions.lenient;
+    DuplicateFilter duplicates(loadOptions.feedMerge.duplicateToleranceMinutes);
+    const bool deduplicate = duplicates.enabled();
+    // Reads the feed up to its next event and buffers it; false at the end of the feed
+    const auto readEvent = [this, lenient, deduplicate](MergeFeed& feed) {
+        std::string_view line;
+        try {
+            while (feed.reader.next(line)) {
+                if (line.empty() || line[0] == '#') {
+                    continue;
+                }
+                EventView event;
+                const ParseIssue issue = parseEventLine(line, event);
+                if (issue != ParseIssue::NONE &&
+                    !handleParseIssue(issue, line, feed.reader.lineNumber(), lenient, feed.diagnostics)) {
+                    continue; // Skipped (lenient)
+                }
+                feed.pending.push(event, deduplicate ? DuplicateFilter::keyOf(event) : 0);
+                feedMergeStats.eventsRead += 1;
+                return true;
+            }
+        } catch (const ParseException& e) {
+            throw ParseException(std::string(e.what()) + " in file " + feed.filename);
+        }
+        feed.ended = true;
+        return false;
+    };
+
+    // Every feed starts with a full reorder buffer; the heap holds the minute of the
+    // earliest buffered event of every feed that has one (ties: the feed listed first)
+    using FeedHead = std::pair<int, std::size_t>;
+    std::priority_queue<FeedHead, std::vector<FeedHead>, std::greater<FeedHead>> heads;
+    for (std::size_t i = 0; i < feeds.size(); ++i) {
+        while (!feeds[i].pending.full() && readEvent(feeds[i])) {
+        }
+        if (!feeds[i].pending.empty()) {
+            heads.emplace(feeds[i].pending.top().timestampMinutes, i);
+        }
+    }
+
+    int lastMinute = std::numeric_limits<int>::min();
+    std::size_t reportedEvents = 0;
+    std::size_t eventsUntilReport = progressLineInterval;
+    while (!heads.empty()) {
+        const std::size_t i = heads.top().second;
+        heads.pop();
+        MergeFeed& feed = feeds[i];
+
+        const EventView event = feed.pending.top();
+        if (event.timestampMinutes < lastMinute) {
+            feedMergeStats.lateEvents += 1;
+        } else {
+            lastMinute = event.timestampMinutes;
+        }
+        if (duplicates.isDuplicate(event, feed.pending.topDuplicateKey(), i)) {
+            feedMergeStats.duplicatesDropped += 1;
+        } else {
+            allEvents.push_back(event);
+        }
+        feed.pending.pop();
+
+        if (!feed.ended) {
+            readEvent(feed);
+        }
+        if (!feed.pending.empty()) {
+            heads.emplace(feed.pending.top().timestampMinutes, i);
+        }
+        if (--eventsUntilReport == 0) {
+            monitor.update(0, allEvents.size() - reportedEvents);
+            reportedEvents = allEvents.size();
+            eventsUntilReport = progressLineInterval;
+        }
+    }
+    monitor.update(0, allEvents.size() - reportedEvents);
+}
+
+// --- Incremental (Live Tail) Loading ---
+
+void HighlightWizard::setHighlightCallback(HighlightCallback callback) {
+    highlightCallback = std::move(callback);
+}
+
+void HighlightWizard::startLiveTail(const std::string& filename) {
+    allEvents.clear();
+    highlightIndices.clear();
+    timeIndex.clear();
+    descriptionIndex.clear();
+    liveMatcher.reset();
+    parseDiagnostics = ParseDiagnostics(loadOptions.diagnosticSampleLimit);
+    liveTail = LiveTailState();
+    liveTail.filename = filename;
 }
 
-GameEvent HighlightWizard::parseEventLine(const std::string& line, int lineNumber) {
-    std::stringstream ss(line);
-    std::string segment;
-    std::vector<std::string> parts;
+std::size_t HighlightWizard::pollLiveTail() {
+    if (liveTail.filename.empty()) {
+        throw std::runtime_error("pollLiveTail called without startLiveTail");
+    }
 
-    while (std::getline(ss, segment, ',')) { // Assuming CSV format
-        parts.push_back(segment);
+    std::error_code error;
+    const std::uintmax_t fileSize = std::filesystem::file_size(liveTail.filename, error);
+    if (error) {
+        throw std::runtime_error("Could not open file: " + liveTail.filename);
+    }
+    if (fileSize < liveTail.fileOffset) {
+        // The log was truncated or replaced: start over from its first byte
+        startLiveTail(std::string(liveTail.filename));
+    }
+    if (fileSize == liveTail.fileOffset) {
+        // Nothing appended since the last poll; only the lines after a bad one may still wait
+        if (liveTail.pendingData.find('\n') == std::string::npos) {
+            return 0;
+        }
+        try {
+            return appendEventData({});
+        } catch (const ParseException& e) {
+            throw ParseException(std::string(e.what()) + " in file " + liveTail.filename);
+        }
     }
 
-    if (parts.size() < 3) {
-        throw ParseException("Error parsing line " + std::to_string(lineNumber) + ": Expected at least 3 comma-separated values, found " + std::to_string(parts.size()) + ". Line: '" + line + "'");
+    std::ifstream inputFile(liveTail.filename, std::ios::binary);
+    if (!inputFile.is_open()) {
+        throw std::runtime_error("Could not open file: " + liveTail.filename);
     }
+    inputFile.seekg(static_cast<std::streamoff>(liveTail.fileOffset));
 
-    GameEvent event;
-    try {
-        // Part 0: Timestamp
-        event.timestampMinutes = std::stoi(parts[0]);
-        if (event.timestampMinutes < 0) {
-             throw std::out_of_range("Timestamp cannot be negative.");
+    // The appended bytes are parsed a block at a time, so the first poll of a large
+    // log (or of a log that jumped in size) takes one block of memory, not the whole
+    // range; a line split between two blocks waits in pendingData like one split
+    // between two polls. After a bad line the offset is past the blocks read so far
+    // only, and the next poll goes on from there.
+    std::size_t newEvents = 0;
+    while (liveTail.fileOffset < fileSize) {
+        liveTail.readBuffer.resize(static_cast<std::size_t>(
+            std::min<std::uintmax_t>(fileSize - liveTail.fileOffset, liveTailBlockBytes)));
+        inputFile.read(liveTail.readBuffer.data(), static_cast<std::streamsize>(liveTail.readBuffer.size()));
+        liveTail.readBuffer.resize(static_cast<std::size_t>(inputFile.gcount()));
+        if (liveTail.readBuffer.empty()) {
+            break; // The file shrank while being read: the next poll starts over
         }
+        liveTail.fileOffset += liveTail.readBuffer.size();
+        try {
+            newEvents += appendEventData(liveTail.readBuffer);
+        } catch (const ParseException& e) {
+            throw ParseException(std::string(e.what()) + " in file " + liveTail.filename);
+        }
+    }
+    return newEvents;
+}
 
-        // Part 1: Event Type
-        event.type = GameEvent::stringToType(parts[1]);
-         if(event.type == EventType::UNKNOWN) {
-             std::cerr << "Warning line " << lineNumber << ": Unknown event type '" << parts[1] << "'. Treating as OTHER." << std::endl;
-             // Optionally treat unknown as OTHER or throw an error depending on strictness
-              event.type = EventType::OTHER;
-         }
+std::size_t HighlightWizard::appendEventData(std::string_view data) {
+    ScopedStage stage(pipelineStats, PipelineStage::LIVE_TAIL);
+    stage.addBytes(data.size());
+    ParseDiagnostics diagnostics(loadOptions.diagnosticSampleLimit);
 
+    // Bytes left over from the previous call (a partial line) come first
+    std::string_view input = data;
+    if (!liveTail.pendingData.empty()) {
+        liveTail.pendingData.append(data.data(), data.size());
+        input = liveTail.pendingData;
+    }
 
-        // Part 2: Description (remainder of the line, could contain commas)
-        // Reconstruct description if it contained commas
-        event.description = parts[2];
-        for(size_t i = 3; i < parts.size(); ++i) {
-            event.description += "," + parts[i];
+    const std::size_t firstNewEvent = allEvents.size();
+    std::size_t consumed = 0;
+    try {
+        std::size_t lineEnd;
+        while ((lineEnd = input.find('\n', consumed)) != std::string_view::npos) {
+            const std::string_view line = input.substr(consumed, lineEnd - consumed);
+            consumed = lineEnd + 1; // A bad line is consumed too, the next call resumes after it
+            appendEventLine(line, diagnostics);
+        }
+    } catch (...) {
+        keepUnparsedData(input, consumed);
+        stage.addItems(classifyNewEvents(firstNewEvent));
+        if constexpr (instrumentationEnabled) {
+            pipelineStats.errors += 1;
         }
-        // Trim leading/trailing whitespace from description (optional but good)
-         size_t first = event.description.find_first_not_of(' ');
-         if (std::string::npos == first) {
-             event.description = ""; // Handle empty or all-whitespace description
-         } else {
-             size_t last = event.description.find_last_not_of(' ');
-             event.description = event.description.substr(first, (last - first + 1));
-         }
+        adoptParseDiagnostics(diagnostics, liveTail.filename);
+        throw;
+    }
 
+    // Whatever follows the last newline is a line still being written
+    keepUnparsedData(input, consumed);
+    const std::size_t newEvents = classifyNewEvents(firstNewEvent);
+    stage.addItems(newEvents);
+    adoptParseDiagnostics(diagnostics, liveTail.filename);
+    return newEvents;
+}
 
-    } catch (const std::invalid_argument& ia) {
-        throw ParseException("Error parsing line " + std::to_string(lineNumber) + ": Invalid number format for timestamp. Value: '" + parts[0] + "'");
-    } catch (const std::out_of_range& oor) {
-        throw ParseException("Error parsing line " + std::to_string(lineNumber) + ": Timestamp number out of range. Value: '" + parts[0] + "'");
+std::size_t HighlightWizard::finishEventData() {
+    const std::size_t firstNewEvent = allEvents.size();
+    std::string lastLine;
+    lastLine.swap(liveTail.pendingData);
+    ParseDiagnostics diagnostics(loadOptions.diagnosticSampleLimit);
+    try {
+        if (!lastLine.empty()) {
+            appendEventLine(lastLine, diagnostics); // The final line had no trailing newline
+        }
+    } catch (...) {
+        classifyNewEvents(firstNewEvent);
+        adoptParseDiagnostics(diagnostics, liveTail.filename);
+        throw;
     }
+    adoptParseDiagnostics(diagnostics, liveTail.filename);
+    return classifyNewEvents(firstNewEvent);
+}
 
+void HighlightWizard::appendEventLine(std::string_view line, ParseDiagnostics& diagnostics) {
+    const int lineNumber = ++liveTail.lineNumber;
+    if constexpr (instrumentationEnabled) {
+        pipelineStats.lines += 1;
+    }
+    // Skip empty lines or potential comment lines (e.g., starting with '#')
+    if (line.empty() || line[0] == '#') {
+        return;
+    }
+    EventView event;
+    const ParseIssue issue = parseEventLine(line, event);
+    if (issue != ParseIssue::NONE && !handleParseIssue(issue, line, lineNumber, loadOptions.lenient, diagnostics)) {
+        return; // Skipped (lenient)
+    }
+    allEvents.push_back(event);
+    if constexpr (instrumentationEnabled) {
+        pipelineStats.events += 1;
+    }
+}
+
+void HighlightWizard::keepUnparsedData(std::string_view input, std::size_t consumed) {
+    if (!liveTail.pendingData.empty() && input.data() == liveTail.pendingData.data()) {
+        liveTail.pendingData.erase(0, consumed); // input aliases the pending buffer
+    } else {
+        liveTail.pendingData.assign(input.data() + consumed, input.size() - consumed);
+    }
+}
+
+std::size_t HighlightWizard::classifyNewEvents(std::size_t firstNewEvent) {
+    timeIndex.extend(allEvents);
+    if (loadOptions.indexDescriptions) {
+        descriptionIndex.extend(allEvents);
+    }
+
+    // Only the appended events are looked at, never the whole match again; the
+    // matcher keeps the window state of the rules between appends
+    for (std::size_t i = firstNewEvent; i < allEvents.size(); ++i) {
+        if (liveMatcher.feed(allEvents.timestampAt(i), allEvents.typeAt(i))) {
+            highlightIndices.push_back(static_cast<std::uint32_t>(i));
+            if (highlightCallback) {
+                highlightCallback(allEvents[i]);
+            }
+        }
+    }
+    return allEvents.size() - firstNewEvent;
+}
+
+EventView HighlightWizard::parseEventLine(std::string_view line, int lineNumber) {
+    EventView event;
+    const ParseIssue issue = parseEventLine(line, event);
+    if (isParseError(issue)) {
+        throw ParseException(describeParseIssue(issue, line, lineNumber));
+    }
+    if (issue == ParseIssue::UNKNOWN_TYPE) {
+        writeWarning(describeParseIssue(issue, line, lineNumber));
+    }
     return event;
 }
 
-bool HighlightWizard::isHighlight(const GameEvent& event) const {
-    // Define which event types are considered highlights
-    switch (event.type) {
-        case EventType::GOAL:
-        case EventType::RED_CARD:
-        // Potentially add others later, e.g.:
-        // case EventType::PENALTY_SCORED:
-        // case EventType::GREAT_SAVE: // (Would require more complex input/logic)
-            return true;
-        default:
-            return false;
+ParseIssue HighlightWizard::parseEventLine(std::string_view line, EventView& event) {
+    // Locate the first two commas
+    const std::size_t firstComma = line.find(',');
+    const std::size_t secondComma = (firstComma == std::string_view::npos)
+                                        ? std::string_view::npos
+                                        : line.find(',', firstComma + 1);
+    return parseEventFields(line, firstComma, secondComma, event);
+}
+
+ParseIssue HighlightWizard::parseEventFields(std::string_view line, std::size_t firstComma, std::size_t secondComma,
+                                             EventView& event) {
+    // The fields are counted the way splitting with std::getline(ss, part, ',')
+    // counted them: a single trailing comma does not start another (empty) field,
+    // so "12,GOAL," has only two.
+    if (secondComma == std::string_view::npos || secondComma == line.size() - 1) {
+        return ParseIssue::TOO_FEW_FIELDS;
     }
+
+    const std::string_view timestampField = line.substr(0, firstComma);
+    const std::string_view typeField = line.substr(firstComma + 1, secondComma - firstComma - 1);
+    // Description is the remainder of the line and may contain commas
+    std::string_view descriptionField = line.substr(secondComma + 1);
+    if (descriptionField.back() == ',') {
+        descriptionField.remove_suffix(1); // Dropped by the field split, see above
+    }
+
+    lapLineSample(PipelineStage::LINE_SPLIT); // Instrumentation: only lines picked for sampling are timed
+
+    // Part 0: Timestamp
+    switch (parseTimestamp(timestampField, event.timestampMinutes)) {
+        case TimestampStatus::Ok:
+            break;
+        case TimestampStatus::InvalidFormat:
+            return ParseIssue::INVALID_TIMESTAMP;
+        case TimestampStatus::OutOfRange:
+            return ParseIssue::TIMESTAMP_OUT_OF_RANGE;
+    }
+
+    lapLineSample(PipelineStage::TIMESTAMP);
+
+    // Part 1: Event Type
+    ParseIssue issue = ParseIssue::NONE;
+    event.type = GameEvent::stringToType(typeField);
+    if (event.type == EventType::UNKNOWN) {
+        // Unknown types are kept as OTHER, with a warning
+        event.type = EventType::OTHER;
+        issue = ParseIssue::UNKNOWN_TYPE;
+    }
+
+    lapLineSample(PipelineStage::TYPE_LOOKUP);
+
+    // Part 2: Description, trimmed of leading/trailing spaces
+    event.description = std::string_view();
+    const std::size_t first = descriptionField.find_first_not_of(' ');
+    if (first != std::string_view::npos) {
+        const std::size_t last = descriptionField.find_last_not_of(' ');
+        event.description = descriptionField.substr(first, last - first + 1);
+    }
+    lapLineSample(PipelineStage::LINE_SPLIT);
+
+    return issue;
+}
+
+void HighlightWizard::setHighlightRules(const HighlightRuleSet& rules) {
+    highlightRules = rules;
+    liveMatcher = HighlightRuleMatcher(highlightRules);
+}
+
+void HighlightWizard::loadHighlightRules(const std::string& filename) {
+    setHighlightRules(HighlightRuleSet::fromFile(filename));
+}
+
+const HighlightRuleSet& HighlightWizard::getHighlightRules() const {
+    return highlightRules;
 }
 
 void HighlightWizard::findHighlights() {
-    highlightEvents.clear(); // Ensure we start fresh
-    for (const auto& event : allEvents) {
-        if (isHighlight(event)) {
-            highlightEvents.push_back(event);
+    adoptHighlights(computeHighlights());
+}
+
+void HighlightWizard::adoptHighlights(ComputedHighlights&& highlights) {
+    highlightIndices = std::move(highlights.rows);
+    pipelineStats.merge(highlights.stats);
+}
+
+HighlightWizard::ComputedHighlights HighlightWizard::computeHighlights() const {
+    ComputedHighlights result;
+    {
+        ScopedStage stage(result.stats, PipelineStage::CLASSIFY);
+        stage.addItems(allEvents.size());
+        result.rows = classifyEvents();
+    }
+    return result;
+}
+
+std::vector<std::uint32_t> HighlightWizard::classifyEvents() const {
+    std::vector<std::uint32_t> highlights;
+    const ColumnView<EventType> types = allEvents.types();
+
+    if (!highlightRules.hasWindowedRules()) {
+        // Every rule looks at one event, so the rule table reduces to one flag per type:
+        // scan the type column in file order, descriptions stay out of the cache and a
+        // highlight is recorded as its row index
+        for (std::size_t i = 0; i < types.size(); ++i) {
+            if (highlightRules.isSingleEventHighlight(types[i])) {
+                highlights.push_back(static_cast<std::uint32_t>(i));
+            }
         }
+        return highlights;
     }
-    // Optional: Sort highlights by timestamp if loading order wasn't guaranteed
-    // std::sort(highlightEvents.begin(), highlightEvents.end(),
-    //           [](const GameEvent& a, const GameEvent& b) {
-    //               return a.timestampMinutes < b.timestampMinutes;
-    //           });
+
+    // Windows are defined on match minutes, so feed the rows in time order, then
+    // report the highlights in file order like the single-event rules do
+    HighlightRuleMatcher matcher(highlightRules);
+    const ColumnView<int> timestamps = allEvents.timestamps();
+    for (std::uint32_t row : timeIndex.rowsInTimeOrder()) {
+        if (matcher.feed(timestamps[row], types[row])) {
+            highlights.push_back(row);
+        }
+    }
+    std::sort(highlights.begin(), highlights.end());
+    return highlights;
+}
+
+void HighlightWizard::setHighlightScoring(const HighlightScoring& scoring) {
+    highlightScoring = scoring;
+}
+
+const HighlightScoring& HighlightWizard::getHighlightScoring() const {
+    return highlightScoring;
+}
+
+std::vector<ScoredHighlight> HighlightWizard::scoreHighlights() const {
+    ScopedStage stage(pipelineStats, PipelineStage::SCORE);
+    stage.addItems(highlightIndices.size());
+    return ::scoreHighlights(allEvents, timeIndex, highlightIndices, highlightScoring);
 }
 
-const std::vector<GameEvent>& HighlightWizard::getHighlights() const {
-    return highlightEvents;
+HighlightReel HighlightWizard::selectHighlightReel(int budgetSeconds) const {
+    ScopedStage stage(pipelineStats, PipelineStage::SCORE);
+    stage.addItems(highlightIndices.size());
+    return ::selectHighlightReel(::scoreHighlights(allEvents, timeIndex, highlightIndices, highlightScoring),
+                                 budgetSeconds);
 }
 
-const std::vector<GameEvent>& HighlightWizard::getAllEvents() const {
-    return allEvents;}
+void HighlightWizard::printHighlightReel(std::ostream& out, const HighlightReel& reel) const {
+    ScopedStage stage(pipelineStats, PipelineStage::REPORT);
+    stage.addItems(reel.clips.size());
+    if (reel.clips.empty()) {
+        out << "No highlights fit in a " << reel.budgetSeconds << " s reel.\n";
+        return;
+    }
+
+    out << "\n--- Highlight Reel (" << reel.totalSeconds << " of " << reel.budgetSeconds << " s) ---\n";
+    for (const ScoredHighlight& clip : reel.clips) {
+        const EventView event = allEvents[clip.row];
+        out << "[" << event.timestampMinutes << "'] "
+            << GameEvent::typeToString(event.type) << ": "
+            << event.description << " (" << clip.clipSeconds << " s, weight " << clip.weight << ")\n";
+    }
+    out << "-------------------------\n";
+}
+
+EventIndexView HighlightWizard::getHighlights() const {
+    return EventIndexView(allEvents, highlightIndices);
+}
+
+const std::vector<std::uint32_t>& HighlightWizard::getHighlightIndices() const {
+    return highlightIndices;
+}
+
+EventIndexView HighlightWizard::getEventsBetween(int startMinute, int endMinute) const {
+    return timeIndex.eventsBetween(allEvents, startMinute, endMinute);
+}
+
+std::vector<TimeWindow> HighlightWizard::getHighlightWindows(int minutesBefore, int minutesAfter) const {
+    std::vector<TimeWindow> windows;
+    windows.reserve(highlightIndices.size());
+    for (std::uint32_t row : highlightIndices) {
+        const int minute = allEvents.timestampAt(row);
+        windows.push_back(TimeWindow{std::max(0, minute - minutesBefore), minute + minutesAfter});
+    }
+    return windows;
+}
+
+std::vector<TimeWindow> HighlightWizard::getMergedHighlightWindows(int minutesBefore, int minutesAfter) const {
+    return mergeTimeWindows(getHighlightWindows(minutesBefore, minutesAfter));
+}
+
+const EventStore& HighlightWizard::getAllEvents() const {
+    return allEvents;
+}
 
 void HighlightWizard::printHighlights() const {
-    if (highlightEvents.empty()) {
-        std::cout << "No highlights found in the loaded events." << std::endl;
+    printHighlights(std::cout);
+}
+
+void HighlightWizard::printHighlights(std::ostream& out) const {
+    ScopedStage stage(pipelineStats, PipelineStage::REPORT);
+    stage.addItems(highlightIndices.size());
+    if (highlightIndices.empty()) {
+        out << "No highlights found in the loaded events.\n";
         return;
     }
 
-    std::cout << "\n--- Football Highlights ---" << std::endl;
-    for (const auto& event : highlightEvents) {
-        std::cout << "[" << event.timestampMinutes << "'] "
-                  << GameEvent::typeToString(event.type) << ": "
-                  << event.description << std::endl;
+    // No flush per line: the stream writes whenever its buffer fills
+    out << "\n--- Football Highlights ---\n";
+    for (const EventView event : getHighlights()) {
+        out << "[" << event.timestampMinutes << "'] "
+            << GameEvent::typeToString(event.type) << ": "
+            << event.description << '\n';
     }
-    std::cout << "-------------------------" << std::endl;
+    out << "-------------------------\n";
+}
+
+std::uint64_t HighlightWizard::exportEvents(std::ostream& out, ExportFormat format) const {
+    ScopedStage stage(pipelineStats, PipelineStage::REPORT);
+    stage.addItems(allEvents.size());
+    const std::uint64_t bytes = ::exportEvents(out, allEvents, format);
+    stage.addBytes(bytes);
+    return bytes;
+}
+
+std::uint64_t HighlightWizard::exportHighlights(std::ostream& out, ExportFormat format) const {
+    ScopedStage stage(pipelineStats, PipelineStage::REPORT);
+    stage.addItems(highlightIndices.size());
+    const std::uint64_t bytes = ::exportEvents(out, getHighlights(), format);
+    stage.addBytes(bytes);
+    return bytes;
 }
\ No newline at end of file
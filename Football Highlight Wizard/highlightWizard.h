@@ -3,76 +3,327 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <stdexcept> // For exceptions
+#include <iosfwd>    // For std::ostream
+#include <functional>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include "gameEvent.h"
+#include "eventStore.h"
+#include "timeIndex.h"
+#include "highlightRules.h"
+#include "pipelineStats.h"
+#include "parseDiagnostics.h"
+#include "descriptionIndex.h"
+#include "eventCache.h"
+#include "compressedLog.h"
+#include "feedMerge.h"
+#include "highlightReel.h"
+#include "eventExport.h"
 
-// Enum to represent different types of game events
-enum class EventType {
-    GOAL,
-    YELLOW_CARD,
-    RED_CARD,
-    FOUL,
-    SUBSTITUTION,
-    GAME_START,
-    HALF_TIME,
-    FULL_TIME,
-    OTHER, // For events not explicitly handled
-    UNKNOWN // For parsing errors
+// How far a loadEventsFromFile call has got
+struct LoadProgress {
+    std::uint64_t bytesParsed = 0;
+    std::uint64_t totalBytes = 0;   // Size of the file (compressed size for a .gz/.zst log)
+    std::size_t eventsParsed = 0;
 };
 
-// Struct to hold information about a single game event
-struct GameEvent {
-    int timestampMinutes = -1;
-    EventType type = EventType::UNKNOWN;
-    std::string description;
+// Options that control how HighlightWizard::loadEventsFromFile reads a log
+struct LoadOptions {
+    // Number of parser threads. 1 parses serially, 0 uses one thread per hardware core.
+    // Large files are split at newline boundaries into one chunk per thread; the
+    // resulting events and error line numbers are identical to a serial parse.
+    // A compressed log is decompressed on one thread and parsed on another instead.
+    unsigned threadCount = 1;
 
-    // Optional: Add player, team info later if needed
-    // std::string player;
-    // std::string team;
+    // Called every few megabytes from the parsing thread (one call at a time, also
+    // with several parser threads) and once more when the whole file is parsed
+    std::function<void(const LoadProgress& progress)> progressCallback;
 
-    // Helper to convert EventType to string for printing
-    static std::string typeToString(EventType t);
-    // Helper to convert string to EventType for parsing
-    static EventType stringToType(const std::string& s);
+    // Polled as often as progress is reported; once it is true the load stops and
+    // throws LoadCancelled. The flag must outlive the load.
+    const std::atomic<bool>* cancelFlag = nullptr;
+
+    // What a malformed line does (also to live tail appends). Strict: the load stops with
+    // a ParseException naming the first one. Lenient: the line is skipped and recorded in
+    // getParseDiagnostics(), and the load goes on.
+    bool lenient = false;
+    // Issues kept with their message in getParseDiagnostics(); all are still counted
+    std::size_t diagnosticSampleLimit = ParseDiagnostics::defaultSampleLimit;
+    // Write the diagnostics to stderr in one batch once a load (or append) is over,
+    // instead of one write per line while parsing
+    bool reportDiagnostics = true;
+
+    // Build the description index (see searchDescriptions) as part of every load, and
+    // keep it up to date during a live tail
+    bool indexDescriptions = false;
+
+    // Keep the parsed events in a binary cache ("<log>.hwc", see eventCache.h) and,
+    // while the log is unchanged, map that cache instead of parsing the log. Only logs
+    // that parse without any warning or error are cached.
+    bool useEventCache = false;
+    // Where the cache files go; empty: next to each log
+    std::string eventCacheDirectory;
+
+    // How loadEventsFromFiles merges several feeds of one match
+    FeedMergeOptions feedMerge;
 };
 
-// Exception class for file parsing errors
-class ParseException : public std::runtime_error {
+// Thrown by loadEventsFromFile when LoadOptions::cancelFlag was raised
+// The wizard is left without events, as after a failed load
+class LoadCancelled : public std::runtime_error {
 public:
-    ParseException(const std::string& message) : std::runtime_error(message) {}
+    explicit LoadCancelled(const std::string& message) : std::runtime_error(message) {}
 };
 
-
 // The main class responsible for processing events and finding highlights
 class HighlightWizard {
 public:
     HighlightWizard() = default; // Use default constructor
 
     // Loads events from a specified file
-    // Throws std::runtime_error if file cannot be opened
-    // Throws ParseException if a line has incorrect format
+    // The file is memory-mapped and tokenized in place, without a copy per line.
+    // A gzip or zstd compressed log (recognised by its content) is decompressed in
+    // blocks while it is parsed, so it never has to be unpacked on disk or in memory.
+    // Throws std::runtime_error if file cannot be opened, or is compressed and damaged,
+    // truncated or in a format this build cannot read
+    // Throws ParseException if a line has incorrect format (unless LoadOptions::lenient)
+    // Throws LoadCancelled if the load was cancelled (see LoadOptions)
     bool loadEventsFromFile(const std::string& filename);
 
+    // Loads one match reported by several feeds (e.g. one log per data provider,
+    // plain or compressed) as a single event list, in minute order: the feeds are
+    // streamed through a k-way merge, and an event that an earlier feed already
+    // reported (same type and description key, within
+    // LoadOptions::feedMerge.duplicateToleranceMinutes) is dropped. Of duplicates the
+    // earliest is kept; on the same minute, the one of the feed listed first. Each feed
+    // only buffers LoadOptions::feedMerge.reorderWindow events, so memory does not grow
+    // with the number or size of the feeds (beyond the merged events themselves).
+    // One file loads exactly like loadEventsFromFile. The event cache and parser
+    // threads are not used for several.
+    // Throws like loadEventsFromFile; a ParseException names the feed's file
+    bool loadEventsFromFiles(const std::vector<std::string>& filenames);
+    // Feeds, events read, duplicates dropped and late events of the last multi-feed load
+    const FeedMergeStats& getFeedMergeStats() const;
+
+    // Unknown event types (and, in lenient mode, skipped lines) of the last load or
+    // live tail, up to the line that stopped a strict load
+    const ParseDiagnostics& getParseDiagnostics() const;
+
+    // Options used by subsequent calls to loadEventsFromFile
+    void setLoadOptions(const LoadOptions& options);
+    const LoadOptions& getLoadOptions() const;
+
+    // --- Live tail: incremental loading of a log that is still being written ---
+    // Called for every highlight found while appending events (see pollLiveTail)
+    // The view is only valid during the call
+    using HighlightCallback = std::function<void(const EventView& highlight)>;
+    void setHighlightCallback(HighlightCallback callback);
+
+    // Clears the loaded events and starts following filename from its first byte
+    void startLiveTail(const std::string& filename);
+
+    // Reads only the bytes appended to the followed file since the last poll, parses the
+    // complete lines among them and classifies just those new events; a partial last line
+    // is kept until its newline arrives. Returns the number of new events.
+    // Poll it as often as the required latency demands: the cost is O(appended bytes),
+    // read in blocks of 1 MiB, so the memory it takes does not grow with them.
+    // Restarts from the beginning if the file shrank (truncated or rotated).
+    // Throws ParseException for a malformed line (unless LoadOptions::lenient); that
+    // line is skipped by the next poll
+    std::size_t pollLiveTail();
+
+    // Same incremental path for data that does not come from a file (e.g. a socket)
+    std::size_t appendEventData(std::string_view data);
+    // Parses a final line that was never terminated by a newline (end of stream)
+    std::size_t finishEventData();
+
+    // --- Highlight rules (see highlightRules.h); the defaults are every GOAL and RED_CARD ---
+    // Changing the rules does not reclassify loaded events: call findHighlights again
+    void setHighlightRules(const HighlightRuleSet& rules);
+    // Throws std::runtime_error if the file cannot be opened
+    // Throws ParseException if a rule line is malformed; the current rules are kept
+    void loadHighlightRules(const std::string& filename);
+    const HighlightRuleSet& getHighlightRules() const;
+
     // Analyzes the loaded events and identifies highlights
+    // All rules are evaluated in one pass over the events in time order (windowed
+    // rules need it), so the cost is O(n) whatever the number of rules
     void findHighlights();
 
-    // Returns a constant reference to the vector of identified highlights
-    const std::vector<GameEvent>& getHighlights() const;
+    // The two halves of findHighlights, for running the analysis on another thread:
+    // computeHighlights only reads the wizard, pipeline stats included (so it may run
+    // while another thread reads it too), and returns the highlight rows with the time
+    // it took; adoptHighlights installs the rows and records the time.
+    struct ComputedHighlights {
+        std::vector<std::uint32_t> rows;
+        PipelineStats stats; // The CLASSIFY stage of this run
+    };
+    ComputedHighlights computeHighlights() const;
+    void adoptHighlights(ComputedHighlights&& highlights);
+
+    // Returns the identified highlights as a view of rows in getAllEvents(), in file order
+    // Nothing is copied. The view (and the EventViews it yields) is invalidated by
+    // loadEventsFromFile, startLiveTail, findHighlights and live tail appends;
+    // fetch it again after any of those instead of keeping it around.
+    EventIndexView getHighlights() const;
+    // The same highlights as raw row indices into getAllEvents()
+    const std::vector<std::uint32_t>& getHighlightIndices() const;
+
+    // --- Highlight reel (see highlightReel.h) ---
+    // How scoreHighlights weighs the highlights and sizes their clips
+    void setHighlightScoring(const HighlightScoring& scoring);
+    const HighlightScoring& getHighlightScoring() const;
+    // The identified highlights (in the order of getHighlightIndices) with their weight
+    // and clip length, from their type, the match situation and the events around them
+    // Throws std::invalid_argument if the scoring has a clip length below one second
+    std::vector<ScoredHighlight> scoreHighlights() const;
+    // The heaviest highlights whose clips fit in budgetSeconds together, in time order
+    HighlightReel selectHighlightReel(int budgetSeconds) const;
+    // Writes a reel like printHighlights, with each clip's length and weight
+    void printHighlightReel(std::ostream& out, const HighlightReel& reel) const;
 
     // Prints the identified highlights to the console
     void printHighlights() const;
+    // Same report, written to any stream (e.g. a per-match output file)
+    void printHighlights(std::ostream& out) const;
 
-    // Returns a constant reference to the vector of aLL events
-    const std::vector<GameEvent>& getAllEvents() const; 
+    // Machine-readable exports (JSON Lines, CSV or binary, see eventExport.h) of all
+    // loaded events or of the identified highlights, streamed through a fixed buffer;
+    // return the bytes written
+    // Throw std::runtime_error if the stream fails
+    std::uint64_t exportEvents(std::ostream& out, ExportFormat format) const;
+    std::uint64_t exportHighlights(std::ostream& out, ExportFormat format) const;
+
+    // --- Time-range queries (backed by a timestamp index built while loading) ---
+    // Events with startMinute <= minute <= endMinute in time order, in O(log n)
+    // Invalidated like getHighlights() (reload, live tail appends)
+    EventIndexView getEventsBetween(int startMinute, int endMinute) const;
+
+    // One window per highlight (in highlight order): [minute - minutesBefore, minute + minutesAfter],
+    // never starting before minute 0. Use getEventsBetween to fetch the context of a window.
+    std::vector<TimeWindow> getHighlightWindows(int minutesBefore, int minutesAfter) const;
+
+    // The same windows sorted by time with overlapping ones merged, e.g. for a clip list
+    std::vector<TimeWindow> getMergedHighlightWindows(int minutesBefore, int minutesAfter) const;
+
+    // --- Description search (see descriptionIndex.h) ---
+    // Rows of getAllEvents() (in file order) whose description matches the query; wrap
+    // them in an EventIndexView to read the events without copying them.
+    // Uses the description index where there is one and scans the remaining rows, so
+    // it works without an index too, only slower.
+    std::vector<std::uint32_t> searchDescriptions(const DescriptionQuery& query) const;
+    // Indexes the loaded descriptions (done by every load with LoadOptions::indexDescriptions)
+    void buildDescriptionIndex();
+    // Saves the index, or loads one saved for the same events (e.g. by an earlier run)
+    // Throws std::runtime_error if the file cannot be written/read or belongs to other events
+    void saveDescriptionIndex(const std::string& filename) const;
+    void loadDescriptionIndex(const std::string& filename);
+    const DescriptionIndex& getDescriptionIndex() const;
+
+    // --- Instrumentation (see pipelineStats.h) ---
+    // Per-stage time, volume and allocations of everything this wizard did since it was
+    // created or reset: loads, live tail appends, classification and reports. All zero
+    // unless the library is built with HIGHLIGHT_WIZARD_INSTRUMENTATION.
+    const PipelineStats& getPipelineStats() const;
+    // Front ends record their own stages (e.g. GUI population) here
+    PipelineStats& getPipelineStats();
+    void resetPipelineStats();
+
+    // Parses a single line of an event log (without its newline)
+    // The returned description is a view into line (it may point into a memory-mapped buffer)
+    // Throws ParseException if the line has incorrect format; an unknown event type is
+    // written to stderr as a warning and becomes OTHER
+    static EventView parseEventLine(std::string_view line, int lineNumber);
+    // The same parse without exceptions or output, for the hot paths: returns what is
+    // wrong with the line (see describeParseIssue). event is complete unless it is an
+    // error (isParseError); an unknown type is stored as OTHER.
+    static ParseIssue parseEventLine(std::string_view line, EventView& event);
+
+    // Returns a constant reference to the store of aLL events
+    // Iterating it yields EventView rows; columns are available for faster scans
+    const EventStore& getAllEvents() const;
 
 private:
-    std::vector<GameEvent> allEvents;       // Stores all events loaded from the file
-    std::vector<GameEvent> highlightEvents; // Stores only the events identified as highlights
+    EventStore allEvents;                   // Stores all events loaded from the file
+    std::vector<std::uint32_t> highlightIndices; // Rows of allEvents identified as highlights
+    TimeIndex timeIndex;                    // allEvents ordered by minute, kept in sync while loading
+    DescriptionIndex descriptionIndex;      // Words of the descriptions, see LoadOptions::indexDescriptions
+    LoadOptions loadOptions;                // How loadEventsFromFile reads the file
+    HighlightRuleSet highlightRules = HighlightRuleSet::defaults(); // What findHighlights looks for
+    HighlightRuleMatcher liveMatcher{highlightRules}; // Window state of the live tail, fed in arrival order
+    HighlightScoring highlightScoring;      // How scoreHighlights ranks the highlights
+
+    // Where the live tail stopped reading
+    struct LiveTailState {
+        std::string filename;       // Empty when no live tail is active
+        std::uint64_t fileOffset = 0;
+        int lineNumber = 0;         // Lines consumed so far
+        std::string pendingData;    // Bytes received but not parsed yet (partial last line)
+        std::string readBuffer;     // One block of appended bytes, reused between polls
+    };
+    LiveTailState liveTail;
+    HighlightCallback highlightCallback;
+    // Bookkeeping only, so the const operations (reports, exports, cache writes) record
+    // into it too; in instrumented builds those must not run concurrently on one wizard
+    // (computeHighlights, meant for another thread, returns its time instead)
+    mutable PipelineStats pipelineStats;
+    ParseDiagnostics parseDiagnostics;
+    FeedMergeStats feedMergeStats;
+
+    // Adds the diagnostics of a load or append to parseDiagnostics (and the stats),
+    // and writes them if LoadOptions::reportDiagnostics
+    void adoptParseDiagnostics(const ParseDiagnostics& diagnostics, std::string_view source);
+
+    // The rows of the highlights among the loaded events, in file order (see computeHighlights)
+    std::vector<std::uint32_t> classifyEvents() const;
+
+    // Parses one complete line received by the live tail and appends its event
+    void appendEventLine(std::string_view line, ParseDiagnostics& diagnostics);
+    // Stores input[consumed..] as the pending data for the next append
+    void keepUnparsedData(std::string_view input, std::size_t consumed);
+    // Classifies allEvents[firstNewEvent..] and reports new highlights; returns the number of new events
+    std::size_t classifyNewEvents(std::size_t firstNewEvent);
+    // Rebuilds timeIndex (and the description index if LoadOptions::indexDescriptions) from allEvents
+    void buildIndexes();
+    // Replaces allEvents by the cached events of the log if its cache is up to date
+    bool loadEventsFromCache(const std::string& filename, const EventCacheKey& key);
+    // Caches allEvents for the log; a cache that cannot be written is skipped
+    void writeEventCacheFor(const std::string& filename, const EventCacheKey& key) const;
+
+    // Progress reporting and cancellation of one load, shared by its parser threads
+    class LoadMonitor;
+
+    // Parses a newline-aligned slice of the file; lines are numbered from firstLineNumber
+    // and their issues are recorded in diagnostics
+    // Throws ParseException (without the file name) at the first malformed line, unless lenient
+    // Throws LoadCancelled if the monitor reports a cancellation
+    // Returns the number the line after the chunk gets
+    static int parseChunk(std::string_view chunk, int firstLineNumber, EventStore& events,
+                          ParseDiagnostics& diagnostics, LoadMonitor& monitor);
+
+    // parseEventLine for a line whose first two commas are already found (npos where
+    // the line has none), e.g. by the delimiter scan of parseChunk
+    static ParseIssue parseEventFields(std::string_view line, std::size_t firstComma, std::size_t secondComma,
+                                       EventView& event);
+
+    // Parses the buffer as chunkCount chunks on separate threads and appends them to allEvents
+    // in order; diagnostics gets the issues of every chunk a serial parse would have reached
+    void parseChunksInParallel(std::string_view buffer, std::size_t chunkCount,
+                               ParseDiagnostics& diagnostics, LoadMonitor& monitor);
 
-    // Internal helper to parse a single line from the event file
-    GameEvent parseEventLine(const std::string& line, int lineNumber);
+    // One feed of a multi-feed load: its reader, reorder buffer and diagnostics
+    struct MergeFeed;
+    // Merges the feeds into allEvents (see loadEventsFromFiles) and fills feedMergeStats
+    // Throws ParseException (naming the feed's file) at the first malformed line, unless lenient
+    void mergeFeeds(std::vector<MergeFeed>& feeds, LoadMonitor& monitor);
 
-    // Internal helper to determine if a given event qualifies as a highlight
-    bool isHighlight(const GameEvent& event) const;
+    // Parses the log block by block while a DecompressingReader unpacks the next ones,
+    // appending to allEvents; line numbers are those of the decompressed text
+    void parseCompressedLog(const std::string& filename, LogCompression compression,
+                            ParseDiagnostics& diagnostics, LoadMonitor& monitor);
 };
 
 #endif // HIGHLIGHTWIZARD_H
\ No newline at end of file
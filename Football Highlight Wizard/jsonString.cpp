@@ -0,0 +1,45 @@
+#include "jsonString.h"
+
+std::size_t utf8SequenceLength(std::string_view text, std::size_t i) {
+    const auto byte = [&](std::size_t at) { return static_cast<unsigned char>(text[at]); };
+    const unsigned char lead = byte(i);
+    std::size_t length;
+    // The range of the second byte excludes overlong forms, surrogates and code points past U+10FFFF
+    unsigned char secondMin = 0x80;
+    unsigned char secondMax = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        if (lead == 0xE0) {
+            secondMin = 0xA0;
+        } else if (lead == 0xED) {
+            secondMax = 0x9F;
+        }
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        if (lead == 0xF0) {
+            secondMin = 0x90;
+        } else if (lead == 0xF4) {
+            secondMax = 0x8F;
+        }
+    } else {
+        return 0;
+    }
+    if (text.size() - i < length || byte(i + 1) < secondMin || byte(i + 1) > secondMax) {
+        return 0;
+    }
+    for (std::size_t k = 2; k < length; ++k) {
+        if ((byte(i + k) & 0xC0) != 0x80) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+std::string jsonString(std::string_view text) {
+    std::string json;
+    json.reserve(text.size() + 2);
+    writeJsonString(text, [&](const char* data, std::size_t size) { json.append(data, size); });
+    return json;
+}
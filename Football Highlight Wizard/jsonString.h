@@ -0,0 +1,56 @@
+#ifndef JSONSTRING_H
+#define JSONSTRING_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// JSON string literals for every writer of JSON (event exports, cut lists), so
+// they all escape alike. '"', '\\' and control characters are escaped; valid
+// UTF-8 passes through as it is. A byte that does not start a valid UTF-8
+// sequence (e.g. from a log saved as Latin-1) is taken as the Latin-1 character
+// it would be and written as \u00XX, so the output is always valid JSON.
+
+// Length of the valid UTF-8 sequence starting at text[i], or 0 if there is none
+// (a stray continuation byte, a truncated or overlong sequence, a surrogate or a
+// code point past U+10FFFF); text[i] must be at least 0x80
+std::size_t utf8SequenceLength(std::string_view text, std::size_t i);
+
+// Writes text as a quoted JSON string through put(const char* data, std::size_t size);
+// runs of characters that need no escape are handed over in one piece
+template <typename Put>
+void writeJsonString(std::string_view text, Put&& put) {
+    static constexpr char hexDigits[] = "0123456789abcdef";
+    put("\"", 1);
+    std::size_t plain = 0;
+    for (std::size_t i = 0; i < text.size();) {
+        const auto c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\' && c < 0x80) {
+            ++i;
+            continue;
+        }
+        if (c >= 0x80) {
+            const std::size_t length = utf8SequenceLength(text, i);
+            if (length != 0) {
+                i += length;
+                continue;
+            }
+        }
+        put(text.data() + plain, i - plain);
+        if (c == '"' || c == '\\') {
+            const char escaped[2] = {'\\', static_cast<char>(c)};
+            put(escaped, 2);
+        } else {
+            const char escaped[6] = {'\\', 'u', '0', '0', hexDigits[c >> 4], hexDigits[c & 0xF]};
+            put(escaped, 6);
+        }
+        plain = ++i;
+    }
+    put(text.data() + plain, text.size() - plain);
+    put("\"", 1);
+}
+
+// text as a quoted JSON string
+std::string jsonString(std::string_view text);
+
+#endif // JSONSTRING_H
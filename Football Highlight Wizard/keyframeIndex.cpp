@@ -0,0 +1,460 @@
+#include "keyframeIndex.h"
+#include "mappedFile.h"
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <optional>
+#include <stdexcept>
+
+namespace {
+
+using Byte = unsigned char;
+
+// What is wrong with the file; fromFile adds the file name
+class Mp4Error : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+constexpr std::uint32_t boxType(const char (&name)[5]) {
+    return static_cast<std::uint32_t>(static_cast<Byte>(name[0])) << 24 |
+           static_cast<std::uint32_t>(static_cast<Byte>(name[1])) << 16 |
+           static_cast<std::uint32_t>(static_cast<Byte>(name[2])) << 8 |
+           static_cast<std::uint32_t>(static_cast<Byte>(name[3]));
+}
+
+std::string boxName(std::uint32_t type) {
+    std::string name(4, ' ');
+    for (int i = 0; i < 4; ++i) {
+        const char c = static_cast<char>(type >> (24 - 8 * i));
+        name[i] = (c >= 0x20 && c < 0x7f) ? c : '?';
+    }
+    return name;
+}
+
+std::uint32_t readU32(const Byte* at) {
+    return static_cast<std::uint32_t>(at[0]) << 24 | static_cast<std::uint32_t>(at[1]) << 16 |
+           static_cast<std::uint32_t>(at[2]) << 8 | static_cast<std::uint32_t>(at[3]);
+}
+
+std::uint64_t readU64(const Byte* at) {
+    return static_cast<std::uint64_t>(readU32(at)) << 32 | readU32(at + 4);
+}
+
+// Bytes [begin, end) of the mapped file
+struct Span {
+    const Byte* begin = nullptr;
+    const Byte* end = nullptr;
+
+    std::size_t size() const { return static_cast<std::size_t>(end - begin); }
+};
+
+struct Box {
+    std::uint32_t type = 0;
+    Span payload;
+};
+
+// Reads the box at position and moves past it; false at the end of the parent.
+// Every MP4 box is a 32-bit big-endian size (1: a 64-bit size follows, 0: up to the
+// end of the parent) and a four-character type.
+bool nextBox(const Byte*& position, const Byte* end, Box& box) {
+    const std::size_t left = static_cast<std::size_t>(end - position);
+    if (left < 8) {
+        return false; // Writers may pad a container with a few zero bytes
+    }
+    std::uint64_t size = readU32(position);
+    box.type = readU32(position + 4);
+    std::size_t headerSize = 8;
+    if (size == 1) {
+        if (left < 16) {
+            throw Mp4Error("truncated box '" + boxName(box.type) + "'");
+        }
+        size = readU64(position + 8);
+        headerSize = 16;
+    } else if (size == 0) {
+        size = left;
+    }
+    if (box.type == boxType("uuid")) {
+        headerSize += 16; // Extended type
+    }
+    if (size < headerSize || size > left) {
+        throw Mp4Error("box '" + boxName(box.type) + "' runs past its parent");
+    }
+    box.payload = Span{position + headerSize, position + size};
+    position += size;
+    return true;
+}
+
+// The first box of that type directly inside the span; stops there, so a damaged
+// box after it (e.g. the media data of a truncated download) does not matter
+std::optional<Span> findBox(Span parent, std::uint32_t type) {
+    const Byte* position = parent.begin;
+    Box box;
+    while (nextBox(position, parent.end, box)) {
+        if (box.type == type) {
+            return box.payload;
+        }
+    }
+    return std::nullopt;
+}
+
+Span requireBox(Span parent, const char (&name)[5]) {
+    const std::optional<Span> found = findBox(parent, boxType(name));
+    if (!found) {
+        throw Mp4Error(std::string("missing '") + name + "' box");
+    }
+    return *found;
+}
+
+// Big-endian fields of a box payload, every read bounds-checked
+class FieldReader {
+public:
+    FieldReader(Span span, const char* box) : position(span.begin), end(span.end), box(box) {}
+
+    std::uint8_t u8() { need(1); return *position++; }
+    std::uint32_t u32() { need(4); const std::uint32_t value = readU32(position); position += 4; return value; }
+    std::uint64_t u64() { need(8); const std::uint64_t value = readU64(position); position += 8; return value; }
+    void skip(std::size_t bytes) { need(bytes); position += bytes; }
+
+    std::size_t remaining() const { return static_cast<std::size_t>(end - position); }
+    const Byte* here() const { return position; }
+
+private:
+    const Byte* position;
+    const Byte* end;
+    const char* box;
+
+    void need(std::size_t bytes) const {
+        if (remaining() < bytes) {
+            throw Mp4Error(std::string("truncated '") + box + "' box");
+        }
+    }
+};
+
+// A "full box" table: version, flags, an entry count and the entries
+struct Table {
+    int version = 0;
+    std::uint32_t count = 0;
+    const Byte* entries = nullptr;
+    std::size_t entrySize = 0;
+
+    const Byte* entry(std::uint32_t index) const { return entries + index * entrySize; }
+};
+
+Table readTable(Span box, std::size_t entrySize, const char* name) {
+    FieldReader reader(box, name);
+    Table table;
+    table.version = reader.u8();
+    reader.skip(3); // Flags
+    table.count = reader.u32();
+    table.entries = reader.here();
+    table.entrySize = entrySize;
+    if (table.count > reader.remaining() / entrySize) {
+        throw Mp4Error(std::string("'") + name + "' table is longer than its box");
+    }
+    return table;
+}
+
+// A run-length table (stts, ctts) read in sample order: each entry is a sample
+// count and a value, the value of those samples
+class RunCursor {
+public:
+    explicit RunCursor(const Table& table) : table(table) {}
+
+    // The entry covering sample (0-based); samples must be asked for in ascending order.
+    // False past the last entry
+    bool seek(std::uint64_t sample) {
+        while (run < table.count) {
+            const std::uint32_t count = readU32(table.entry(run));
+            if (sample < runFirstSample + count) {
+                return true;
+            }
+            runFirstSample += count;
+            runStartSum += static_cast<std::int64_t>(count) * value();
+            ++run;
+        }
+        return false;
+    }
+    // The sample after the last one of the entry found by seek
+    std::uint64_t runEnd() const { return runFirstSample + readU32(table.entry(run)); }
+    // The entry's value as stored (stts durations are unsigned, ctts offsets signed in
+    // version 1 and, in practice, from many version 0 writers too)
+    std::int64_t value() const { return readU32(table.entry(run) + 4); }
+    std::int64_t signedValue() const { return static_cast<std::int32_t>(readU32(table.entry(run) + 4)); }
+    // Sum of the values of the samples before sample (stts: its decoding time)
+    std::int64_t sumBefore(std::uint64_t sample) const {
+        return runStartSum + static_cast<std::int64_t>(sample - runFirstSample) * value();
+    }
+
+private:
+    const Table& table;
+    std::uint32_t run = 0;
+    std::uint64_t runFirstSample = 0;
+    std::int64_t runStartSum = 0;
+};
+
+// Number of samples in the sample size table (stsz, or the compact stz2). A table
+// of sizes must fit in its box, and samples of one fixed size in the file, so a
+// damaged count cannot claim more samples than the file can hold.
+std::uint64_t readSampleSizeCount(Span stbl, std::size_t fileSize) {
+    if (const std::optional<Span> stsz = findBox(stbl, boxType("stsz"))) {
+        FieldReader reader(*stsz, "stsz");
+        reader.skip(4); // Version, flags
+        const std::uint32_t sampleSize = reader.u32();
+        const std::uint32_t count = reader.u32();
+        if (sampleSize == 0 ? count > reader.remaining() / 4 : count > fileSize / sampleSize) {
+            throw Mp4Error("'stsz' has more samples than the file can hold");
+        }
+        return count;
+    }
+    if (const std::optional<Span> stz2 = findBox(stbl, boxType("stz2"))) {
+        FieldReader reader(*stz2, "stz2");
+        reader.skip(7); // Version, flags, reserved
+        const std::uint8_t fieldBits = reader.u8();
+        const std::uint32_t count = reader.u32();
+        if ((fieldBits != 4 && fieldBits != 8 && fieldBits != 16) ||
+            (static_cast<std::uint64_t>(count) * fieldBits + 7) / 8 > reader.remaining()) {
+            throw Mp4Error("'stz2' table is damaged or longer than its box");
+        }
+        return count;
+    }
+    throw Mp4Error("missing 'stsz' box");
+}
+
+// Ticks per second of a movie (mvhd) or media (mdhd) header
+std::uint32_t readTimescale(Span header, const char* name) {
+    FieldReader reader(header, name);
+    const int version = reader.u8();
+    reader.skip(3);
+    reader.skip(version == 1 ? 16 : 8); // Creation and modification times
+    const std::uint32_t timescale = reader.u32();
+    if (timescale == 0) {
+        throw Mp4Error(std::string("'") + name + "' box has a timescale of zero");
+    }
+    return timescale;
+}
+
+// Ticks to add to a sample's decoding time plus composition offset to get its time
+// in the presentation: leading empty edits delay the media, the first media edit
+// says where in the media the presentation starts (e.g. after the B-frame delay)
+std::int64_t presentationShift(Span trak, std::uint32_t movieTimescale, std::uint32_t mediaTimescale) {
+    const std::optional<Span> edts = findBox(trak, boxType("edts"));
+    const std::optional<Span> elst = edts ? findBox(*edts, boxType("elst")) : std::nullopt;
+    if (!elst) {
+        return 0;
+    }
+    FieldReader reader(*elst, "elst");
+    const int version = reader.u8();
+    reader.skip(3);
+    const std::uint32_t count = reader.u32();
+    std::uint64_t emptyDuration = 0; // In the movie timescale
+    std::int64_t mediaStart = 0;
+    for (std::uint32_t i = 0; i < count; ++i) {
+        const std::uint64_t segmentDuration = version == 1 ? reader.u64() : reader.u32();
+        const std::int64_t mediaTime = version == 1 ? static_cast<std::int64_t>(reader.u64())
+                                                    : static_cast<std::int32_t>(reader.u32());
+        reader.skip(4); // Rate
+        if (mediaTime == -1) {
+            emptyDuration += segmentDuration;
+            continue;
+        }
+        mediaStart = mediaTime;
+        break;
+    }
+    const double delay = static_cast<double>(emptyDuration) * mediaTimescale / movieTimescale;
+    return static_cast<std::int64_t>(std::llround(delay)) - mediaStart;
+}
+
+} // namespace
+
+KeyframeIndex KeyframeIndex::fromFile(const std::string& filename) {
+    const MappedFile file(filename);
+    const Byte* data = reinterpret_cast<const Byte*>(file.data());
+    try {
+        const std::optional<Span> moov = findBox(Span{data, data + file.size()}, boxType("moov"));
+        if (!moov) {
+            throw Mp4Error("no 'moov' box (not an MP4 file, or its recording was never finished)");
+        }
+        if (findBox(*moov, boxType("mvex"))) {
+            throw Mp4Error("fragmented MP4 is not supported");
+        }
+        const std::uint32_t movieTimescale = readTimescale(requireBox(*moov, "mvhd"), "mvhd");
+
+        const Byte* position = moov->begin;
+        Box box;
+        while (nextBox(position, moov->end, box)) {
+            if (box.type != boxType("trak")) {
+                continue;
+            }
+            const Span trak = box.payload;
+            const Span mdia = requireBox(trak, "mdia");
+            FieldReader handler(requireBox(mdia, "hdlr"), "hdlr");
+            handler.skip(8); // Version, flags, pre_defined
+            if (handler.u32() != boxType("vide")) {
+                continue;
+            }
+
+            KeyframeIndex index;
+            index.ticksPerSecond = readTimescale(requireBox(mdia, "mdhd"), "mdhd");
+            const Span stbl = requireBox(requireBox(mdia, "minf"), "stbl");
+            const Table stts = readTable(requireBox(stbl, "stts"), 8, "stts");
+            const std::optional<Span> stssBox = findBox(stbl, boxType("stss"));
+            const std::optional<Span> cttsBox = findBox(stbl, boxType("ctts"));
+            const Table stss = stssBox ? readTable(*stssBox, 4, "stss") : Table{};
+            const Table ctts = cttsBox ? readTable(*cttsBox, 8, "ctts") : Table{}; // None: no offsets
+
+            std::map<std::uint32_t, std::uint64_t> samplesPerDuration;
+            for (std::uint32_t i = 0; i < stts.count; ++i) {
+                const std::uint32_t count = readU32(stts.entry(i));
+                const std::uint32_t duration = readU32(stts.entry(i) + 4);
+                index.samples += count;
+                index.durationTicks += static_cast<std::int64_t>(count) * duration;
+                samplesPerDuration[duration] += count;
+            }
+            if (index.samples == 0) {
+                throw Mp4Error("the video track has no samples");
+            }
+            if (index.samples != readSampleSizeCount(stbl, file.size())) {
+                throw Mp4Error("'stts' and 'stsz' disagree on the number of samples");
+            }
+            const auto mostCommon = std::max_element(samplesPerDuration.begin(), samplesPerDuration.end(),
+                                                     [](const auto& a, const auto& b) { return a.second < b.second; });
+            index.nominalFrameRate = mostCommon->first == 0 ? 0 : static_cast<double>(index.ticksPerSecond) / mostCommon->first;
+
+            const std::int64_t shift = presentationShift(trak, movieTimescale, index.ticksPerSecond);
+            index.durationTicks = std::max<std::int64_t>(0, index.durationTicks + shift);
+
+            RunCursor decodeTimes(stts);
+            RunCursor offsets(ctts);
+            if (stssBox) {
+                std::vector<std::int64_t> keyframes;
+                keyframes.reserve(stss.count);
+                std::uint64_t previous = 0;
+                for (std::uint32_t i = 0; i < stss.count; ++i) {
+                    const std::uint64_t number = readU32(stss.entry(i)); // 1-based
+                    if (number <= previous || number > index.samples) {
+                        throw Mp4Error("'stss' sample numbers are out of order or out of range");
+                    }
+                    const std::uint64_t sample = number - 1;
+                    decodeTimes.seek(sample); // Within the samples counted above
+                    std::int64_t time = decodeTimes.sumBefore(sample) + shift;
+                    if (offsets.seek(sample)) {
+                        time += offsets.signedValue();
+                    }
+                    keyframes.push_back(time);
+                    previous = number;
+                }
+                // Keyframes are in decoding order; their presentation order normally matches
+                std::sort(keyframes.begin(), keyframes.end());
+                for (std::int64_t time : keyframes) {
+                    index.appendKeyframes(time, 0, 1);
+                }
+            } else {
+                // Every sample is a keyframe: each stretch of samples with the same
+                // duration and composition offset is one run, so the runs are no more
+                // than the entries of stts and ctts together, however many frames
+                std::vector<Run> stretches;
+                for (std::uint64_t sample = 0; sample < index.samples;) {
+                    decodeTimes.seek(sample);
+                    std::uint64_t end = decodeTimes.runEnd();
+                    std::int64_t time = decodeTimes.sumBefore(sample) + shift;
+                    if (offsets.seek(sample)) {
+                        time += offsets.signedValue();
+                        end = std::min(end, offsets.runEnd());
+                    }
+                    stretches.push_back({time, decodeTimes.value(), end - sample});
+                    sample = end;
+                }
+                const bool inOrder = std::adjacent_find(stretches.begin(), stretches.end(), [](const Run& a, const Run& b) {
+                    return b.first < a.first + a.step * static_cast<std::int64_t>(a.count - 1);
+                }) == stretches.end();
+                if (inOrder) {
+                    for (const Run& stretch : stretches) {
+                        index.appendKeyframes(stretch.first, stretch.step, stretch.count);
+                    }
+                } else {
+                    // Composition offsets reorder the frames: list them (no more than
+                    // the file has bytes, see readSampleSizeCount) and sort them
+                    std::vector<std::int64_t> keyframes;
+                    keyframes.reserve(static_cast<std::size_t>(index.samples));
+                    for (const Run& stretch : stretches) {
+                        for (std::uint64_t i = 0; i < stretch.count; ++i) {
+                            keyframes.push_back(stretch.first + stretch.step * static_cast<std::int64_t>(i));
+                        }
+                    }
+                    std::sort(keyframes.begin(), keyframes.end());
+                    for (std::int64_t time : keyframes) {
+                        index.appendKeyframes(time, 0, 1);
+                    }
+                }
+            }
+            if (index.empty()) {
+                throw Mp4Error("the video track has no keyframes");
+            }
+            return index;
+        }
+        throw Mp4Error("no video track");
+    } catch (const Mp4Error& e) {
+        throw std::runtime_error("Unsupported or damaged MP4 file " + filename + ": " + e.what());
+    }
+}
+
+double KeyframeIndex::keyframeAtOrBefore(double seconds) const {
+    if (runs.empty()) {
+        return seconds; // Nothing indexed
+    }
+    // A thousandth of a tick of slack, so a time computed from a keyframe finds it
+    const double ticks = std::floor(seconds * ticksPerSecond + 1e-3);
+    const auto after = std::upper_bound(runs.begin(), runs.end(), ticks,
+                                        [](double value, const Run& run) { return value < run.first; });
+    if (after == runs.begin()) {
+        return secondsOf(runs.front().first);
+    }
+    const Run& run = *(after - 1);
+    std::uint64_t last = run.count - 1;
+    if (run.step > 0) {
+        const double steps = std::floor((ticks - static_cast<double>(run.first)) / static_cast<double>(run.step));
+        last = std::min(last, static_cast<std::uint64_t>(steps));
+    }
+    return secondsOf(run.first + run.step * static_cast<std::int64_t>(last));
+}
+
+void KeyframeIndex::appendKeyframes(std::int64_t first, std::int64_t step, std::uint64_t count) {
+    if (count == 0) {
+        return;
+    }
+    if (step <= 0) {
+        step = 0; // Keyframes at the same time are one
+        count = 1;
+    }
+    if (!runs.empty()) {
+        Run& last = runs.back();
+        const std::int64_t lastTime = last.first + last.step * static_cast<std::int64_t>(last.count - 1);
+        if (first == lastTime) {
+            // Already there
+            first += step;
+            if (--count == 0 || step == 0) {
+                return;
+            }
+        }
+        const std::int64_t gap = first - lastTime;
+        if (last.count == 1) {
+            last.step = gap;
+        }
+        if (gap == last.step) {
+            ++last.count;
+            ++keyframeCount;
+            first += step;
+            if (--count == 0) {
+                return;
+            }
+            if (step == last.step) {
+                last.count += count;
+                keyframeCount += count;
+                return;
+            }
+        }
+    }
+    runs.push_back({first, step, count});
+    keyframeCount += count;
+}
@@ -0,0 +1,64 @@
+#ifndef KEYFRAMEINDEX_H
+#define KEYFRAMEINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Presentation times of the keyframes (sync samples) of the video track of an
+// MP4/MOV file, read from its sample tables: nothing is decoded. A cut that
+// starts on a keyframe can be stream-copied (e.g. "ffmpeg -ss <start> -to <end>
+// -c copy") instead of re-encoded.
+//
+// The file is mapped and only its moov box is walked: the decoding times come
+// from stts, the composition offsets from ctts, the keyframes from stss (every
+// sample, if there is none) and the start of the presentation from the track's
+// edit list. Each table is read run by run, so indexing an hour of video costs
+// microseconds and only the pages of the moov box are ever read. Keyframes are
+// kept as runs at a fixed interval: a video of regular GOPs, or one where every
+// frame is a keyframe, takes a handful of runs whatever its length.
+// Fragmented MP4 (moof boxes, e.g. streaming captures) is not supported.
+class KeyframeIndex {
+public:
+    // Indexes the first video track of the file
+    // Throws std::runtime_error if the file cannot be opened, has no video track,
+    // is fragmented or its tables are damaged
+    static KeyframeIndex fromFile(const std::string& filename);
+
+    std::uint64_t size() const { return keyframeCount; }
+    bool empty() const { return keyframeCount == 0; }
+
+    std::uint32_t timescale() const { return ticksPerSecond; }
+    std::uint64_t sampleCount() const { return samples; }
+    double durationSeconds() const { return static_cast<double>(durationTicks) / ticksPerSecond; }
+    // From the most common sample duration, e.g. 25 or 29.97
+    double frameRate() const { return nominalFrameRate; }
+
+    double secondsOf(std::int64_t ticks) const { return static_cast<double>(ticks) / ticksPerSecond; }
+
+    // Time of the last keyframe at or before seconds, or of the first keyframe if
+    // there is none before it; O(log n)
+    double keyframeAtOrBefore(double seconds) const;
+
+private:
+    // Keyframes at first, first + step, ... (count of them), in ticks of timescale()
+    struct Run {
+        std::int64_t first = 0;
+        std::int64_t step = 0;
+        std::uint64_t count = 0;
+    };
+
+    std::vector<Run> runs;       // Ascending, no keyframe twice
+    std::uint64_t keyframeCount = 0;
+    std::uint32_t ticksPerSecond = 1;
+    std::uint64_t samples = 0;
+    std::int64_t durationTicks = 0;
+    double nominalFrameRate = 0;
+
+    // Appends keyframes at first, first + step, ... to the runs, extending the last
+    // one where they continue it; first must not be before the last keyframe
+    void appendKeyframes(std::int64_t first, std::int64_t step, std::uint64_t count);
+};
+
+#endif // KEYFRAMEINDEX_H
@@ -6,6 +6,9 @@ int main(int argc, char *argv[])
 {
     // Create the Qt Application object
     QApplication a(argc, argv);
+    // Where QSettings keeps the window's settings and where its cache directory is
+    QApplication::setOrganizationName("EggRolle");
+    QApplication::setApplicationName("Football Highlight Wizard");
 
     // Optional: Try to set a nicer visual style
     QApplication::setStyle(QStyleFactory::create("Fusion"));
@@ -0,0 +1,129 @@
+#include "mappedFile.h"
+#include <stdexcept> // For runtime_error
+#include <utility>   // For std::exchange
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& filename) {
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                              nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        throw std::runtime_error("Could not read size of file: " + filename);
+    }
+    fileHandle = file;
+    mappedSize = static_cast<std::size_t>(fileSize.QuadPart);
+    if (mappedSize == 0) {
+        return; // Nothing to map, view() is simply empty
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        unmap();
+        throw std::runtime_error("Could not map file: " + filename);
+    }
+    mappingHandle = mapping;
+
+    const void* address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (address == nullptr) {
+        unmap();
+        throw std::runtime_error("Could not map file: " + filename);
+    }
+    mappedData = static_cast<const char*>(address);
+}
+
+void MappedFile::unmap() noexcept {
+    if (mappedData) UnmapViewOfFile(mappedData);
+    if (mappingHandle) CloseHandle(static_cast<HANDLE>(mappingHandle));
+    if (fileHandle) CloseHandle(static_cast<HANDLE>(fileHandle));
+    mappedData = nullptr;
+    mappedSize = 0;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Could not read size of file: " + filename);
+    }
+
+    std::size_t size = static_cast<std::size_t>(info.st_size);
+    if (size == 0) {
+        ::close(fd); // mmap refuses zero-length mappings, an empty view is enough
+        return;
+    }
+
+    void* address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping keeps its own reference to the file
+    if (address == MAP_FAILED) {
+        throw std::runtime_error("Could not map file: " + filename);
+    }
+    // We only ever walk the buffer front to back, let the kernel read ahead aggressively
+    ::madvise(address, size, MADV_SEQUENTIAL);
+
+    mappedData = static_cast<const char*>(address);
+    mappedSize = size;
+}
+
+void MappedFile::unmap() noexcept {
+    if (mappedData) {
+        ::munmap(const_cast<char*>(mappedData), mappedSize);
+    }
+    mappedData = nullptr;
+    mappedSize = 0;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : mappedData(std::exchange(other.mappedData, nullptr))
+    , mappedSize(std::exchange(other.mappedSize, 0))
+#ifdef _WIN32
+    , fileHandle(std::exchange(other.fileHandle, nullptr))
+    , mappingHandle(std::exchange(other.mappingHandle, nullptr))
+#endif
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        mappedData = std::exchange(other.mappedData, nullptr);
+        mappedSize = std::exchange(other.mappedSize, 0);
+#ifdef _WIN32
+        fileHandle = std::exchange(other.fileHandle, nullptr);
+        mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+    }
+    return *this;
+}
@@ -0,0 +1,40 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file.
+// The mapping lives as long as the object, so any std::string_view taken
+// from view() must not outlive it.
+class MappedFile {
+public:
+    MappedFile() = default;
+
+    // Maps the file read-only
+    // Throws std::runtime_error if the file cannot be opened or mapped
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return mappedData; }
+    std::size_t size() const { return mappedSize; }
+    std::string_view view() const { return std::string_view(mappedData, mappedSize); }
+
+private:
+    const char* mappedData = nullptr;
+    std::size_t mappedSize = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;    // HANDLE
+    void* mappingHandle = nullptr; // HANDLE
+#endif
+
+    void unmap() noexcept;
+};
+
+#endif // MAPPEDFILE_H
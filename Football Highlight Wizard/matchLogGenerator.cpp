@@ -0,0 +1,163 @@
+#include "matchLogGenerator.h"
+#include <charconv> // For std::to_chars
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <string_view>
+
+namespace {
+
+constexpr std::string_view descriptionWords[] = {
+    "Neymar", "Vinicius", "Rodrygo", "Casemiro", "Marquinhos", "Alisson", "Raphinha", "Paqueta",
+    "Flamengo", "Palmeiras", "Corinthians", "Santos", "Gremio", "Fluminense",
+    "shot", "header", "cross", "corner", "free", "kick", "penalty", "box", "keeper", "save",
+    "from", "the", "of", "into", "near", "post", "left", "right", "foot", "tackle", "late", "area"
+};
+constexpr std::size_t descriptionWordCount = sizeof(descriptionWords) / sizeof(descriptionWords[0]);
+
+// Writes are batched so tens of millions of lines do not cost one stream call each
+constexpr std::size_t flushThreshold = 1 << 20;
+
+void appendNumber(std::string& buffer, long long value) {
+    char digits[24];
+    const auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    buffer.append(digits, result.ptr);
+}
+
+} // namespace
+
+std::array<double, eventTypeCount> MatchLogOptions::defaultTypeWeights() {
+    std::array<double, eventTypeCount> weights{};
+    weights[static_cast<std::size_t>(EventType::GOAL)] = 3;
+    weights[static_cast<std::size_t>(EventType::YELLOW_CARD)] = 4;
+    weights[static_cast<std::size_t>(EventType::RED_CARD)] = 0.3;
+    weights[static_cast<std::size_t>(EventType::FOUL)] = 25;
+    weights[static_cast<std::size_t>(EventType::SUBSTITUTION)] = 6;
+    weights[static_cast<std::size_t>(EventType::OTHER)] = 60;
+    return weights;
+}
+
+std::array<double, eventTypeCount> parseTypeWeights(const std::string& text) {
+    std::array<double, eventTypeCount> weights{};
+    std::string_view rest = text;
+    while (!rest.empty()) {
+        const std::size_t comma = rest.find(',');
+        const std::string_view item = rest.substr(0, comma);
+        rest.remove_prefix(comma == std::string_view::npos ? rest.size() : comma + 1);
+
+        const std::size_t equals = item.find('=');
+        const EventType type = GameEvent::stringToType(item.substr(0, equals));
+        if (equals == std::string_view::npos || type == EventType::UNKNOWN) {
+            throw std::invalid_argument("Expected <EVENT_TYPE>=<weight>, found '" + std::string(item) + "'");
+        }
+        const std::string weightText(item.substr(equals + 1));
+        std::size_t used = 0;
+        double weight = -1;
+        try {
+            weight = std::stod(weightText, &used);
+        } catch (const std::exception&) {
+            // Reported below
+        }
+        if (used != weightText.size() || !(weight >= 0)) {
+            throw std::invalid_argument("Invalid weight in '" + std::string(item) + "'");
+        }
+        weights[static_cast<std::size_t>(type)] = weight;
+    }
+    return weights;
+}
+
+std::uint64_t generateMatchLog(const MatchLogOptions& options, std::ostream& out) {
+    if (options.minDescriptionWords < 0 || options.maxDescriptionWords < options.minDescriptionWords) {
+        throw std::invalid_argument("Invalid description length range");
+    }
+    std::array<double, eventTypeCount> weights = options.typeWeights;
+    weights[static_cast<std::size_t>(EventType::UNKNOWN)] = 0;
+    double totalWeight = 0;
+    for (double weight : weights) {
+        totalWeight += weight;
+    }
+    if (!(totalWeight > 0)) {
+        throw std::invalid_argument("The event type mix has no positive weight");
+    }
+
+    std::mt19937_64 random(options.seed);
+    std::discrete_distribution<std::size_t> pickType(weights.begin(), weights.end());
+    std::uniform_int_distribution<int> pickWordCount(options.minDescriptionWords, options.maxDescriptionWords);
+    std::uniform_int_distribution<std::size_t> pickWord(0, descriptionWordCount - 1);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    const std::uint64_t count = options.eventCount;
+    const std::uint64_t halfTimeLine = count / 2;
+    std::uint64_t malformedLines = 0;
+    std::uint64_t bytesWritten = 0;
+    std::string buffer;
+    buffer.reserve(flushThreshold + 4096);
+
+    for (std::uint64_t line = 0; line < count; ++line) {
+        const long long minute = (count > 1)
+            ? static_cast<long long>(line * static_cast<std::uint64_t>(options.matchMinutes) / (count - 1))
+            : 0;
+
+        EventType type;
+        if (count >= 3 && line == 0) {
+            type = EventType::GAME_START;
+        } else if (count >= 3 && line == halfTimeLine) {
+            type = EventType::HALF_TIME;
+        } else if (count >= 3 && line == count - 1) {
+            type = EventType::FULL_TIME;
+        } else {
+            type = static_cast<EventType>(pickType(random));
+        }
+
+        if (options.malformedRate > 0 && chance(random) < options.malformedRate) {
+            switch (malformedLines++ % 3) {
+                case 0: // Missing the description field
+                    appendNumber(buffer, minute);
+                    buffer += ',';
+                    buffer += GameEvent::typeToString(type);
+                    break;
+                case 1:
+                    buffer += "min";
+                    appendNumber(buffer, minute);
+                    buffer += ',';
+                    buffer += GameEvent::typeToString(type);
+                    buffer += ",timestamp is not a number";
+                    break;
+                default:
+                    appendNumber(buffer, -1 - minute);
+                    buffer += ',';
+                    buffer += GameEvent::typeToString(type);
+                    buffer += ",negative timestamp";
+                    break;
+            }
+        } else {
+            appendNumber(buffer, minute);
+            buffer += ',';
+            buffer += GameEvent::typeToString(type);
+            buffer += ',';
+            const int wordCount = pickWordCount(random);
+            const int commaAfter = (wordCount > 1 && options.commaRate > 0 && chance(random) < options.commaRate)
+                                       ? std::uniform_int_distribution<int>(0, wordCount - 2)(random)
+                                       : -1;
+            for (int word = 0; word < wordCount; ++word) {
+                if (word > 0) {
+                    buffer += ' ';
+                }
+                buffer += descriptionWords[pickWord(random)];
+                if (word == commaAfter) {
+                    buffer += ',';
+                }
+            }
+        }
+        buffer += '\n';
+
+        if (buffer.size() >= flushThreshold) {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            bytesWritten += buffer.size();
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    bytesWritten += buffer.size();
+    return bytesWritten;
+}
@@ -0,0 +1,38 @@
+#ifndef MATCHLOGGENERATOR_H
+#define MATCHLOGGENERATOR_H
+
+#include "gameEvent.h"
+#include <array>
+#include <cstdint>
+#include <iosfwd> // For std::ostream
+#include <string>
+
+// Settings for a synthetic "<minute>,<EVENT_TYPE>,<description>" log
+struct MatchLogOptions {
+    std::uint64_t eventCount = 2000;  // Lines written, GAME_START/HALF_TIME/FULL_TIME included
+    std::uint64_t seed = 1;           // Same options and seed give the same log
+    int matchMinutes = 90;            // Minutes are spread evenly over [0, matchMinutes], in order
+
+    // Relative weight of each EventType for the events between the kick-off and the
+    // final whistle, indexed by the enum value; UNKNOWN is never written
+    std::array<double, eventTypeCount> typeWeights = defaultTypeWeights();
+
+    int minDescriptionWords = 3;
+    int maxDescriptionWords = 10;
+    double commaRate = 0.05;     // Fraction of descriptions that contain a comma
+    double malformedRate = 0.0;  // Fraction of lines the parser rejects (see generateMatchLog)
+
+    // Roughly the mix of a real match: mostly fouls and other play, few goals
+    static std::array<double, eventTypeCount> defaultTypeWeights();
+};
+
+// Writes the log to out. Malformed lines cycle through the errors the parser
+// reports: a missing field, a non-numeric timestamp and a negative timestamp.
+// Returns the number of bytes written.
+std::uint64_t generateMatchLog(const MatchLogOptions& options, std::ostream& out);
+
+// Parses "GOAL=3,FOUL=25" into weights; types that are not listed get weight 0
+// Throws std::invalid_argument for an unknown type or a negative weight
+std::array<double, eventTypeCount> parseTypeWeights(const std::string& text);
+
+#endif // MATCHLOGGENERATOR_H
@@ -0,0 +1,42 @@
+#include "matchLogs.h"
+#include <algorithm>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool isCompressedExtension(const std::string& extension) {
+    return extension == ".gz" || extension == ".zst";
+}
+
+} // namespace
+
+bool isMatchLog(const fs::path& path) {
+    const std::string extension = isCompressedExtension(path.extension().string()) ? path.stem().extension().string()
+                                                                                     : path.extension().string();
+    return extension == ".log";
+}
+
+std::string matchNameOf(const fs::path& log) {
+    return isCompressedExtension(log.extension().string()) ? log.stem().stem().string() : log.stem().string();
+}
+
+std::vector<fs::path> collectMatchLogs(const std::vector<std::string>& inputs) {
+    std::vector<fs::path> logs;
+    for (const auto& input : inputs) {
+        const fs::path path(input);
+        if (fs::is_directory(path)) {
+            std::vector<fs::path> found;
+            for (const auto& entry : fs::recursive_directory_iterator(path)) {
+                if (entry.is_regular_file() && isMatchLog(entry.path())) {
+                    found.push_back(entry.path());
+                }
+            }
+            std::sort(found.begin(), found.end());
+            logs.insert(logs.end(), found.begin(), found.end());
+        } else {
+            logs.push_back(path);
+        }
+    }
+    return logs;
+}
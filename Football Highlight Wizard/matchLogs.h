@@ -0,0 +1,25 @@
+#ifndef MATCHLOGS_H
+#define MATCHLOGS_H
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// How the command-line tools find match logs and name their matches, shared so
+// the batch tool and the daemon always agree on both
+
+// "match.log" and its compressed forms "match.log.gz" and "match.log.zst": the
+// files a directory scan picks up. Other names (e.g. "match.txt") are only taken
+// when given explicitly, so the tools' own reports ("match.highlights.txt", ...)
+// written next to the logs are never read back as logs.
+bool isMatchLog(const std::filesystem::path& path);
+
+// The name of the match: the log's file name without its extensions ("match" for
+// "match.log.gz", "match" for an explicit "match.txt")
+std::string matchNameOf(const std::filesystem::path& log);
+
+// Expands directories (recursively) into the match logs they contain, sorted;
+// files given explicitly are taken whatever their extension, in the order given
+std::vector<std::filesystem::path> collectMatchLogs(const std::vector<std::string>& inputs);
+
+#endif // MATCHLOGS_H
@@ -0,0 +1,115 @@
+#include "parseDiagnostics.h"
+#include <algorithm>
+#include <ostream>
+
+namespace {
+
+// Fields counted the way HighlightWizard::parseEventLine counts them: a single
+// trailing comma does not start another (empty) field. Only 0-2 matter here.
+std::size_t countFields(std::string_view line) {
+    if (line.empty()) {
+        return 0;
+    }
+    const std::size_t firstComma = line.find(',');
+    if (firstComma == std::string_view::npos || firstComma == line.size() - 1) {
+        return 1;
+    }
+    const std::size_t secondComma = line.find(',', firstComma + 1);
+    if (secondComma == std::string_view::npos || secondComma == line.size() - 1) {
+        return 2;
+    }
+    return 3;
+}
+
+std::string_view field(std::string_view line, std::size_t index) {
+    std::size_t begin = 0;
+    for (std::size_t i = 0; i < index; ++i) {
+        begin = line.find(',', begin);
+        if (begin == std::string_view::npos) {
+            return {};
+        }
+        ++begin;
+    }
+    return line.substr(begin, line.find(',', begin) - begin);
+}
+
+} // namespace
+
+std::string describeParseIssue(ParseIssue issue, std::string_view line, int lineNumber) {
+    const std::string number = std::to_string(lineNumber);
+    switch (issue) {
+        case ParseIssue::NONE:
+            break;
+        case ParseIssue::UNKNOWN_TYPE:
+            return "Warning line " + number + ": Unknown event type '" + std::string(field(line, 1)) + "'. Treating as OTHER.";
+        case ParseIssue::TOO_FEW_FIELDS:
+            return "Error parsing line " + number + ": Expected at least 3 comma-separated values, found " + std::to_string(countFields(line)) + ". Line: '" + std::string(line) + "'";
+        case ParseIssue::INVALID_TIMESTAMP:
+            return "Error parsing line " + number + ": Invalid number format for timestamp. Value: '" + std::string(field(line, 0)) + "'";
+        case ParseIssue::TIMESTAMP_OUT_OF_RANGE:
+            return "Error parsing line " + number + ": Timestamp number out of range. Value: '" + std::string(field(line, 0)) + "'";
+    }
+    return "Line " + number + " has no issue";
+}
+
+ParseDiagnostics::ParseDiagnostics(std::size_t sampleLimit)
+    : sampleLimit(sampleLimit) {}
+
+void ParseDiagnostics::record(ParseIssue issue, std::string_view line, int lineNumber) {
+    counts[static_cast<std::size_t>(issue)] += 1;
+    if (samples.size() < sampleLimit) {
+        samples.push_back(ParseDiagnostic{issue, lineNumber, std::string(line.substr(0, maxSampleLineBytes)),
+                                          describeParseIssue(issue, line, lineNumber)});
+    }
+}
+
+void ParseDiagnostics::append(const ParseDiagnostics& later) {
+    for (std::size_t i = 0; i < parseIssueCount; ++i) {
+        counts[i] += later.counts[i];
+    }
+    const std::size_t room = sampleLimit - std::min(sampleLimit, samples.size());
+    const std::size_t taken = std::min(room, later.samples.size());
+    samples.insert(samples.end(), later.samples.begin(), later.samples.begin() + static_cast<std::ptrdiff_t>(taken));
+}
+
+void ParseDiagnostics::clear() {
+    counts = {};
+    samples.clear();
+}
+
+std::uint64_t ParseDiagnostics::warningCount() const {
+    return count(ParseIssue::UNKNOWN_TYPE);
+}
+
+std::uint64_t ParseDiagnostics::errorCount() const {
+    return count(ParseIssue::TOO_FEW_FIELDS) + count(ParseIssue::INVALID_TIMESTAMP) +
+           count(ParseIssue::TIMESTAMP_OUT_OF_RANGE);
+}
+
+void ParseDiagnostics::write(std::ostream& out, std::string_view source) const {
+    for (const ParseDiagnostic& sample : samples) {
+        out << sample.message << '\n';
+    }
+    const std::uint64_t total = warningCount() + errorCount();
+    if (errorCount() == 0 && total == samples.size()) {
+        return; // Every issue was shown, nothing was skipped
+    }
+    out << "Parse diagnostics";
+    if (!source.empty()) {
+        out << " for " << source;
+    }
+    out << ": " << errorCount() << " malformed line(s) skipped, "
+        << warningCount() << " warning(s) [";
+    const char* separator = "";
+    for (std::size_t i = 1; i < parseIssueCount; ++i) {
+        if (counts[i] != 0) {
+            out << separator << parseIssueNames[i] << ": " << counts[i];
+            separator = ", ";
+        }
+    }
+    out << "]";
+    if (samples.size() < total) {
+        out << ", the first " << samples.size() << " shown";
+    }
+    out << '\n';
+}
@@ -0,0 +1,80 @@
+#ifndef PARSEDIAGNOSTICS_H
+#define PARSEDIAGNOSTICS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd> // For std::ostream
+#include <string>
+#include <string_view>
+#include <vector>
+
+// What the parser found wrong with a log line
+enum class ParseIssue : std::uint8_t {
+    NONE,                   // A valid event
+    UNKNOWN_TYPE,           // A valid event of an unknown type, kept as OTHER (warning)
+    TOO_FEW_FIELDS,         // Fewer than 3 comma-separated values (error)
+    INVALID_TIMESTAMP,      // The timestamp is not a number (error)
+    TIMESTAMP_OUT_OF_RANGE, // The timestamp does not fit in an int (error)
+};
+
+inline constexpr std::string_view parseIssueNames[] = {
+    "none", "unknown_type", "too_few_fields", "invalid_timestamp", "timestamp_out_of_range",
+};
+
+inline constexpr std::size_t parseIssueCount = sizeof(parseIssueNames) / sizeof(parseIssueNames[0]);
+
+// Errors make a line unusable; warnings still give an event
+constexpr bool isParseError(ParseIssue issue) {
+    return issue >= ParseIssue::TOO_FEW_FIELDS;
+}
+
+// The message for an issue of the given line, worded like the strict parser's
+// warnings and ParseException messages (e.g. "Error parsing line 7: ...")
+std::string describeParseIssue(ParseIssue issue, std::string_view line, int lineNumber);
+
+// One recorded issue
+struct ParseDiagnostic {
+    ParseIssue issue = ParseIssue::NONE;
+    int lineNumber = 0;
+    std::string line;    // The offending line, cut to maxSampleLineBytes
+    std::string message; // describeParseIssue
+};
+
+// Issues met while parsing a log: every issue is counted per category, but only
+// the first few are kept with their message and line, so a feed full of bad
+// lines costs a counter increment per line and a bounded amount of memory.
+class ParseDiagnostics {
+public:
+    static constexpr std::size_t defaultSampleLimit = 100;
+    static constexpr std::size_t maxSampleLineBytes = 256;
+
+    explicit ParseDiagnostics(std::size_t sampleLimit = defaultSampleLimit);
+
+    // Counts an issue of the given line; keeps it as a sample while there is room
+    void record(ParseIssue issue, std::string_view line, int lineNumber);
+    // Adds the issues of later lines (e.g. of the next chunk of the same file)
+    void append(const ParseDiagnostics& later);
+    void clear();
+
+    std::uint64_t count(ParseIssue issue) const { return counts[static_cast<std::size_t>(issue)]; }
+    std::uint64_t warningCount() const; // Lines kept with a warning
+    std::uint64_t errorCount() const;   // Malformed lines that were skipped
+    bool empty() const { return warningCount() == 0 && errorCount() == 0; }
+
+    // The first issues in line order, at most getSampleLimit() of them
+    const std::vector<ParseDiagnostic>& getSamples() const { return samples; }
+    std::size_t getSampleLimit() const { return sampleLimit; }
+
+    // One line per sample, then a line with the count per category if lines were
+    // skipped or not every issue is among the samples; source (e.g. the file name)
+    // is named in that line. Writes nothing if empty.
+    void write(std::ostream& out, std::string_view source = {}) const;
+
+private:
+    std::size_t sampleLimit;
+    std::array<std::uint64_t, parseIssueCount> counts{};
+    std::vector<ParseDiagnostic> samples;
+};
+
+#endif // PARSEDIAGNOSTICS_H
@@ -0,0 +1,90 @@
+#include "pipelineStats.h"
+#include <ostream>
+
+#if HIGHLIGHT_WIZARD_INSTRUMENTATION
+#include <atomic>
+#include <cstdlib> // For std::malloc
+#include <new>
+
+namespace {
+
+std::atomic<std::uint64_t> operatorNewCalls{0};
+
+} // namespace
+
+// Counting replacements of the global allocation functions. The array, nothrow
+// and sized forms all forward to these two by default.
+void* operator new(std::size_t size) {
+    operatorNewCalls.fetch_add(1, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+std::uint64_t allocationCount() {
+    return operatorNewCalls.load(std::memory_order_relaxed);
+}
+
+#else
+
+std::uint64_t allocationCount() {
+    return 0;
+}
+
+#endif
+
+void PipelineStats::merge(const PipelineStats& other) {
+    for (std::size_t i = 0; i < pipelineStageCount; ++i) {
+        stages[i].calls += other.stages[i].calls;
+        stages[i].nanoseconds += other.stages[i].nanoseconds;
+        stages[i].bytes += other.stages[i].bytes;
+        stages[i].items += other.stages[i].items;
+        stages[i].allocations += other.stages[i].allocations;
+    }
+    lines += other.lines;
+    events += other.events;
+    warnings += other.warnings;
+    errors += other.errors;
+}
+
+void PipelineStats::writeJson(std::ostream& out) const {
+    out << "{\"instrumentation\":" << (instrumentationEnabled ? "true" : "false") << ",\"stages\":[";
+    bool first = true;
+    for (std::size_t i = 0; i < pipelineStageCount; ++i) {
+        const StageStats& stage = stages[i];
+        if (stage.calls == 0) {
+            continue;
+        }
+        const double seconds = static_cast<double>(stage.nanoseconds) / 1e9;
+        const PipelineStage id = static_cast<PipelineStage>(i);
+        const bool sampled = id == PipelineStage::LINE_SPLIT || id == PipelineStage::TIMESTAMP ||
+                             id == PipelineStage::TYPE_LOOKUP || id == PipelineStage::STORE;
+        out << (first ? "" : ",")
+            << "{\"stage\":\"" << pipelineStageNames[i] << "\""
+            << ",\"calls\":" << stage.calls
+            << ",\"seconds\":" << seconds
+            << ",\"bytes\":" << stage.bytes
+            << ",\"items\":" << stage.items
+            << ",\"allocations\":" << stage.allocations
+            << ",\"sampled\":" << (sampled ? "true" : "false");
+        if (seconds > 0) {
+            out << ",\"items_per_second\":" << static_cast<double>(stage.items) / seconds
+                << ",\"bytes_per_second\":" << static_cast<double>(stage.bytes) / seconds;
+        }
+        out << "}";
+        first = false;
+    }
+    out << "],\"lines\":" << lines
+        << ",\"events\":" << events
+        << ",\"warnings\":" << warnings
+        << ",\"errors\":" << errors << "}";
+}
@@ -0,0 +1,119 @@
+#ifndef PIPELINESTATS_H
+#define PIPELINESTATS_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd> // For std::ostream
+#include <string_view>
+
+// Pipeline instrumentation is compiled in only when HIGHLIGHT_WIZARD_INSTRUMENTATION
+// is 1 (CMake option of the same name). Otherwise every hook below is an empty
+// inline function or an `if constexpr` branch that is never taken, and the stats
+// stay at zero.
+#ifndef HIGHLIGHT_WIZARD_INSTRUMENTATION
+#define HIGHLIGHT_WIZARD_INSTRUMENTATION 0
+#endif
+
+constexpr bool instrumentationEnabled = HIGHLIGHT_WIZARD_INSTRUMENTATION != 0;
+
+// Every stage, in pipeline order, with its name in the JSON report.
+// The parse stage covers the whole parse; the four stages after it split that
+// time by sampling one line in parseSampleInterval, so they are estimates.
+#define HIGHLIGHT_WIZARD_PIPELINE_STAGES(X)  \
+    X(OPEN, "open")                          \
+    X(CACHE_READ, "cache_read")              \
+    X(PARSE, "parse")                        \
+    X(LINE_SPLIT, "line_split")              \
+    X(TIMESTAMP, "timestamp")                \
+    X(TYPE_LOOKUP, "type_lookup")            \
+    X(STORE, "store")                        \
+    X(CACHE_WRITE, "cache_write")            \
+    X(TIME_INDEX, "time_index")              \
+    X(DESCRIPTION_INDEX, "description_index") \
+    X(CLASSIFY, "classify")                  \
+    X(SCORE, "score")                        \
+    X(REPORT, "report")                      \
+    X(LIVE_TAIL, "live_tail")                \
+    X(GUI_POPULATION, "gui_population")
+
+enum class PipelineStage : std::uint8_t {
+#define HIGHLIGHT_WIZARD_STAGE_ENUMERATOR(stage, name) stage,
+    HIGHLIGHT_WIZARD_PIPELINE_STAGES(HIGHLIGHT_WIZARD_STAGE_ENUMERATOR)
+#undef HIGHLIGHT_WIZARD_STAGE_ENUMERATOR
+};
+
+inline constexpr std::string_view pipelineStageNames[] = {
+#define HIGHLIGHT_WIZARD_STAGE_NAME(stage, name) name,
+    HIGHLIGHT_WIZARD_PIPELINE_STAGES(HIGHLIGHT_WIZARD_STAGE_NAME)
+#undef HIGHLIGHT_WIZARD_STAGE_NAME
+};
+
+inline constexpr std::size_t pipelineStageCount = sizeof(pipelineStageNames) / sizeof(pipelineStageNames[0]);
+
+// Lines timed stage by stage while parsing: one in this many
+inline constexpr std::size_t parseSampleInterval = 64;
+
+struct StageStats {
+    std::uint64_t calls = 0;        // Runs of the stage (sampled lines for the sampled stages)
+    std::uint64_t nanoseconds = 0;  // Wall time
+    std::uint64_t bytes = 0;        // Input bytes handled
+    std::uint64_t items = 0;        // Lines or events handled
+    std::uint64_t allocations = 0;  // operator new calls while the stage ran, process-wide
+};
+
+struct PipelineStats {
+    std::array<StageStats, pipelineStageCount> stages{};
+    std::uint64_t lines = 0;     // Lines read, including skipped and malformed ones
+    std::uint64_t events = 0;    // Events parsed
+    std::uint64_t warnings = 0;  // Lines kept with a warning (unknown event type)
+    std::uint64_t errors = 0;    // Malformed lines: skipped (lenient) or stopping a load or append
+
+    StageStats& operator[](PipelineStage stage) { return stages[static_cast<std::size_t>(stage)]; }
+    const StageStats& operator[](PipelineStage stage) const { return stages[static_cast<std::size_t>(stage)]; }
+
+    // Adds other's counters to these (e.g. to total several matches)
+    void merge(const PipelineStats& other);
+    void clear() { *this = PipelineStats(); }
+
+    // One JSON object: {"instrumentation":true,"stages":[{"stage":"open",...}],"lines":...}
+    // Stages that never ran are left out; seconds and per-second rates are derived
+    void writeJson(std::ostream& out) const;
+};
+
+// Number of operator new calls made by the process so far (0 without instrumentation)
+std::uint64_t allocationCount();
+
+// Times one run of a stage, from construction to destruction, and counts the
+// allocations made meanwhile. Without instrumentation it is empty.
+class ScopedStage {
+public:
+#if HIGHLIGHT_WIZARD_INSTRUMENTATION
+    ScopedStage(PipelineStats& stats, PipelineStage stage)
+        : stats(stats[stage]), start(std::chrono::steady_clock::now()), allocationsAtStart(allocationCount()) {}
+    ~ScopedStage() {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        stats.calls += 1;
+        stats.nanoseconds += static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        stats.allocations += allocationCount() - allocationsAtStart;
+    }
+    void addBytes(std::uint64_t bytes) { stats.bytes += bytes; }
+    void addItems(std::uint64_t items) { stats.items += items; }
+
+private:
+    StageStats& stats;
+    std::chrono::steady_clock::time_point start;
+    std::uint64_t allocationsAtStart;
+#else
+    ScopedStage(PipelineStats&, PipelineStage) {}
+    void addBytes(std::uint64_t) {}
+    void addItems(std::uint64_t) {}
+#endif
+
+public:
+    ScopedStage(const ScopedStage&) = delete;
+    ScopedStage& operator=(const ScopedStage&) = delete;
+};
+
+#endif // PIPELINESTATS_H
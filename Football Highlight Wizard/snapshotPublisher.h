@@ -0,0 +1,124 @@
+#ifndef SNAPSHOTPUBLISHER_H
+#define SNAPSHOTPUBLISHER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Read-copy-update publication of an immutable value to a fixed number of reader
+// slots (quiescent-state-based reclamation).
+//
+// A reader enters a read section, uses the current value through a plain pointer
+// and leaves: two atomic stores and one atomic load, no lock and no reference
+// count. A writer builds the next value on the side and publishes it with one
+// pointer exchange, so readers are never blocked by it; the previous value is
+// retired and freed once every reader that could still see it has left its read
+// section. Writers must be serialised by the caller.
+template <typename T>
+class SnapshotPublisher {
+public:
+    // Throws std::invalid_argument for no reader slots
+    explicit SnapshotPublisher(std::size_t readerSlots, std::unique_ptr<const T> initial = std::make_unique<const T>())
+        : slots(readerSlots), slotUsed(readerSlots, false), current(initial.release()) {
+        if (readerSlots == 0) {
+            throw std::invalid_argument("A snapshot publisher needs at least one reader slot");
+        }
+    }
+    // No reader may be inside a read section any more
+    ~SnapshotPublisher() {
+        delete current.load();
+        for (const Retired& retired : retiredValues) {
+            delete retired.value;
+        }
+    }
+
+    SnapshotPublisher(const SnapshotPublisher&) = delete;
+    SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+
+    // --- Readers: one slot per thread that reads ---
+    // Throws std::runtime_error if every slot is taken
+    std::size_t registerReader() {
+        std::lock_guard<std::mutex> lock(slotMutex);
+        for (std::size_t slot = 0; slot < slotUsed.size(); ++slot) {
+            if (!slotUsed[slot]) {
+                slotUsed[slot] = true;
+                return slot;
+            }
+        }
+        throw std::runtime_error("All " + std::to_string(slotUsed.size()) + " reader slots are in use");
+    }
+    void unregisterReader(std::size_t slot) {
+        slots[slot].epoch.store(offline);
+        std::lock_guard<std::mutex> lock(slotMutex);
+        slotUsed[slot] = false;
+    }
+
+    // Starts a read section and returns the current value; it stays valid until leave()
+    const T* enter(std::size_t slot) {
+        slots[slot].epoch.store(epoch.load());
+        return current.load();
+    }
+    void leave(std::size_t slot) { slots[slot].epoch.store(offline); }
+
+    // --- Writer ---
+    // The value readers get from now on (what the writer builds the next one from)
+    const T* latest() const { return current.load(); }
+
+    // Replaces the current value; the old one is freed by this or a later
+    // publish/reclaim, once no read section can use it
+    void publish(std::unique_ptr<const T> next) {
+        const T* previous = current.exchange(next.release());
+        retiredValues.push_back(Retired{previous, epoch.fetch_add(1) + 1});
+        reclaim();
+    }
+
+    // Frees the retired values no reader can see any more; returns how many are left
+    std::size_t reclaim() {
+        // Sequentially consistent operations throughout: a reader whose slot shows an
+        // epoch >= a value's retire epoch entered after the exchange that retired it,
+        // and a reader still offline here loads the pointer after that exchange
+        std::uint64_t oldestReader = offline;
+        for (const Slot& slot : slots) {
+            oldestReader = std::min(oldestReader, slot.epoch.load());
+        }
+        std::size_t kept = 0;
+        for (const Retired& retired : retiredValues) {
+            if (retired.epoch <= oldestReader) {
+                delete retired.value;
+            } else {
+                retiredValues[kept++] = retired;
+            }
+        }
+        retiredValues.resize(kept);
+        return kept;
+    }
+
+private:
+    static constexpr std::uint64_t offline = std::numeric_limits<std::uint64_t>::max();
+
+    // The epoch a reader entered at, or offline; one cache line each, so readers
+    // on different cores do not invalidate each other's slot
+    struct alignas(64) Slot {
+        std::atomic<std::uint64_t> epoch{offline};
+    };
+    struct Retired {
+        const T* value;
+        std::uint64_t epoch; // Readers that entered at this epoch or later cannot see it
+    };
+
+    std::vector<Slot> slots;
+    std::mutex slotMutex;               // Guards slotUsed (registration only, never the read path)
+    std::vector<bool> slotUsed;
+    std::atomic<const T*> current;
+    std::atomic<std::uint64_t> epoch{0};
+    std::vector<Retired> retiredValues; // Writer side only
+};
+
+#endif // SNAPSHOTPUBLISHER_H
@@ -0,0 +1,107 @@
+#include "timeIndex.h"
+#include <algorithm>
+#include <numeric> // For std::iota, std::partial_sum
+
+namespace {
+
+// Writes rows [firstRow, timestamps.size()) to sortedRows ordered by timestamp, equal
+// timestamps in row order. Match minutes span a narrow range, so this is usually a
+// counting sort, linear in the rows; a wide range falls back to a comparison sort.
+void sortRowsByTimestamp(const ColumnView<int>& timestamps, std::size_t firstRow, std::vector<std::uint32_t>& sortedRows) {
+    const auto [lowest, highest] = std::minmax_element(timestamps.begin() + firstRow, timestamps.end());
+    const std::uint64_t range = static_cast<std::uint64_t>(static_cast<std::int64_t>(*highest) - *lowest) + 1;
+    if (range > std::max<std::size_t>(sortedRows.size(), 4096)) {
+        std::iota(sortedRows.begin(), sortedRows.end(), static_cast<std::uint32_t>(firstRow));
+        std::stable_sort(sortedRows.begin(), sortedRows.end(), [&](std::uint32_t a, std::uint32_t b) {
+            return timestamps[a] < timestamps[b];
+        });
+        return;
+    }
+    // starts[m] becomes the first output slot of minute lowest + m
+    std::vector<std::uint32_t> starts(static_cast<std::size_t>(range) + 1, 0);
+    for (std::size_t row = firstRow; row < timestamps.size(); ++row) {
+        starts[static_cast<std::size_t>(timestamps[row] - *lowest) + 1] += 1;
+    }
+    std::partial_sum(starts.begin(), starts.end(), starts.begin());
+    for (std::size_t row = firstRow; row < timestamps.size(); ++row) {
+        sortedRows[starts[static_cast<std::size_t>(timestamps[row] - *lowest)]++] = static_cast<std::uint32_t>(row);
+    }
+}
+
+} // namespace
+
+void TimeIndex::build(const EventStore& events) {
+    clear();
+    extend(events);
+}
+
+void TimeIndex::extend(const EventStore& events) {
+    if (events.size() < sortedRows.size()) {
+        clear(); // The store was reset under us, index it from scratch
+    }
+    const std::size_t firstNewRow = sortedRows.size();
+    const std::size_t newRowCount = events.size() - firstNewRow;
+    if (newRowCount == 0) {
+        return;
+    }
+    const ColumnView<int> timestamps = events.timestamps();
+
+    // Order the new rows among themselves; stable so equal minutes keep file order
+    std::vector<std::uint32_t> newRows(newRowCount);
+    if (std::is_sorted(timestamps.begin() + firstNewRow, timestamps.end())) {
+        std::iota(newRows.begin(), newRows.end(), static_cast<std::uint32_t>(firstNewRow));
+    } else {
+        sortRowsByTimestamp(timestamps, firstNewRow, newRows);
+    }
+
+    const bool appendsInOrder = sortedTimestamps.empty() || sortedTimestamps.back() <= timestamps[newRows.front()];
+    sortedRows.insert(sortedRows.end(), newRows.begin(), newRows.end());
+    if (appendsInOrder) {
+        const std::size_t firstNewPosition = sortedTimestamps.size();
+        sortedTimestamps.resize(firstNewPosition + newRowCount);
+        for (std::size_t i = 0; i < newRowCount; ++i) {
+            sortedTimestamps[firstNewPosition + i] = timestamps[newRows[i]];
+        }
+        return;
+    }
+
+    // Some new events are older than already indexed ones. The merge keeps old rows
+    // first on equal minutes, which is file order since new rows come later in the file.
+    std::inplace_merge(sortedRows.begin(), sortedRows.begin() + firstNewRow, sortedRows.end(),
+                       [&](std::uint32_t a, std::uint32_t b) { return timestamps[a] < timestamps[b]; });
+    sortedTimestamps.resize(sortedRows.size());
+    for (std::size_t i = 0; i < sortedRows.size(); ++i) {
+        sortedTimestamps[i] = timestamps[sortedRows[i]];
+    }
+}
+
+void TimeIndex::clear() {
+    sortedRows.clear();
+    sortedTimestamps.clear();
+}
+
+EventIndexView TimeIndex::eventsBetween(const EventStore& events, int startMinute, int endMinute) const {
+    if (startMinute > endMinute) {
+        return EventIndexView(events, sortedRows.data(), 0);
+    }
+    const auto first = std::lower_bound(sortedTimestamps.begin(), sortedTimestamps.end(), startMinute);
+    const auto last = std::upper_bound(first, sortedTimestamps.end(), endMinute);
+    return EventIndexView(events, sortedRows.data() + (first - sortedTimestamps.begin()),
+                          static_cast<std::size_t>(last - first));
+}
+
+std::vector<TimeWindow> mergeTimeWindows(std::vector<TimeWindow> windows) {
+    std::sort(windows.begin(), windows.end(), [](const TimeWindow& a, const TimeWindow& b) {
+        return a.startMinute < b.startMinute;
+    });
+
+    std::vector<TimeWindow> merged;
+    for (const TimeWindow& window : windows) {
+        if (!merged.empty() && window.startMinute <= merged.back().endMinute) {
+            merged.back().endMinute = std::max(merged.back().endMinute, window.endMinute);
+        } else {
+            merged.push_back(window);
+        }
+    }
+    return merged;
+}
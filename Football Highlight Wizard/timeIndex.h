@@ -0,0 +1,46 @@
+#ifndef TIMEINDEX_H
+#define TIMEINDEX_H
+
+#include "eventStore.h"
+#include <cstdint>
+#include <vector>
+
+// A closed interval of match minutes, [startMinute, endMinute]
+struct TimeWindow {
+    int startMinute = 0;
+    int endMinute = 0;
+};
+
+// Rows of an EventStore ordered by timestamp, for O(log n) range queries.
+// Logs are not guaranteed to be sorted, so the index keeps its own order;
+// events with the same minute stay in file order. An already sorted log
+// costs one linear check to index.
+class TimeIndex {
+public:
+    // Indexes every row of the store, replacing the previous index
+    void build(const EventStore& events);
+
+    // Indexes the rows appended to the store since the last build/extend
+    // In-order appends (the live case) cost O(new rows); late events are merged in.
+    void extend(const EventStore& events);
+
+    void clear();
+
+    std::size_t size() const { return sortedRows.size(); }
+
+    // Events with startMinute <= timestamp <= endMinute, in time order
+    // The view points into the index: it is invalidated by build/extend/clear
+    EventIndexView eventsBetween(const EventStore& events, int startMinute, int endMinute) const;
+
+    // All indexed rows in time order
+    const std::vector<std::uint32_t>& rowsInTimeOrder() const { return sortedRows; }
+
+private:
+    std::vector<std::uint32_t> sortedRows;  // Row indices ordered by (timestamp, row)
+    std::vector<int> sortedTimestamps;      // Timestamps in the same order, searched contiguously
+};
+
+// Sorts windows by start and merges the ones that overlap (share at least one minute)
+std::vector<TimeWindow> mergeTimeWindows(std::vector<TimeWindow> windows);
+
+#endif // TIMEINDEX_H
@@ -0,0 +1,142 @@
+#include "workStealingPool.h"
+#include <utility> // For std::move
+
+namespace {
+
+// Lets submit() recognise calls coming from one of the pool's own workers
+thread_local const WorkStealingPool* currentPool = nullptr;
+thread_local std::size_t currentWorkerIndex = 0;
+
+} // namespace
+
+WorkStealingPool::WorkStealingPool(unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+    if (threadCount == 0) {
+        threadCount = 1; // hardware_concurrency() may not know
+    }
+
+    queues.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    workers.reserve(threadCount);
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    try {
+        wait();
+    } catch (...) {
+        // Nobody is left to report task errors to
+    }
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void WorkStealingPool::submit(Task task) {
+    {
+        // Count the task before it becomes visible, so a worker can never take it
+        // and decrement the counters before they were incremented
+        std::lock_guard<std::mutex> lock(stateMutex);
+        ++queuedTasks;
+        ++unfinishedTasks;
+    }
+
+    std::size_t target = (currentPool == this)
+                             ? currentWorkerIndex
+                             : nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    workAvailable.notify_one();
+}
+
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(stateMutex);
+    allTasksDone.wait(lock, [this] { return unfinishedTasks == 0; });
+    if (firstError) {
+        std::exception_ptr error = std::move(firstError);
+        firstError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void WorkStealingPool::workerLoop(std::size_t index) {
+    currentPool = this;
+    currentWorkerIndex = index;
+
+    for (;;) {
+        Task task;
+        if (tryTakeTask(index, task)) {
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                --queuedTasks;
+            }
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                if (!firstError) {
+                    firstError = std::current_exception();
+                }
+            }
+            finishTask();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(stateMutex);
+        if (queuedTasks > 0) {
+            // A task was counted but is not in a deque yet, or another worker is
+            // just taking it. Try again instead of sleeping through it.
+            lock.unlock();
+            std::this_thread::yield();
+            continue;
+        }
+        if (stopping) {
+            return;
+        }
+        workAvailable.wait(lock, [this] { return stopping || queuedTasks > 0; });
+    }
+}
+
+bool WorkStealingPool::tryTakeTask(std::size_t index, Task& task) {
+    // Own deque first, newest task (still warm in cache)
+    {
+        WorkerQueue& own = *queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    // Then steal the oldest task of the next worker that has one
+    for (std::size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkerQueue& victim = *queues[(index + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::finishTask() {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    if (--unfinishedTasks == 0) {
+        allTasksDone.notify_all();
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed-size thread pool where every worker owns a task deque.
+// A worker pops its own newest task first and, when it runs dry, steals the
+// oldest task from another worker, so uneven jobs (a few huge match logs
+// among thousands of small ones) still keep every core busy.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    // threadCount == 0 uses one worker per hardware core
+    explicit WorkStealingPool(unsigned threadCount = 0);
+
+    // Waits for the queued tasks to finish, then stops the workers
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    // Queues a task. Called from a worker it goes to that worker's own deque,
+    // otherwise tasks are spread round-robin over all workers.
+    void submit(Task task);
+
+    // Blocks until every submitted task has finished
+    // Rethrows the first exception that escaped a task, if any
+    void wait();
+
+    unsigned threadCount() const { return static_cast<unsigned>(workers.size()); }
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::mutex stateMutex;                   // Guards the sleeping/finishing hand-off below
+    std::condition_variable workAvailable;   // Signalled when a task is queued or on shutdown
+    std::condition_variable allTasksDone;    // Signalled when unfinishedTasks drops to zero
+    std::size_t queuedTasks = 0;             // Tasks sitting in some deque
+    std::size_t unfinishedTasks = 0;         // Tasks queued or running
+    bool stopping = false;
+    std::exception_ptr firstError;
+
+    std::atomic<std::size_t> nextQueue{0};
+
+    void workerLoop(std::size_t index);
+    bool tryTakeTask(std::size_t index, Task& task);
+    void finishTask();
+};
+
+#endif // WORKSTEALINGPOOL_H
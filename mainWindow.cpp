@@ -1,17 +1,50 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h" // Include this if using Qt Designer's generated UI class
+#include "eventListModel.h"
+#include <QCheckBox>
+#include <QDir>
 #include <QFileDialog>
+#include <QInputDialog>
 #include <QMessageBox>
 #include <QDebug> // For printing debug messages
+#include <QLocale>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QtConcurrent/QtConcurrentRun>
+#include <fstream>
+#include <sstream>
 
 // If NOT using Qt Designer, you'll need to include necessary widgets here:
 #include <QPushButton>
 #include <QListWidget>
+#include <QListView>
 #include <QLabel>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QStatusBar> // If adding status bar manually
 
+namespace {
+
+// Puts a QListView on the model where the form has a QListWidget. A list widget
+// holds one item per row; the view only asks the model for the rows on screen.
+QListView *replaceWithListView(QListWidget *listWidget, QAbstractItemModel *model)
+{
+    QWidget *parent = listWidget->parentWidget();
+    QListView *view = new QListView(parent);
+    view->setObjectName(listWidget->objectName());
+    view->setUniformItemSizes(true); // Every row is one line: size one, not millions
+    view->setModel(model);
+    if (parent && parent->layout()) {
+        parent->layout()->replaceWidget(listWidget, view);
+    } else {
+        view->setGeometry(listWidget->geometry());
+    }
+    delete listWidget;
+    return view;
+}
+
+} // namespace
+
 // Constructor
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -19,12 +52,44 @@ MainWindow::MainWindow(QWidget *parent)
 {
     // If using Qt Designer:
     ui->setupUi(this);
+    eventsModel = new EventListModel(this);
+    highlightsModel = new EventListModel(this);
+    eventsListView = replaceWithListView(ui->eventsListWidget, eventsModel);
+    highlightsListView = replaceWithListView(ui->highlightsListWidget, highlightsModel);
+    ui->eventsListWidget = nullptr; // Deleted, the views above took their place
+    ui->highlightsListWidget = nullptr;
     // Optional: Set initial state
     ui->findHighlightsButton->setEnabled(false); // Disable until log is loaded
-    ui->highlightsListWidget->addItem("Load an event log and click 'Find Highlights'.");
-    ui->eventsListWidget->addItem("No event log loaded.");
+    highlightsModel->showMessage("Load an event log and click 'Find Highlights'.");
+    eventsModel->showMessage("No event log loaded.");
     statusBar()->showMessage("Ready."); // Show initial status
 
+    // Loading and analysis run on worker threads; these bring the results back
+    cancelButton = new QPushButton("Cancel", this);
+    cancelButton->hide();
+    statusBar()->addPermanentWidget(cancelButton);
+    connect(cancelButton, &QPushButton::clicked, this, &MainWindow::cancelLoading);
+    exportCutListButton = new QPushButton("Export Cut List...", this);
+    exportCutListButton->setEnabled(false); // Needs a video and highlights
+    statusBar()->addPermanentWidget(exportCutListButton);
+    connect(exportCutListButton, &QPushButton::clicked, this, &MainWindow::exportCutList);
+    exportEventsButton = new QPushButton("Export Events...", this);
+    exportEventsButton->setEnabled(false); // Needs a loaded log
+    statusBar()->addPermanentWidget(exportEventsButton);
+    connect(exportEventsButton, &QPushButton::clicked, this, &MainWindow::exportEvents);
+    // Opt-in, as --cache is in the CLI; the choice is remembered between sessions
+    eventCacheCheckBox = new QCheckBox("Cache parsed logs", this);
+    eventCacheCheckBox->setToolTip("Keep the parsed events of each log in your cache directory, "
+                                   "so an unchanged log opens without being parsed again");
+    eventCacheCheckBox->setChecked(QSettings().value("eventCache", false).toBool());
+    statusBar()->addPermanentWidget(eventCacheCheckBox);
+    connect(eventCacheCheckBox, &QCheckBox::toggled, this, [](bool checked) {
+        QSettings().setValue("eventCache", checked);
+    });
+    connect(&loadWatcher, &QFutureWatcher<LoadResult>::finished, this, &MainWindow::onLoadFinished);
+    connect(&highlightsWatcher, &QFutureWatcher<HighlightWizard::ComputedHighlights>::finished,
+            this, &MainWindow::onHighlightsFinished);
+
     // --- If Creating UI Manually (Example - place this code instead of ui->setupUi(this)) ---
     /*
     setWindowTitle("Football Highlight Wizard");
@@ -91,6 +156,10 @@ MainWindow::MainWindow(QWidget *parent)
 // Destructor
 MainWindow::~MainWindow()
 {
+    // Workers use the window (the analysis reads its wizard): stop them first
+    cancelRequested = true;
+    loadWatcher.waitForFinished();
+    highlightsWatcher.waitForFinished();
     // If using Qt Designer
     delete ui;
 }
@@ -103,33 +172,11 @@ void MainWindow::on_loadEventsButton_clicked()
         this,
         "Open Event Log File",
         "", // Start directory (empty for default)
-        "Log Files (*.log *.txt);;All Files (*)" // Filter
+        "Log Files (*.log *.txt *.gz *.zst);;All Files (*)" // Filter (compressed logs load as they are)
     );
 
     if (!filePath.isEmpty()) {
-        currentEventLogPath = filePath;
-        // Update UI label (assuming you have one named 'eventFilePathLabel')
-        if (ui) ui->eventFilePathLabel->setText(QFileInfo(filePath).fileName()); // Show only filename
-        // else eventFilePathLabel->setText(QFileInfo(filePath).fileName()); // If manual UI
-
-        setStatusMessage("Loading events from: " + filePath);
-        try {
-            // Call the backend logic
-            wizard.loadEventsFromFile(filePath.toStdString()); // Convert QString to std::string
-            displayEvents(); // Update the list view
-            ui->findHighlightsButton->setEnabled(true); // Enable the find button
-            // Clear previous highlights if loading new file
-            ui->highlightsListWidget->clear();
-             ui->highlightsListWidget->addItem("Events loaded. Click 'Find Highlights'.");
-            setStatusMessage("Events loaded successfully.", 5000);
-
-        } catch (const std::exception& e) {
-            QMessageBox::critical(this, "Error Loading Log", QString("Failed to load event log:\n%1").arg(e.what()));
-            ui->findHighlightsButton->setEnabled(false); // Disable button on error
-             ui->eventsListWidget->clear();
-             ui->eventsListWidget->addItem("Failed to load events.");
-            setStatusMessage("Error loading events.", 5000);
-        }
+        startLoading(filePath);
     } else {
         setStatusMessage("Event log loading cancelled.");
     }
@@ -142,13 +189,24 @@ void MainWindow::on_findHighlightsButton_clicked()
         return;
     }
 
-    setStatusMessage("Finding highlights...");
+    setStatusMessage("Finding highlights...", 0);
+    setBusy(true);
+    // computeHighlights only reads the wizard (its time comes back with the rows),
+    // like the panes painting it meanwhile; nothing modifies it until
+    // onHighlightsFinished adopts the result on this thread
+    highlightsWatcher.setFuture(QtConcurrent::run([this] { return wizard.computeHighlights(); }));
+}
+
+void MainWindow::onHighlightsFinished()
+{
+    setBusy(false);
     try {
-        // IMPORTANT: For long operations (like real video processing would be),
-        // this should be run in a separate thread using QtConcurrent::run or QThread
-        // to avoid freezing the GUI. For simple text parsing, it's likely okay here.
-        wizard.findHighlights();
+        HighlightWizard::ComputedHighlights highlights = highlightsWatcher.future().takeResult();
+        highlightsModel->showMessage(QString()); // Detach from the old highlights first
+        wizard.adoptHighlights(std::move(highlights));
         displayHighlights(); // Update the highlight list view
+        updateExportCutListButton();
+        logPipelineStats();
         setStatusMessage("Highlight analysis complete.", 5000);
 
     } catch (const std::exception& e) {
@@ -158,31 +216,166 @@ void MainWindow::on_findHighlightsButton_clicked()
     }
 }
 
+void MainWindow::cancelLoading()
+{
+    cancelRequested = true; // The parser stops at its next progress report
+    cancelButton->setEnabled(false);
+    statusBar()->showMessage("Cancelling...");
+}
+
 void MainWindow::on_loadVideoButton_clicked()
 {
      QString filePath = QFileDialog::getOpenFileName(
         this,
         "Select Video File",
         "", // Start directory
-        "Video Files (*.mp4 *.avi *.mov);;All Files (*)" // Filter
+        "Video Files (*.mp4 *.m4v *.mov);;All Files (*)" // Filter (MP4/QuickTime: their index is read, not the frames)
     );
 
-    if (!filePath.isEmpty()) {
-        currentVideoPath = filePath;
-        // Update UI label (assuming you have one named 'videoFilePathLabel')
-        if (ui) ui->videoFilePathLabel->setText(QFileInfo(filePath).fileName());
-        // else videoFilePathLabel->setText(QFileInfo(filePath).fileName()); // If manual UI
-        setStatusMessage("Video file selected: " + QFileInfo(filePath).fileName(), 5000);
-        QMessageBox::information(this, "Video Selected",
-            QString("Video file selected:\n%1\n\n(Note: Video processing is not yet implemented)").arg(filePath));
-        // ---- TODO: Future Implementation ----
-        // - Store this path
-        // - Potentially load video into a QMediaPlayer widget
-        // - Enable functionality that uses this video (e.g., seeking based on highlights)
-        // -----------------------------------
+    if (filePath.isEmpty()) {
+        setStatusMessage("Video selection cancelled.");
+        return;
+    }
+    try {
+        // Only the container's sample tables are read, in milliseconds even for a whole match
+        videoKeyframes = KeyframeIndex::fromFile(filePath.toStdString());
+    } catch (const std::exception& e) {
+        videoKeyframes = KeyframeIndex();
+        currentVideoPath.clear();
+        if (ui) ui->videoFilePathLabel->setText("No video selected.");
+        updateExportCutListButton();
+        QMessageBox::critical(this, "Error Reading Video", QString("Could not index the video:\n%1").arg(e.what()));
+        setStatusMessage("Error reading video.", 5000);
+        return;
+    }
+    currentVideoPath = filePath;
+    // Update UI label (assuming you have one named 'videoFilePathLabel')
+    if (ui) ui->videoFilePathLabel->setText(QFileInfo(filePath).fileName());
+    // else videoFilePathLabel->setText(QFileInfo(filePath).fileName()); // If manual UI
+    updateExportCutListButton();
+    setStatusMessage(QString("Video indexed: %1 keyframes, %2 fps, %3 min.")
+                     .arg(static_cast<qulonglong>(videoKeyframes.size()))
+                     .arg(videoKeyframes.frameRate(), 0, 'f', 2)
+                     .arg(videoKeyframes.durationSeconds() / 60, 0, 'f', 1), 5000);
+}
 
-    } else {
-         setStatusMessage("Video selection cancelled.");
+void MainWindow::exportCutList()
+{
+    if (videoKeyframes.empty() || wizard.getHighlights().empty()) {
+        QMessageBox::warning(this, "Nothing to Cut", "Select a video and find the highlights first.");
+        return;
+    }
+    bool accepted = false;
+    const double kickoff = QInputDialog::getDouble(this, "Export Cut List",
+        "Video time of the kickoff (seconds):", cutListOptions.kickoffSeconds,
+        0, videoKeyframes.durationSeconds(), 1, &accepted);
+    if (!accepted) {
+        return;
+    }
+    const double secondHalf = QInputDialog::getDouble(this, "Export Cut List",
+        "Video time of the second-half kickoff (seconds, -1 if the video runs on):",
+        cutListOptions.secondHalfKickoffSeconds, -1, videoKeyframes.durationSeconds(), 1, &accepted);
+    if (!accepted) {
+        return;
+    }
+    cutListOptions.kickoffSeconds = kickoff;
+    cutListOptions.secondHalfKickoffSeconds = secondHalf;
+
+    const QFileInfo video(currentVideoPath);
+    QString selectedFilter;
+    const QString filePath = QFileDialog::getSaveFileName(
+        this,
+        "Export Cut List",
+        video.dir().filePath(video.completeBaseName() + ".cuts.edl"),
+        "Edit Decision List (*.edl);;JSON (*.json)",
+        &selectedFilter
+    );
+    if (filePath.isEmpty()) {
+        setStatusMessage("Cut list export cancelled.");
+        return;
+    }
+
+    try {
+        const CutList cutList = buildCutList(wizard.scoreHighlights(), videoKeyframes, cutListOptions);
+        std::ofstream out(filePath.toStdString());
+        if (!out.is_open()) {
+            throw std::runtime_error("Could not write cut list: " + filePath.toStdString());
+        }
+        if (filePath.endsWith(".json", Qt::CaseInsensitive) || selectedFilter.startsWith("JSON")) {
+            writeCutListJson(out, cutList, wizard.getAllEvents(), videoKeyframes, video.fileName().toStdString());
+        } else {
+            writeCutListEdl(out, cutList, wizard.getAllEvents(), videoKeyframes,
+                            QFileInfo(currentEventLogPath).completeBaseName().toStdString(),
+                            video.fileName().toStdString());
+        }
+        setStatusMessage(QString("Cut list written: %1 cut(s), %2 s%3.")
+                         .arg(static_cast<qulonglong>(cutList.cuts.size()))
+                         .arg(cutList.totalSeconds, 0, 'f', 1)
+                         .arg(cutList.outsideVideo == 0 ? QString()
+                              : QString(", %1 highlight(s) after the end of the video").arg(
+                                    static_cast<qulonglong>(cutList.outsideVideo))), 5000);
+    } catch (const std::exception& e) {
+        QMessageBox::critical(this, "Error Exporting Cut List", QString("An error occurred:\n%1").arg(e.what()));
+        setStatusMessage("Error exporting cut list.", 5000);
+    }
+}
+
+void MainWindow::exportEvents()
+{
+    if (currentEventLogPath.isEmpty()) {
+        QMessageBox::warning(this, "Nothing to Export", "Load an event log first.");
+        return;
+    }
+    QStringList contents = {"All events"};
+    if (!wizard.getHighlights().empty()) {
+        contents << "Highlights";
+    }
+    bool accepted = false;
+    const QString content = QInputDialog::getItem(this, "Export Events", "Export:", contents,
+                                                  contents.size() - 1, false, &accepted);
+    if (!accepted) {
+        return;
+    }
+    const bool highlightsOnly = content == "Highlights";
+
+    const QFileInfo log(currentEventLogPath);
+    QString selectedFilter;
+    const QString filePath = QFileDialog::getSaveFileName(
+        this,
+        "Export Events",
+        log.dir().filePath(log.completeBaseName() + (highlightsOnly ? ".highlights.jsonl" : ".events.jsonl")),
+        "JSON Lines (*.jsonl);;CSV (*.csv);;Highlight Wizard binary (*.hwe)",
+        &selectedFilter
+    );
+    if (filePath.isEmpty()) {
+        setStatusMessage("Export cancelled.");
+        return;
+    }
+    // The extension decides; the filter only if the name has none of the three
+    ExportFormat format = ExportFormat::JSON_LINES;
+    if (filePath.endsWith(".csv", Qt::CaseInsensitive) ||
+        (!filePath.endsWith(".jsonl", Qt::CaseInsensitive) && selectedFilter.startsWith("CSV"))) {
+        format = ExportFormat::CSV;
+    } else if (filePath.endsWith(".hwe", Qt::CaseInsensitive) ||
+               (!filePath.endsWith(".jsonl", Qt::CaseInsensitive) && selectedFilter.startsWith("Highlight"))) {
+        format = ExportFormat::BINARY;
+    }
+
+    try {
+        // Streamed through a fixed buffer: even millions of events take no extra memory
+        std::ofstream out(filePath.toStdString(), std::ios::binary);
+        if (!out.is_open()) {
+            throw std::runtime_error("Could not write export: " + filePath.toStdString());
+        }
+        const std::uint64_t bytes = highlightsOnly ? wizard.exportHighlights(out, format)
+                                                   : wizard.exportEvents(out, format);
+        const std::size_t count = highlightsOnly ? wizard.getHighlights().size() : wizard.getAllEvents().size();
+        setStatusMessage(QString("Exported %1 event(s) (%2).")
+                         .arg(static_cast<qulonglong>(count))
+                         .arg(QLocale().formattedDataSize(static_cast<qint64>(bytes))), 5000);
+    } catch (const std::exception& e) {
+        QMessageBox::critical(this, "Error Exporting Events", QString("An error occurred:\n%1").arg(e.what()));
+        setStatusMessage("Error exporting events.", 5000);
     }
 }
 
@@ -191,69 +384,167 @@ void MainWindow::on_loadVideoButton_clicked()
 
 void MainWindow::displayEvents()
 {
-     // Choose ONE of these (ListWidget or TableView)
-    // --- Using QListWidget ---
-    if (ui) ui->eventsListWidget->clear();
-    // else eventsListWidget->clear(); // If manual UI
-
-    try {
-         const auto& allEvents = wizard.getAllEvents(); // Assuming you add this getter to HighlightWizard
-         if (allEvents.empty()){
-              if (ui) ui->eventsListWidget->addItem("No events loaded or log was empty.");
-              // else eventsListWidget->addItem("No events loaded or log was empty.");
-              return;
-         }
-
-         for (const auto& event : allEvents) {
-             QString itemText = QString("[%1'] %2: %3")
-                                .arg(event.timestampMinutes)
-                                .arg(QString::fromStdString(GameEvent::typeToString(event.type)))
-                                .arg(QString::fromStdString(event.description));
-             if (ui) ui->eventsListWidget->addItem(itemText);
-             // else eventsListWidget->addItem(itemText); // If manual UI
-         }
-    } catch(const std::exception& e) {
-         qWarning() << "Error retrieving events for display: " << e.what();
-         if (ui) ui->eventsListWidget->addItem("Error displaying events.");
-         // else eventsListWidget->addItem("Error displaying events.");
+    // The model formats rows straight from the wizard's event store as they
+    // scroll into view, so this takes the same time for ten events or millions
+    ScopedStage stage(wizard.getPipelineStats(), PipelineStage::GUI_POPULATION);
+    const EventStore& allEvents = wizard.getAllEvents();
+    stage.addItems(allEvents.size());
+    if (allEvents.empty()) {
+        eventsModel->showMessage("No events loaded or log was empty.");
+        return;
     }
-     // --- OR Using QTableView (More complex setup required: QStandardItemModel) ---
-    // ... involves creating a model, setting headers, populating rows/columns ...
+    eventsModel->showEvents(allEvents);
 }
 
 void MainWindow::displayHighlights()
 {
-    // Choose ONE of these (ListWidget or TableView)
-    // --- Using QListWidget ---
-     if (ui) ui->highlightsListWidget->clear();
-    // else highlightsListWidget->clear(); // If manual UI
+    ScopedStage stage(wizard.getPipelineStats(), PipelineStage::GUI_POPULATION);
+    const EventIndexView highlights = wizard.getHighlights(); // Rows of the event store, not copies
+    stage.addItems(highlights.size());
+    if (highlights.empty()) {
+        highlightsModel->showMessage("No highlights found.");
+        return;
+    }
+    highlightsModel->showRows(highlights);
+}
 
-    try {
-        const auto& highlights = wizard.getHighlights();
-        if (highlights.empty()) {
-             if (ui) ui->highlightsListWidget->addItem("No highlights found.");
-            // else highlightsListWidget->addItem("No highlights found."); // If manual UI
-        } else {
-            for (const auto& event : highlights) {
-                QString itemText = QString("[%1'] %2: %3")
-                                   .arg(event.timestampMinutes)
-                                   .arg(QString::fromStdString(GameEvent::typeToString(event.type)))
-                                   .arg(QString::fromStdString(event.description));
-                if (ui) ui->highlightsListWidget->addItem(itemText);
-                // else highlightsListWidget->addItem(itemText); // If manual UI
-            }
+void MainWindow::startLoading(const QString& filePath)
+{
+    pendingEventLogPath = filePath;
+    cancelRequested = false;
+    setStatusMessage("Loading events from: " + filePath, 0);
+    setBusy(true, true);
+
+    LoadOptions options = wizard.getLoadOptions();
+    const LoadOptions plainOptions = options;
+    options.threadCount = 0; // The window is idle meanwhile: parse on every core
+    options.lenient = true;  // Keep the good lines of a noisy log; the bad ones are reported below
+    options.reportDiagnostics = false;
+    if (eventCacheCheckBox->isChecked()) {
+        // Never beside the log: the user's cache directory is writable, and local
+        const QString cacheDirectory =
+            QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/events";
+        if (QDir().mkpath(cacheDirectory)) {
+            options.useEventCache = true;
+            options.eventCacheDirectory = cacheDirectory.toStdString();
+        }
+    }
+    options.cancelFlag = &cancelRequested;
+    options.progressCallback = [this](const LoadProgress& progress) {
+        // Runs on a parser thread: hand the numbers over to the GUI thread
+        QMetaObject::invokeMethod(this, [this, progress] { showLoadProgress(progress); }, Qt::QueuedConnection);
+    };
+    const HighlightRuleSet rules = wizard.getHighlightRules();
+    const std::string path = filePath.toStdString(); // Convert QString to std::string
+
+    loadWatcher.setFuture(QtConcurrent::run([options, plainOptions, rules, path] {
+        LoadResult result;
+        result.wizard.setHighlightRules(rules);
+        result.wizard.setLoadOptions(options);
+        try {
+            // Call the backend logic
+            result.wizard.loadEventsFromFile(path);
+        } catch (const LoadCancelled&) {
+            result.cancelled = true;
+        } catch (const std::exception& e) {
+            result.error = QString::fromUtf8(e.what());
         }
-    } catch(const std::exception& e) {
-         qWarning() << "Error retrieving highlights for display: " << e.what();
-          if (ui) ui->highlightsListWidget->addItem("Error displaying highlights.");
-         // else highlightsListWidget->addItem("Error displaying highlights.");
+        result.wizard.setLoadOptions(plainOptions); // Drop the callback into this window
+        return result;
+    }));
+}
+
+void MainWindow::showLoadProgress(const LoadProgress& progress)
+{
+    if (!loadWatcher.isRunning() || cancelRequested) {
+        return; // A late report, the load is over
+    }
+    const QLocale locale;
+    const int percent = progress.totalBytes == 0
+        ? 100 : static_cast<int>(progress.bytesParsed * 100 / progress.totalBytes);
+    statusBar()->showMessage(QString("Loading... %1% (%2 of %3, %4 events)")
+                             .arg(percent)
+                             .arg(locale.formattedDataSize(static_cast<qint64>(progress.bytesParsed)))
+                             .arg(locale.formattedDataSize(static_cast<qint64>(progress.totalBytes)))
+                             .arg(locale.toString(static_cast<qulonglong>(progress.eventsParsed))));
+}
+
+void MainWindow::onLoadFinished()
+{
+    LoadResult result = loadWatcher.future().takeResult();
+    setBusy(false);
+
+    if (result.cancelled) {
+        // The previous log (if any) was never touched and is still shown
+        setStatusMessage("Event log loading cancelled.", 5000);
+        return;
+    }
+    if (!result.error.isEmpty()) {
+        ui->findHighlightsButton->setEnabled(false); // Disable button on error
+        exportEventsButton->setEnabled(false);
+        eventsModel->showMessage("Failed to load events.");
+        highlightsModel->showMessage(QString());
+        currentEventLogPath.clear();
+        QMessageBox::critical(this, "Error Loading Log", QString("Failed to load event log:\n%1").arg(result.error));
+        setStatusMessage("Error loading events.", 5000);
+        return;
     }
 
-    // --- OR Using QTableView ---
-    // ... similar setup to displayEvents using a model ...
+    // The panes point into the old wizard: detach them, then move the new one in
+    eventsModel->showMessage(QString());
+    highlightsModel->showMessage(QString());
+    wizard = std::move(result.wizard);
+    updateExportCutListButton(); // The new log has no highlights yet
+
+    currentEventLogPath = pendingEventLogPath;
+    // Update UI label (assuming you have one named 'eventFilePathLabel')
+    if (ui) ui->eventFilePathLabel->setText(QFileInfo(currentEventLogPath).fileName()); // Show only filename
+    // else eventFilePathLabel->setText(QFileInfo(filePath).fileName()); // If manual UI
+    displayEvents(); // Update the list view
+    ui->findHighlightsButton->setEnabled(true); // Enable the find button
+    exportEventsButton->setEnabled(true);
+    // Clear previous highlights if loading new file
+    highlightsModel->showMessage("Events loaded. Click 'Find Highlights'.");
+    logPipelineStats();
+
+    const ParseDiagnostics& diagnostics = wizard.getParseDiagnostics();
+    if (diagnostics.empty()) {
+        setStatusMessage("Events loaded successfully.", 5000);
+        return;
+    }
+    std::ostringstream details;
+    diagnostics.write(details, currentEventLogPath.toStdString());
+    qDebug().noquote() << QString::fromStdString(details.str());
+    setStatusMessage(QString("Events loaded: %1 malformed line(s) skipped, %2 unknown event type(s).")
+                     .arg(static_cast<qulonglong>(diagnostics.errorCount()))
+                     .arg(static_cast<qulonglong>(diagnostics.warningCount())), 0);
+}
+
+void MainWindow::setBusy(bool busy, bool cancellable)
+{
+    ui->loadEventsButton->setEnabled(!busy);
+    ui->findHighlightsButton->setEnabled(!busy && !currentEventLogPath.isEmpty());
+    exportEventsButton->setEnabled(!busy && !currentEventLogPath.isEmpty());
+    cancelButton->setEnabled(true);
+    cancelButton->setVisible(busy && cancellable);
+    exportCutListButton->setEnabled(!busy && !videoKeyframes.empty() && !wizard.getHighlights().empty());
+}
+
+void MainWindow::updateExportCutListButton()
+{
+    exportCutListButton->setEnabled(!videoKeyframes.empty() && !wizard.getHighlights().empty());
 }
 
 // Helper to show messages in the status bar
+void MainWindow::logPipelineStats() const
+{
+    if constexpr (instrumentationEnabled) {
+        std::ostringstream json;
+        wizard.getPipelineStats().writeJson(json);
+        qDebug().noquote() << "Pipeline stats:" << QString::fromStdString(json.str());
+    }
+}
+
 void MainWindow::setStatusMessage(const QString& message, int timeout) {
     if (statusBar()) { // Check if status bar exists
         statusBar()->showMessage(message, timeout);
@@ -3,8 +3,18 @@
 
 #include <QMainWindow>
 #include <QString>
-#include <QListWidgetItem> // Or QStandardItemModel if using QTableView
+#include <QFutureWatcher>
+#include <atomic>
+#include <cstdint>
+#include <vector>
 #include "highlightWizard.h" // Include the backend logic
+#include "cutList.h"
+#include "keyframeIndex.h"
+
+class EventListModel;
+class QCheckBox;
+class QListView;
+class QPushButton;
 
 // Forward declarations for UI elements (if using Qt Designer promote)
 QT_BEGIN_NAMESPACE
@@ -23,7 +33,14 @@ private slots:
     // Slots to connect to button clicks etc.
     void on_loadEventsButton_clicked();
     void on_findHighlightsButton_clicked();
-    void on_loadVideoButton_clicked(); // Placeholder for video file selection
+    void on_loadVideoButton_clicked(); // Indexes the keyframes of the match video
+    void exportCutList();              // Writes the cut list of the highlights for the video
+    void exportEvents();               // Writes the events or the highlights as JSON Lines, CSV or binary
+
+    // Background work (see startLoading and on_findHighlightsButton_clicked)
+    void onLoadFinished();
+    void onHighlightsFinished();
+    void cancelLoading();
 
 private:
     // --- UI Elements ---
@@ -40,15 +57,45 @@ private:
     // QLabel *videoFilePathLabel;
     // ... other layout managers etc.
 
+    // The event panes are virtualized: the list views read rows from these models
+    // on demand instead of holding one item per event
+    EventListModel *eventsModel;
+    EventListModel *highlightsModel;
+    QListView *eventsListView;
+    QListView *highlightsListView;
+
     // --- Data Members ---
     HighlightWizard wizard;        // Instance of our backend logic class
     QString currentEventLogPath; // Store the path to the loaded log file
+    QString pendingEventLogPath; // Log being loaded in the background
+
+    // A log is loaded into a wizard of its own on a worker thread, so the window
+    // keeps showing the previous one until the result is moved in (never copied)
+    struct LoadResult {
+        HighlightWizard wizard;
+        QString error;          // Empty on success
+        bool cancelled = false;
+    };
+    QFutureWatcher<LoadResult> loadWatcher;
+    QFutureWatcher<HighlightWizard::ComputedHighlights> highlightsWatcher; // Rows found by computeHighlights
+    std::atomic<bool> cancelRequested{false}; // Polled by the parser threads
+    QPushButton *cancelButton;                // In the status bar while a load runs
     QString currentVideoPath;    // Store the path to the selected video file
+    KeyframeIndex videoKeyframes; // Of the selected video; empty if none is indexed
+    CutListOptions cutListOptions; // Kickoff times last entered for the video
+    QPushButton *exportCutListButton; // In the status bar, once there is a video and highlights
+    QPushButton *exportEventsButton;  // In the status bar, once a log is loaded
+    QCheckBox *eventCacheCheckBox;    // In the status bar: keep parsed logs in the user's cache directory
 
     // --- Helper Functions ---
     void setupUiManual();          // Call this in constructor if not using .ui file
     void displayEvents();          // Update the events list display
     void displayHighlights();      // Update the highlights list display
+    void startLoading(const QString& filePath);
+    void showLoadProgress(const LoadProgress& progress);
+    void setBusy(bool busy, bool cancellable = false); // Locks the buttons while a worker runs
+    void updateExportCutListButton();
     void setStatusMessage(const QString& message, int timeout = 3000); // Show message in status bar
+    void logPipelineStats() const; // Instrumented builds: debug-print the wizard's stage timings
 };
 #endif // MAINWINDOW_H
\ No newline at end of file